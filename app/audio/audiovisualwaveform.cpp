@@ -21,6 +21,7 @@
 #include "audiovisualwaveform.h"
 
 #include <QDebug>
+#include <QtConcurrent/QtConcurrent>
 #include <QtGlobal>
 
 #include "config/config.h"
@@ -30,6 +31,34 @@ namespace olive {
 const rational AudioVisualWaveform::kMinimumSampleRate = rational(1, 8);
 const rational AudioVisualWaveform::kMaximumSampleRate = 1024;
 
+template <typename Func>
+void ParallelFor(size_t count, size_t grain, const Func &func)
+{
+  // Split [0, count) into contiguous blocks, run all but the first on the global thread pool and
+  // the first on this thread. Small workloads aren't worth the overhead so just run them here.
+  size_t jobs = std::min(size_t(QThread::idealThreadCount()), count / grain);
+  if (jobs <= 1) {
+    func(0, count);
+    return;
+  }
+
+  size_t per_job = (count + jobs - 1) / jobs;
+
+  QVector< QFuture<void> > futures;
+  for (size_t from=per_job; from<count; from+=per_job) {
+    size_t to = std::min(count, from + per_job);
+    futures.append(QtConcurrent::run([&func, from, to]{
+      func(from, to);
+    }));
+  }
+
+  func(0, per_job);
+
+  for (QFuture<void> &f : futures) {
+    f.waitForFinished();
+  }
+}
+
 AudioVisualWaveform::AudioVisualWaveform() :
   channels_(0)
 {
@@ -49,19 +78,17 @@ void AudioVisualWaveform::OverwriteSamplesFromBuffer(const SampleBuffer &samples
   }
 
   double chunk_size = double(sample_rate) / double(target_rate);
+  SamplePerChannel *dst = data.data() + start_index;
 
-  for (size_t i=0; i<samples_length; i+=channels_) {
-    size_t src_start = qRound((double(i) * chunk_size)) / channels_;
-    size_t src_end = qMin(size_t(qRound64((double(i + channels_) * chunk_size))) / channels_, samples.sample_count());
+  // Every output sample is independent, so long buffers are split across threads
+  ParallelFor(samples_length / channels_, kParallelSamplesPerJob, [&](size_t from, size_t to){
+    for (size_t i=from*channels_; i<to*channels_; i+=channels_) {
+      size_t src_start = qRound((double(i) * chunk_size)) / channels_;
+      size_t src_end = qMin(size_t(qRound64((double(i + channels_) * chunk_size))) / channels_, samples.sample_count());
 
-    Sample summary = SumSamples(samples,
-                                src_start,
-                                src_end - src_start);
-
-    memcpy(&data.data()[i + start_index],
-        summary.data(),
-        summary.size() * sizeof(SamplePerChannel));
-  }
+      SumSamplesInto(samples, src_start, src_end - src_start, dst + i);
+    }
+  });
 }
 
 void AudioVisualWaveform::OverwriteSamplesFromMipmap(const AudioVisualWaveform::Sample &input, double input_sample_rate, size_t &input_start, size_t &input_length, const rational &start, double output_rate, AudioVisualWaveform::Sample &output_data)
@@ -77,13 +104,14 @@ void AudioVisualWaveform::OverwriteSamplesFromMipmap(const AudioVisualWaveform::
   // We guarantee mipmaps are powers of two so integer division should be perfectly accurate here
   size_t chunk_size = input_sample_rate / output_rate;
 
-  for (size_t i=0; i<samples_length; i+=channels_) {
-    Sample summary = ReSumSamples(&input.data()[input_start + (i*chunk_size)], chunk_size * channels_, channels_);
+  const SamplePerChannel *src = input.data() + input_start;
+  SamplePerChannel *dst = output_data.data() + start_index;
 
-    memcpy(&output_data.data()[i + start_index],
-        summary.data(),
-        summary.size() * sizeof(SamplePerChannel));
-  }
+  ParallelFor(samples_length / channels_, kParallelSamplesPerJob, [&](size_t from, size_t to){
+    for (size_t i=from*channels_; i<to*channels_; i+=channels_) {
+      ReSumSamplesInto(src + (i*chunk_size), chunk_size * channels_, channels_, dst + i);
+    }
+  });
 
   input_start = start_index;
   input_length = samples_length;
@@ -304,6 +332,15 @@ AudioVisualWaveform::Sample AudioVisualWaveform::GetSummaryFromTime(const ration
 void ExpandMinMaxChannel(const float *a, size_t length, float &min_val, float &max_val)
 {
 #if defined(Q_PROCESSOR_X86) || defined(Q_PROCESSOR_ARM)
+  if (length < 4) {
+    // Too short for a single vector, the loads below would read out of bounds
+    for (size_t i=0; i<length; i++) {
+      min_val = std::min(min_val, a[i]);
+      max_val = std::max(max_val, a[i]);
+    }
+    return;
+  }
+
   // SSE optimized
 
   // load the first 4 elements of 'a' into min and max (they are 4 * 32 = 128 bits)
@@ -346,42 +383,93 @@ void ExpandMinMaxChannel(const float *a, size_t length, float &min_val, float &m
 
 AudioVisualWaveform::Sample AudioVisualWaveform::SumSamples(const SampleBuffer &samples, size_t start_index, size_t length)
 {
-  int channels = samples.audio_params().channel_count();
-  AudioVisualWaveform::Sample summed_samples(channels);
+  AudioVisualWaveform::Sample summed_samples(samples.audio_params().channel_count());
+
+  SumSamplesInto(samples, start_index, length, summed_samples.data());
 
+  return summed_samples;
+}
+
+AudioVisualWaveform::Sample AudioVisualWaveform::ReSumSamples(const SamplePerChannel* samples,
+                                                                                 size_t nb_samples,
+                                                                                 int nb_channels)
+{
+  AudioVisualWaveform::Sample summed_samples(nb_channels);
+
+  ReSumSamplesInto(samples, nb_samples, nb_channels, summed_samples.data());
+
+  return summed_samples;
+}
+
+void AudioVisualWaveform::SumSamplesInto(const SampleBuffer &samples, size_t start_index, size_t length, SamplePerChannel *out)
+{
   for (int channel=0; channel<samples.audio_params().channel_count(); channel++) {
-    ExpandMinMaxChannel(samples.data(channel) + start_index, length, summed_samples[channel].min, summed_samples[channel].max);
+    out[channel] = {0, 0};
+    ExpandMinMaxChannel(samples.data(channel) + start_index, length, out[channel].min, out[channel].max);
   }
 
   // for reference: this approximation is n x faster (and less accurate) for a n-tracks clip
   // for (size_t i=start_index; i<end_index; i++) {
   //   ExpandMinMax(summed_samples[i%channels], samples->data(i%channels)[i]);
   // }
-
-  return summed_samples;
 }
 
-AudioVisualWaveform::Sample AudioVisualWaveform::ReSumSamples(const SamplePerChannel* samples,
-                                                                                 size_t nb_samples,
-                                                                                 int nb_channels)
+void AudioVisualWaveform::ReSumSamplesInto(const SamplePerChannel *samples, size_t nb_samples, int nb_channels, SamplePerChannel *out)
 {
-  AudioVisualWaveform::Sample summed_samples(nb_channels);
+  for (int j=0;j<nb_channels;j++) {
+    out[j] = {0, 0};
+  }
 
-  for (size_t i=0;i<nb_samples;i+=nb_channels) {
-    for (int j=0;j<nb_channels;j++) {
+  size_t i = 0;
+
+#if defined(Q_PROCESSOR_X86) || defined(Q_PROCESSOR_ARM)
+  if (nb_channels == 1 || nb_channels == 2) {
+    // A SamplePerChannel is a min/max pair of floats, so one 128-bit register holds either two
+    // mono samples or one stereo sample. Even lanes are always mins and odd lanes always maxes.
+    const float *f = reinterpret_cast<const float*>(samples);
+    size_t vector_length = (nb_samples * 2) & ~size_t(3);
+
+    __m128 min = _mm_setzero_ps();
+    __m128 max = _mm_setzero_ps();
+
+    for (size_t k=0; k<vector_length; k+=4) {
+      __m128 cur = _mm_loadu_ps(f + k);
+      min = _mm_min_ps(min, cur);
+      max = _mm_max_ps(max, cur);
+    }
+
+    float min_arr[4], max_arr[4];
+    _mm_storeu_ps(min_arr, min);
+    _mm_storeu_ps(max_arr, max);
+
+    if (nb_channels == 1) {
+      out[0].min = std::min(min_arr[0], min_arr[2]);
+      out[0].max = std::max(max_arr[1], max_arr[3]);
+    } else {
+      out[0].min = min_arr[0];
+      out[0].max = max_arr[1];
+      out[1].min = min_arr[2];
+      out[1].max = max_arr[3];
+    }
+
+    // Fall through to the scalar loop for any remaining samples
+    i = vector_length / 2;
+  }
+#endif
+
+  for (;i<nb_samples;i+=nb_channels) {
+    for (int j=0;j<nb_channels && i+j<nb_samples;j++) {
       const AudioVisualWaveform::SamplePerChannel& sample = samples[i + j];
 
-      if (sample.min < summed_samples[j].min) {
-        summed_samples[j].min = sample.min;
+      if (sample.min < out[j].min) {
+        out[j].min = sample.min;
       }
 
-      if (sample.max > summed_samples[j].max) {
-        summed_samples[j].max = sample.max;
+      if (sample.max > out[j].max) {
+        out[j].max = sample.max;
       }
     }
   }
-
-  return summed_samples;
 }
 
 template <typename T>
@@ -468,9 +556,12 @@ void AudioVisualWaveform::DrawWaveform(QPainter *painter, const QRect& rect, con
                                  size_t(start_sample_index + std::floor(rate_dbl * static_cast<double>(i - rect.x() + 1) / scale) * samples.channel_count()));
 
     if (summary_index != sample_index) {
-      summary = AudioVisualWaveform::ReSumSamples(&arr.at(sample_index),
-                                                  qMax(size_t(samples.channel_count()), next_sample_index - sample_index),
-                                                  samples.channel_count());
+      // Re-use the same summary rather than allocating a new one for every pixel
+      summary.resize(samples.channel_count());
+      AudioVisualWaveform::ReSumSamplesInto(&arr.at(sample_index),
+                                            qMax(size_t(samples.channel_count()), next_sample_index - sample_index),
+                                            samples.channel_count(),
+                                            summary.data());
       summary_index = sample_index;
     }
 
@@ -102,6 +102,16 @@ public:
 
   Sample GetSummaryFromTime(const rational& start, const rational& length) const;
 
+  /**
+   * @brief Access the interleaved data of a single mipmap
+   *
+   * `rate` must be a power of two between kMinimumSampleRate and kMaximumSampleRate.
+   */
+  const Sample &GetMipmap(const rational &rate) const
+  {
+    return mipmapped_data_.at(rate);
+  }
+
   static Sample SumSamples(const SampleBuffer &samples, size_t start_index, size_t length);
 
   static Sample ReSumSamples(const SamplePerChannel *samples, size_t nb_samples, int nb_channels);
@@ -115,6 +125,19 @@ public:
   static const rational kMaximumSampleRate;
 
 private:
+  /**
+   * @brief Allocation-free versions of SumSamples() and ReSumSamples()
+   *
+   * Write one SamplePerChannel per channel directly into `out`.
+   */
+  static void SumSamplesInto(const SampleBuffer &samples, size_t start_index, size_t length, SamplePerChannel *out);
+  static void ReSumSamplesInto(const SamplePerChannel *samples, size_t nb_samples, int nb_channels, SamplePerChannel *out);
+
+  /**
+   * @brief Minimum number of output samples a mipmap must have written before it's split across threads
+   */
+  static const size_t kParallelSamplesPerJob = 8192;
+
   void OverwriteSamplesFromBuffer(const SampleBuffer &samples, int sample_rate, const rational& start, double target_rate, Sample &data, size_t &start_index, size_t &samples_length);
 
   void OverwriteSamplesFromMipmap(const Sample& input, double input_sample_rate, size_t &input_start, size_t &input_length, const rational& start, double output_rate, Sample &output_data);
@@ -159,6 +159,17 @@ qint64 Decoder::GetLastAccessedTime()
   return last_accessed_;
 }
 
+int Decoder::GetLevelForDivider(int divider)
+{
+  QMutexLocker locker(&mutex_);
+
+  if (!stream_.IsValid()) {
+    return 0;
+  }
+
+  return GetLevelForDividerInternal(divider);
+}
+
 void Decoder::Close()
 {
   QMutexLocker locker(&mutex_);
@@ -180,6 +191,11 @@ bool Decoder::ConformAudio(const QVector<QString> &output_filenames, const Audio
   return ConformAudioInternal(output_filenames, params, cancelled);
 }
 
+bool Decoder::GenerateProxy(const QString &output_filename, int divider, CancelAtom *cancelled)
+{
+  return GenerateProxyInternal(output_filename, divider, cancelled);
+}
+
 /*
  * DECODER STATIC PUBLIC MEMBERS
  */
@@ -214,6 +230,22 @@ DecoderPtr Decoder::CreateFromID(const QString &id)
   return nullptr;
 }
 
+bool Decoder::IdSupportsImageSequences(const QString &id)
+{
+  static QMutex lock;
+  static QHash<QString, bool> supports;
+
+  QMutexLocker locker(&lock);
+
+  auto it = supports.constFind(id);
+  if (it == supports.cend()) {
+    DecoderPtr d = CreateFromID(id);
+    it = supports.insert(id, d && d->SupportsImageSequences());
+  }
+
+  return it.value();
+}
+
 void Decoder::SignalProcessingProgress(int64_t ts, int64_t duration)
 {
   if (duration != AV_NOPTS_VALUE && duration != 0) {
@@ -280,6 +312,20 @@ bool Decoder::ConformAudioInternal(const QVector<QString> &filenames, const Audi
   return false;
 }
 
+bool Decoder::GenerateProxyInternal(const QString &output_filename, int divider, CancelAtom *cancelled)
+{
+  Q_UNUSED(output_filename)
+  Q_UNUSED(divider)
+  Q_UNUSED(cancelled)
+  return false;
+}
+
+int Decoder::GetLevelForDividerInternal(int divider) const
+{
+  Q_UNUSED(divider)
+  return 0;
+}
+
 bool Decoder::RetrieveAudioFromConform(SampleBuffer &sample_buffer, const QVector<QString> &conform_filenames, TimeRange range, LoopMode loop_mode, const AudioParams &input_params)
 {
   PlanarFileDevice input;
@@ -338,7 +384,7 @@ void Decoder::UpdateLastAccessed()
 
 uint qHash(Decoder::CodecStream stream, uint seed)
 {
-  return qHash(stream.filename(), seed) ^ ::qHash(stream.stream(), seed) ^ qHash(stream.block(), seed);
+  return qHash(stream.filename(), seed) ^ ::qHash(stream.stream(), seed) ^ qHash(stream.block(), seed) ^ ::qHash(stream.level(), seed);
 }
 
 }
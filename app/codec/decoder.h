@@ -79,6 +79,14 @@ public:
   virtual bool SupportsVideo(){return false;}
   virtual bool SupportsAudio(){return false;}
 
+  /**
+   * @brief Whether this decoder can read a whole image sequence from one open instance
+   *
+   * Such decoders are opened once with the sequence's filename and read each file themselves
+   * using RetrieveVideoParams::sequence_index.
+   */
+  virtual bool SupportsImageSequences(){return false;}
+
   void IncrementAccessTime(qint64 t);
 
   class CodecStream
@@ -86,14 +94,16 @@ public:
   public:
     CodecStream() :
       stream_(-1),
-      block_(nullptr)
+      block_(nullptr),
+      level_(0)
     {
     }
 
-    CodecStream(const QString& filename, int stream, Block *block) :
+    CodecStream(const QString& filename, int stream, Block *block, int level = 0) :
       filename_(filename),
       stream_(stream),
-      block_(block)
+      block_(block),
+      level_(level)
     {
     }
 
@@ -114,7 +124,7 @@ public:
 
     bool operator==(const CodecStream& rhs) const
     {
-      return filename_ == rhs.filename_ && stream_ == rhs.stream_;
+      return filename_ == rhs.filename_ && stream_ == rhs.stream_ && level_ == rhs.level_;
     }
 
     const QString& filename() const
@@ -132,6 +142,14 @@ public:
       return block_;
     }
 
+    /**
+     * @brief Reduced resolution level to open at, as returned by Decoder::GetLevelForDivider()
+     */
+    int level() const
+    {
+      return level_;
+    }
+
   private:
     QString filename_;
 
@@ -139,6 +157,8 @@ public:
 
     Block *block_;
 
+    int level_;
+
   };
 
   /**
@@ -163,6 +183,7 @@ public:
     CancelAtom *cancelled = nullptr;
     VideoParams::ColorRange force_range = VideoParams::kColorRangeDefault;
     VideoParams::Interlacing src_interlacing = VideoParams::kInterlaceNone;
+    int64_t sequence_index = -1;
   };
 
   /**
@@ -212,6 +233,15 @@ public:
    */
   virtual FootageDescription Probe(const QString& filename, CancelAtom *cancelled) const = 0;
 
+  /**
+   * @brief Returns the reduced resolution level this decoder would read at for a divider
+   *
+   * Decoders that switch levels by re-opening should be cached once per level (see CodecStream::level())
+   * rather than shared between renders at different dividers. Returns 0 for full resolution, or if
+   * the decoder isn't open. This function is thread safe.
+   */
+  int GetLevelForDivider(int divider);
+
   /**
    * @brief Closes media/deallocates memory
    *
@@ -224,6 +254,13 @@ public:
    */
   bool ConformAudio(const QVector<QString> &output_filenames, const AudioParams &params, CancelAtom *cancelled = nullptr);
 
+  /**
+   * @brief Transcode video stream into a reduced resolution, intra-frame proxy file
+   *
+   * The proxy keeps the stream's timing so it can be decoded in place of the original.
+   */
+  bool GenerateProxy(const QString &output_filename, int divider, CancelAtom *cancelled = nullptr);
+
   /**
    * @brief Create a Decoder instance using a Decoder ID
    *
@@ -233,6 +270,14 @@ public:
    */
   static DecoderPtr CreateFromID(const QString& id);
 
+  /**
+   * @brief Whether the Decoder with this ID reads image sequences itself
+   *
+   * Equivalent to CreateFromID(id)->SupportsImageSequences(), but only creates a decoder the first
+   * time each ID is queried. Thread-safe.
+   */
+  static bool IdSupportsImageSequences(const QString& id);
+
   static QString TransformImageSequenceFileName(const QString& filename, const int64_t& number);
 
   static int GetImageSequenceDigitCount(const QString& filename);
@@ -274,6 +319,8 @@ protected:
 
   virtual bool ConformAudioInternal(const QVector<QString>& filenames, const AudioParams &params, CancelAtom *cancelled);
 
+  virtual bool GenerateProxyInternal(const QString &output_filename, int divider, CancelAtom *cancelled);
+
   void SignalProcessingProgress(int64_t ts, int64_t duration);
 
   /**
@@ -288,6 +335,8 @@ protected:
 
   virtual rational GetAudioStartOffset() const { return 0; }
 
+  virtual int GetLevelForDividerInternal(int divider) const;
+
 signals:
   /**
    * @brief While indexing, this signal will provide progress as a percentage (0-100 inclusive) if
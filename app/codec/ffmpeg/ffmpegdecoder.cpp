@@ -53,6 +53,7 @@ QVariant DeinterlaceShader;
 FFmpegDecoder::FFmpegDecoder() :
   sws_ctx_(nullptr),
   working_packet_(nullptr),
+  lowres_(0),
   cache_at_zero_(false),
   cache_at_eof_(false)
 {
@@ -60,13 +61,14 @@ FFmpegDecoder::FFmpegDecoder() :
 
 bool FFmpegDecoder::OpenInternal()
 {
-  if (instance_.Open(stream().filename().toUtf8(), stream().stream())) {
+  if (instance_.Open(stream().filename().toUtf8(), stream().stream(), stream().level())) {
     AVStream* s = instance_.avstream();
 
     // Store one second in the source's timebase
     second_ts_ = qRound64(av_q2d(av_inv_q(s->time_base)));
 
     working_packet_ = av_packet_alloc();
+    lowres_ = stream().level();
     return true;
   }
 
@@ -80,15 +82,23 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f, const RetrieveVi
   PixelFormat native_fmt = GetNativePixelFormat(ideal_fmt);
   int native_channels = GetNativeChannelCount(ideal_fmt);
 
-  // Set up video params
-  VideoParams vp(original->width,
-                 original->height,
+  // Set up video params from the stream rather than the frame, since the frame may have been decoded at a reduced
+  // resolution
+  VideoParams vp(instance_.avstream()->codecpar->width,
+                 instance_.avstream()->codecpar->height,
                  native_fmt,
                  native_channels,
                  av_guess_sample_aspect_ratio(instance_.fmt_ctx(), instance_.avstream(), nullptr),
                  VideoParams::kInterlaceNone,
                  p.divider);
 
+  // Describe the frame as it actually arrived. If it's larger than the output, it gets uploaded as-is and the GPU
+  // filters it down while converting it, which is much cheaper than scaling it on the CPU.
+  VideoParams frame_params = vp;
+  frame_params.set_divider(1);
+  frame_params.set_width(f->width);
+  frame_params.set_height(f->height);
+
   // Create texture
   TexturePtr tex = p.renderer->CreateTexture(vp);
 
@@ -138,7 +148,7 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f, const RetrieveVi
 
     AVFrame *hw_in = f.get();
 
-    VideoParams plane_params = vp;
+    VideoParams plane_params = frame_params;
     plane_params.set_channel_count(1);
     plane_params.set_format(native_fmt);
 
@@ -185,8 +195,19 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f, const RetrieveVi
   }
   case AV_PIX_FMT_RGBA:
   case AV_PIX_FMT_RGBA64LE:
-    // RGBA can be uploaded directly to the texture
-    tex->Upload(f->data[0], f->linesize[0] / vp.GetBytesPerPixel());
+    if (frame_params.effective_width() == vp.effective_width()
+        && frame_params.effective_height() == vp.effective_height()) {
+      // RGBA can be uploaded directly to the texture
+      tex->Upload(f->data[0], f->linesize[0] / vp.GetBytesPerPixel());
+    } else {
+      // Upload at the frame's size and blit down to the output size
+      TexturePtr full = p.renderer->CreateTexture(frame_params, f->data[0], f->linesize[0] / frame_params.GetBytesPerPixel());
+
+      ShaderJob job;
+      job.Insert(QStringLiteral("ove_maintex"), NodeValue(NodeValue::kTexture, QVariant::fromValue(full)));
+
+      p.renderer->BlitToTexture(p.renderer->GetDefaultShader(), job, tex.get(), false);
+    }
     break;
   }
 
@@ -233,6 +254,21 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f, const RetrieveVi
 
 TexturePtr FFmpegDecoder::RetrieveVideoInternal(const RetrieveVideoParams &p)
 {
+  int lowres = GetLowresForDivider(p.divider);
+  if (!instance_.IsOpen() || lowres != lowres_) {
+    // Re-open the codec at the new decode resolution. Cached frames are the wrong size now.
+    ClearFrameCache();
+    instance_.Close();
+
+    if (!instance_.Open(stream().filename().toUtf8(), stream().stream(), lowres)) {
+      // Don't leave a half-open instance behind, the next request will try again
+      instance_.Close();
+      return nullptr;
+    }
+
+    lowres_ = lowres;
+  }
+
   if (AVFramePtr f = RetrieveFrame(p.time, p.cancelled)) {
     if (p.cancelled && p.cancelled->IsCancelled()) {
       return nullptr;
@@ -661,6 +697,217 @@ bool FFmpegDecoder::ConformAudioInternal(const QVector<QString> &filenames, cons
   return success;
 }
 
+bool FFmpegDecoder::GenerateProxyInternal(const QString &output_filename, int divider, CancelAtom *cancelled)
+{
+  AVStream *src_stream = instance_.avstream();
+
+  if (src_stream->codecpar->codec_type != AVMEDIA_TYPE_VIDEO) {
+    return false;
+  }
+
+  // ProRes Proxy is intra-only so seeking is instant, and 10-bit 4:2:2 goes through the GPU YUV
+  // path without any CPU conversion on playback
+  const AVCodec *encoder = avcodec_find_encoder_by_name("prores_ks");
+  if (!encoder) {
+    qCritical() << "Failed to find ProRes encoder, could not create proxy";
+    return false;
+  }
+
+  // ProRes 422 has no alpha channel, so footage with one needs 4444 to stay transparent with proxies on
+  const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(src_stream->codecpar->format));
+  const bool has_alpha = src_desc && (src_desc->flags & AV_PIX_FMT_FLAG_ALPHA);
+
+  const AVPixelFormat proxy_fmt = has_alpha ? AV_PIX_FMT_YUVA444P10LE : AV_PIX_FMT_YUV422P10LE;
+
+  // 4:2:2 requires an even width
+  int proxy_width = std::max(2, VideoParams::GetScaledDimension(src_stream->codecpar->width, divider) & ~1);
+  int proxy_height = std::max(1, VideoParams::GetScaledDimension(src_stream->codecpar->height, divider));
+
+  // Proxy timestamps start at zero, which is also where the decoder assumes the original starts
+  int64_t start_ts = 0;
+  if (instance_.fmt_ctx()->start_time != AV_NOPTS_VALUE) {
+    start_ts = av_rescale_q(instance_.fmt_ctx()->start_time, {1, AV_TIME_BASE}, src_stream->time_base);
+  }
+
+  QByteArray output_c = output_filename.toUtf8();
+
+  AVFormatContext *output = nullptr;
+  AVCodecContext *enc_ctx = nullptr;
+  SwsContext *scaler = nullptr;
+  AVPacket *pkt = av_packet_alloc();
+  AVPacket *out_pkt = av_packet_alloc();
+  AVFrame *frame = av_frame_alloc();
+  AVFrame *scaled = av_frame_alloc();
+  bool header_written = false;
+  bool success = false;
+
+  int r = avformat_alloc_output_context2(&output, nullptr, "mov", output_c.constData());
+
+  if (r >= 0) {
+    AVStream *out_stream = avformat_new_stream(output, nullptr);
+    enc_ctx = avcodec_alloc_context3(encoder);
+
+    enc_ctx->width = proxy_width;
+    enc_ctx->height = proxy_height;
+    enc_ctx->pix_fmt = proxy_fmt;
+    enc_ctx->time_base = src_stream->time_base;
+    enc_ctx->sample_aspect_ratio = av_guess_sample_aspect_ratio(instance_.fmt_ctx(), src_stream, nullptr);
+    enc_ctx->color_range = src_stream->codecpar->color_range;
+    enc_ctx->colorspace = src_stream->codecpar->color_space;
+    enc_ctx->color_primaries = src_stream->codecpar->color_primaries;
+    enc_ctx->color_trc = src_stream->codecpar->color_trc;
+
+    if (output->oformat->flags & AVFMT_GLOBALHEADER) {
+      enc_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    av_opt_set(enc_ctx->priv_data, "profile", has_alpha ? "4444" : "proxy", 0);
+
+    r = avcodec_open2(enc_ctx, encoder, nullptr);
+
+    if (r >= 0) {
+      r = avcodec_parameters_from_context(out_stream->codecpar, enc_ctx);
+      out_stream->time_base = enc_ctx->time_base;
+      out_stream->sample_aspect_ratio = enc_ctx->sample_aspect_ratio;
+    }
+
+    if (r >= 0) {
+      r = avio_open(&output->pb, output_c.constData(), AVIO_FLAG_WRITE);
+    }
+
+    if (r >= 0) {
+      r = avformat_write_header(output, nullptr);
+      header_written = (r >= 0);
+    }
+  }
+
+  if (r >= 0) {
+    instance_.Seek(0);
+
+    while (true) {
+      if (cancelled && cancelled->IsCancelled()) {
+        break;
+      }
+
+      r = instance_.GetFrame(pkt, frame);
+
+      if (r == AVERROR_EOF) {
+        // Flush encoder
+        r = avcodec_send_frame(enc_ctx, nullptr);
+        if (r >= 0) {
+          r = WriteProxyPackets(enc_ctx, output, out_pkt);
+        }
+        success = (r >= 0 || r == AVERROR_EOF);
+        break;
+      } else if (r < 0) {
+        break;
+      }
+
+      int64_t pts = (frame->best_effort_timestamp != AV_NOPTS_VALUE) ? frame->best_effort_timestamp : frame->pts;
+
+      if (!scaler) {
+        int colorspace = FFmpegUtils::GetSwsColorspaceFromAVColorSpace(src_stream->codecpar->color_space);
+        int full_range = (src_stream->codecpar->color_range == AVCOL_RANGE_JPEG) ? 1 : 0;
+
+        scaler = sws_getContext(frame->width,
+                                frame->height,
+                                FFmpegUtils::ConvertJPEGSpaceToRegularSpace(static_cast<AVPixelFormat>(frame->format)),
+                                proxy_width,
+                                proxy_height,
+                                proxy_fmt,
+                                SWS_BILINEAR,
+                                nullptr,
+                                nullptr,
+                                nullptr);
+
+        if (!scaler) {
+          qCritical() << "Failed to create scaler for proxy";
+          break;
+        }
+
+        // Keep the source's range and matrix so the proxy is interpreted exactly like the original
+        sws_setColorspaceDetails(scaler,
+                                 sws_getCoefficients(colorspace), full_range,
+                                 sws_getCoefficients(colorspace), full_range,
+                                 0, 0x10000, 0x10000);
+
+        scaled->width = proxy_width;
+        scaled->height = proxy_height;
+        scaled->format = proxy_fmt;
+
+        r = av_frame_get_buffer(scaled, 0);
+        if (r < 0) {
+          break;
+        }
+      }
+
+      // The encoder may still reference the last frame's buffers
+      r = av_frame_make_writable(scaled);
+      if (r < 0) {
+        break;
+      }
+
+      sws_scale(scaler, frame->data, frame->linesize, 0, frame->height, scaled->data, scaled->linesize);
+
+      scaled->pts = pts - start_ts;
+
+      if (scaled->pts >= 0) {
+        r = avcodec_send_frame(enc_ctx, scaled);
+        if (r >= 0) {
+          r = WriteProxyPackets(enc_ctx, output, out_pkt);
+        }
+        if (r < 0 && r != AVERROR(EAGAIN)) {
+          break;
+        }
+      }
+
+      SignalProcessingProgress(pts, src_stream->duration);
+    }
+  }
+
+  if (r < 0 && r != AVERROR_EOF) {
+    qCritical() << "Failed to create proxy:" << FFmpegError(r);
+  }
+
+  if (header_written) {
+    av_write_trailer(output);
+  }
+
+  if (output) {
+    if (output->pb) {
+      avio_closep(&output->pb);
+    }
+    avformat_free_context(output);
+  }
+
+  avcodec_free_context(&enc_ctx);
+  sws_freeContext(scaler);
+  av_frame_free(&scaled);
+  av_frame_free(&frame);
+  av_packet_free(&out_pkt);
+  av_packet_free(&pkt);
+
+  return success;
+}
+
+int FFmpegDecoder::WriteProxyPackets(AVCodecContext *encoder, AVFormatContext *output, AVPacket *pkt)
+{
+  int r;
+
+  while ((r = avcodec_receive_packet(encoder, pkt)) >= 0) {
+    av_packet_rescale_ts(pkt, encoder->time_base, output->streams[0]->time_base);
+    pkt->stream_index = 0;
+
+    r = av_interleaved_write_frame(output, pkt);
+    if (r < 0) {
+      return r;
+    }
+  }
+
+  // EAGAIN means the encoder wants more input, which isn't an error here
+  return (r == AVERROR(EAGAIN)) ? 0 : r;
+}
+
 PixelFormat FFmpegDecoder::GetNativePixelFormat(AVPixelFormat pix_fmt)
 {
   switch (pix_fmt) {
@@ -729,6 +976,39 @@ bool FFmpegDecoder::IsPixelFormatGLSLCompatible(AVPixelFormat f)
   }
 }
 
+int FFmpegDecoder::GetLevelForDividerInternal(int divider) const
+{
+  return GetLowresForDivider(divider);
+}
+
+int FFmpegDecoder::GetLowresForDivider(int divider) const
+{
+  if (!instance_.IsOpen()) {
+    return 0;
+  }
+
+  AVCodecParameters *codecpar = instance_.avstream()->codecpar;
+
+  if (codecpar->codec_type != AVMEDIA_TYPE_VIDEO) {
+    return 0;
+  }
+
+  const AVCodecDescriptor *desc = avcodec_descriptor_get(codecpar->codec_id);
+  const AVCodec *codec = avcodec_find_decoder(codecpar->codec_id);
+
+  if (!desc || !(desc->props & AV_CODEC_PROP_INTRA_ONLY) || !codec) {
+    return 0;
+  }
+
+  // Only go as low as the divider itself so the GPU never has to scale the frame back up
+  int lowres = 0;
+  while (lowres < codec->max_lowres && (2 << lowres) <= divider) {
+    lowres++;
+  }
+
+  return lowres;
+}
+
 void FFmpegDecoder::ClearFrameCache()
 {
   if (!cached_frames_.empty()) {
@@ -741,33 +1021,25 @@ void FFmpegDecoder::ClearFrameCache()
 AVFramePtr FFmpegDecoder::PreProcessFrame(AVFramePtr f, const RetrieveVideoParams &p)
 {
   // In pre-processing, we try to achieve the following:
-  //   - If a divider is being used, scale down the image
   //   - If a pixel format is not compatible with the GLSL shader, convert it to RGBA ourselves
+  //   - If we're converting anyway and a divider is being used, scale down the image at the same time
 
-  if (p.divider == 1 && IsPixelFormatGLSLCompatible(static_cast<AVPixelFormat>(f->format))) {
-    // No CPU processing required, the user wants this in full resolution and the pixel format can
-    // be converted on the GPU
+  if (IsPixelFormatGLSLCompatible(static_cast<AVPixelFormat>(f->format))) {
+    // No CPU processing required, the pixel format can be converted on the GPU and any downscaling
+    // happens in the same pass
     return f;
   }
 
-  // Some scaling and/or format conversion needs to be done
+  // Format conversion needs to be done
   AVFramePtr dest = CreateAVFramePtr();
 
-  dest->width = f->width;
-  dest->height = f->height;
-  dest->format = f->format;
+  // Scale to the output size, unless the frame was already decoded smaller than that
+  dest->width = std::min(f->width, VideoParams::GetScaledDimension(instance_.avstream()->codecpar->width, p.divider));
+  dest->height = std::min(f->height, VideoParams::GetScaledDimension(instance_.avstream()->codecpar->height, p.divider));
+  dest->format = FFmpegUtils::GetCompatiblePixelFormat(static_cast<AVPixelFormat>(f->format), p.maximum_format);
   dest->color_range = f->color_range;
   dest->colorspace = f->colorspace;
 
-  if (p.divider > 1) {
-    dest->width = VideoParams::GetScaledDimension(dest->width, p.divider);
-    dest->height = VideoParams::GetScaledDimension(dest->height, p.divider);
-  }
-
-  if (!IsPixelFormatGLSLCompatible(static_cast<AVPixelFormat>(dest->format))) {
-    dest->format = FFmpegUtils::GetCompatiblePixelFormat(static_cast<AVPixelFormat>(dest->format), p.maximum_format);
-  }
-
   int r = av_frame_get_buffer(dest.get(), 0);
   if (r < 0) {
     FFmpegError(r);
@@ -1025,7 +1297,7 @@ FFmpegDecoder::Instance::Instance() :
 {
 }
 
-bool FFmpegDecoder::Instance::Open(const char *filename, int stream_index)
+bool FFmpegDecoder::Instance::Open(const char *filename, int stream_index, int lowres)
 {
   // Open file in a format context
   int error_code = avformat_open_input(&fmt_ctx_, filename, nullptr, nullptr);
@@ -1076,6 +1348,9 @@ bool FFmpegDecoder::Instance::Open(const char *filename, int stream_index)
     return false;
   }
 
+  // Decode at reduced resolution if requested
+  codec_ctx_->lowres = lowres;
+
   // Set multithreading setting
   error_code = av_dict_set(&opts_, "threads", "auto", 0);
 
@@ -1112,6 +1387,9 @@ void FFmpegDecoder::Instance::Close()
     avformat_close_input(&fmt_ctx_);
     fmt_ctx_ = nullptr;
   }
+
+  // Owned by fmt_ctx_, so it's gone now too
+  avstream_ = nullptr;
 }
 
 int FFmpegDecoder::Instance::GetFrame(AVPacket *pkt, AVFrame *frame)
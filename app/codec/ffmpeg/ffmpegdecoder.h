@@ -65,10 +65,14 @@ protected:
   virtual bool OpenInternal() override;
   virtual TexturePtr RetrieveVideoInternal(const RetrieveVideoParams& p) override;
   virtual bool ConformAudioInternal(const QVector<QString>& filenames, const AudioParams &params, CancelAtom *cancelled) override;
+
+  virtual bool GenerateProxyInternal(const QString &output_filename, int divider, CancelAtom *cancelled) override;
   virtual void CloseInternal() override;
 
   virtual rational GetAudioStartOffset() const override;
 
+  virtual int GetLevelForDividerInternal(int divider) const override;
+
 private:
   class Instance
   {
@@ -80,7 +84,10 @@ private:
       Close();
     }
 
-    bool Open(const char* filename, int stream_index);
+    /**
+     * @brief Open a stream, optionally decoding video at 1/2^lowres of its full resolution
+     */
+    bool Open(const char* filename, int stream_index, int lowres = 0);
 
     bool IsOpen() const
     {
@@ -136,6 +143,8 @@ private:
 
   void FreeScaler();
 
+  static int WriteProxyPackets(AVCodecContext *encoder, AVFormatContext *output, AVPacket *pkt);
+
   static PixelFormat GetNativePixelFormat(AVPixelFormat pix_fmt);
   static int GetNativeChannelCount(AVPixelFormat pix_fmt);
 
@@ -145,6 +154,14 @@ private:
 
   static bool IsPixelFormatGLSLCompatible(AVPixelFormat f);
 
+  /**
+   * @brief Returns the lowres decoding level to use for this divider, or 0 if decoding should be full resolution
+   *
+   * Only intra-only codecs with native lowres support qualify. The render processor keeps one decoder per level, so a
+   * decoder normally only re-opens once, from the full resolution it was opened at to its own level.
+   */
+  int GetLowresForDivider(int divider) const;
+
   AVFramePtr GetFrameFromCache(const int64_t &t) const;
 
   void ClearFrameCache();
@@ -173,6 +190,8 @@ private:
 
   int64_t second_ts_;
 
+  int lowres_;
+
   std::list<AVFramePtr> cached_frames_;
 
   bool cache_at_zero_;
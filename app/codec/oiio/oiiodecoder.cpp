@@ -20,10 +20,13 @@
 
 #include "oiiodecoder.h"
 
+#include <algorithm>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
 
 #include "common/define.h"
 #include "common/oiioutils.h"
@@ -35,8 +38,43 @@ namespace olive {
 
 QStringList OIIODecoder::supported_formats_;
 
+// Decoded image sequence frames kept per decoder, in bytes
+const qint64 kSequenceCacheSize = 512 * 1024 * 1024;
+const int kMaxSequenceFrames = 32;
+
+// How many frames to read ahead in the direction of playback
+const int kSequencePrefetchCount = 8;
+
+// Consecutive requests against the current direction before read-ahead turns around. Parallel
+// render threads can ask for frames slightly out of order without it meaning playback reversed.
+const int kSequenceDirectionChangeCount = 3;
+
+// Dividers kept at once, the least recently used one is dropped beyond this. They share kSequenceCacheSize.
+const int kMaxSequenceRings = 3;
+
+const int kMaxConcurrentSequenceReads = 4;
+
+// Reduced reads average at most this many source rows per output row, skipping the rest
+const int kMaxRowsPerBox = 2;
+
+// Output rows read and filtered at a time, bounding the size of the intermediate buffer
+const int kDownsampleBandHeight = 64;
+
+QThreadPool *GetSequenceThreadPool()
+{
+  static QThreadPool pool;
+  static bool initialized = [](){
+    pool.setMaxThreadCount(kMaxConcurrentSequenceReads);
+    return true;
+  }();
+  Q_UNUSED(initialized)
+
+  return &pool;
+}
+
 OIIODecoder::OIIODecoder() :
-  image_(nullptr)
+  image_(nullptr),
+  sequence_request_count_(0)
 {
 }
 
@@ -121,6 +159,10 @@ bool OIIODecoder::OpenInternal()
 
 TexturePtr OIIODecoder::RetrieveVideoInternal(const RetrieveVideoParams &p)
 {
+  if (p.sequence_index >= 0) {
+    return RetrieveSequenceFrame(p);
+  }
+
   VideoParams vp = GetVideoParamsFromImageSpec(image_->spec());
   vp.set_divider(p.divider);
 
@@ -132,26 +174,7 @@ TexturePtr OIIODecoder::RetrieveVideoInternal(const RetrieveVideoParams &p)
     buffer_.set_video_params(vp);
     buffer_.allocate();
 
-    if (p.divider == 1) {
-      // Just upload straight to the buffer
-      image_->read_image(oiio_pix_fmt_, buffer_.data(), OIIO::AutoStride, buffer_.linesize_bytes());
-    } else {
-      OIIO::ImageBuf buf(image_->spec());
-      image_->read_image(image_->spec().format, buf.localpixels(), buf.pixel_stride(), buf.scanline_stride(), buf.z_stride());
-
-      // Roughly downsample image for divider (for some reason OIIO::ImageBufAlgo::resample failed here)
-      int px_sz = vp.GetBytesPerPixel();
-      for (int dst_y=0; dst_y<buffer_.height(); dst_y++) {
-        int src_y = dst_y * buf.spec().height / buffer_.height();
-
-        for (int dst_x=0; dst_x<buffer_.width(); dst_x++) {
-          int src_x = dst_x * buf.spec().width / buffer_.width();
-          memcpy(buffer_.data() + buffer_.linesize_bytes() * dst_y + px_sz * dst_x,
-                 static_cast<uint8_t*>(buf.localpixels()) + buf.scanline_stride() * src_y + px_sz * src_x,
-                 px_sz);
-        }
-      }
-    }
+    ReadImage(image_.get(), stream().stream(), oiio_pix_fmt_, &buffer_, p.divider);
   }
 
   return p.renderer->CreateTexture(vp, buffer_.data(), buffer_.linesize_pixels());
@@ -159,9 +182,363 @@ TexturePtr OIIODecoder::RetrieveVideoInternal(const RetrieveVideoParams &p)
 
 void OIIODecoder::CloseInternal()
 {
+  ClearSequenceFrames();
   CloseImageHandle();
 }
 
+void OIIODecoder::ReadImage(OIIO::ImageInput *input, int subimage, OIIO::TypeDesc::BASETYPE format, Frame *dst, int divider)
+{
+  if (divider == 1) {
+    // Just upload straight to the buffer
+    input->read_image(format, dst->data(), OIIO::AutoStride, dst->linesize_bytes());
+    return;
+  }
+
+  // Use the smallest MIP level that's still at least as large as the output, if the file has any
+  int miplevel = 0;
+  while (input->seek_subimage(subimage, miplevel + 1)
+         && input->spec().width >= dst->width()
+         && input->spec().height >= dst->height()) {
+    miplevel++;
+  }
+  input->seek_subimage(subimage, miplevel);
+
+  // Reads are in data window coordinates, which don't necessarily start at 0
+  const OIIO::ImageSpec spec = input->spec();
+  const int src_width = spec.width;
+  const int src_height = spec.height;
+  const int channels = spec.nchannels;
+  const int dst_width = dst->width();
+  const int dst_height = dst->height();
+  const size_t src_row_floats = size_t(src_width) * channels;
+
+  std::vector<float> rows(src_row_floats * kMaxRowsPerBox * kDownsampleBandHeight);
+  QVector<int> row_counts(kDownsampleBandHeight);
+  QVector<int> band_rows;
+
+  // Tiled files decode a whole row of tiles for any scanline in it, so read each tile row once and
+  // copy the rows we need out of it
+  const bool tiled = spec.tile_width > 0 && spec.tile_height > 0;
+  std::vector<float> tile_rows;
+  int loaded_tile_row = -1;
+  if (tiled) {
+    tile_rows.resize(src_row_floats * spec.tile_height);
+  }
+
+  auto read_rows = [&](int y0, int y1, float *row_dst) {
+    if (!tiled) {
+      return input->read_scanlines(subimage, miplevel, spec.y + y0, spec.y + y1, spec.z, 0, channels, OIIO::TypeDesc::FLOAT, row_dst);
+    }
+
+    for (int y=y0; y<y1; y++) {
+      int tile_row = y / spec.tile_height;
+
+      if (tile_row != loaded_tile_row) {
+        int tile_y0 = tile_row * spec.tile_height;
+        int tile_y1 = qMin(tile_y0 + spec.tile_height, src_height);
+
+        if (!input->read_tiles(subimage, miplevel,
+                               spec.x, spec.x + src_width,
+                               spec.y + tile_y0, spec.y + tile_y1,
+                               spec.z, spec.z + 1,
+                               0, channels, OIIO::TypeDesc::FLOAT, tile_rows.data())) {
+          loaded_tile_row = -1;
+          return false;
+        }
+
+        loaded_tile_row = tile_row;
+      }
+
+      const float *src = tile_rows.data() + src_row_floats * (y - loaded_tile_row * spec.tile_height);
+      std::copy(src, src + src_row_floats, row_dst + src_row_floats * (y - y0));
+    }
+
+    return true;
+  };
+
+  for (int band_start=0; band_start<dst_height; band_start+=kDownsampleBandHeight) {
+    int band_end = qMin(band_start + kDownsampleBandHeight, dst_height);
+
+    // Read only the source rows under each output row, at most kMaxRowsPerBox from its center
+    band_rows.resize(band_end - band_start);
+    for (int y=band_start; y<band_end; y++) {
+      int y0 = y * src_height / dst_height;
+      int y1 = qMax(y0 + 1, (y + 1) * src_height / dst_height);
+
+      if (y1 - y0 > kMaxRowsPerBox) {
+        y0 = (y0 + y1) / 2 - kMaxRowsPerBox / 2;
+        y1 = y0 + kMaxRowsPerBox;
+      }
+
+      int band_index = y - band_start;
+      float *row_dst = rows.data() + src_row_floats * kMaxRowsPerBox * band_index;
+
+      if (!read_rows(y0, y1, row_dst)) {
+        std::fill(row_dst, row_dst + src_row_floats * (y1 - y0), 0.0f);
+      }
+
+      row_counts[band_index] = y1 - y0;
+      band_rows[band_index] = y;
+    }
+
+    // Box filter each output row on its own thread
+    QtConcurrent::blockingMap(band_rows, [&](const int &y){
+      int band_index = y - band_start;
+      const float *src = rows.data() + src_row_floats * kMaxRowsPerBox * band_index;
+      int row_count = row_counts.at(band_index);
+
+      std::vector<float> out(size_t(dst_width) * channels, 0.0f);
+
+      for (int x=0; x<dst_width; x++) {
+        int x0 = x * src_width / dst_width;
+        int x1 = qMax(x0 + 1, (x + 1) * src_width / dst_width);
+
+        float *o = out.data() + size_t(x) * channels;
+
+        for (int r=0; r<row_count; r++) {
+          const float *s = src + src_row_floats * r + size_t(x0) * channels;
+
+          for (int sx=x0; sx<x1; sx++) {
+            for (int c=0; c<channels; c++) {
+              o[c] += s[c];
+            }
+            s += channels;
+          }
+        }
+
+        const float scale = 1.0f / float((x1 - x0) * row_count);
+        for (int c=0; c<channels; c++) {
+          o[c] *= scale;
+        }
+      }
+
+      OIIO::convert_pixel_values(OIIO::TypeDesc::FLOAT, out.data(),
+                                 OIIO::TypeDesc(format), dst->data() + dst->linesize_bytes() * y,
+                                 dst_width * channels);
+    });
+  }
+
+  // Leave the input on the full resolution level so its spec stays valid for callers
+  input->seek_subimage(subimage, 0);
+}
+
+FramePtr OIIODecoder::ReadSequenceFrame(const QString &filename, int subimage, int divider, CancelAtom *cancelled)
+{
+  // Prefetches that fell out of the window are cancelled before they get a thread, skip them
+  // without touching the disk
+  if (cancelled && cancelled->IsCancelled()) {
+    return nullptr;
+  }
+
+  std::unique_ptr<OIIO::ImageInput> input = OIIO::ImageInput::open(filename.toStdString());
+
+  if (!input) {
+    return nullptr;
+  }
+
+  if (!input->seek_subimage(subimage, 0)) {
+    input->close();
+    return nullptr;
+  }
+
+  PixelFormat pix_fmt = OIIOUtils::GetFormatFromOIIOBasetype(static_cast<OIIO::TypeDesc::BASETYPE>(input->spec().format.basetype));
+  OIIO::TypeDesc::BASETYPE oiio_pix_fmt = OIIOUtils::GetOIIOBaseTypeFromFormat(pix_fmt);
+
+  if (pix_fmt == PixelFormat::INVALID || oiio_pix_fmt == OIIO::TypeDesc::UNKNOWN) {
+    input->close();
+    return nullptr;
+  }
+
+  VideoParams vp = GetVideoParamsFromImageSpec(input->spec());
+  vp.set_divider(divider);
+
+  if (cancelled && cancelled->IsCancelled()) {
+    input->close();
+    return nullptr;
+  }
+
+  FramePtr frame = Frame::Create();
+  frame->set_video_params(vp);
+  if (!frame->allocate()) {
+    input->close();
+    return nullptr;
+  }
+
+  ReadImage(input.get(), subimage, oiio_pix_fmt, frame.get(), divider);
+
+  input->close();
+
+  return frame;
+}
+
+TexturePtr OIIODecoder::RetrieveSequenceFrame(const RetrieveVideoParams &p)
+{
+  SequenceRing &ring = GetSequenceRing(p.divider);
+
+  int64_t index = p.sequence_index;
+  UpdateSequenceDirection(ring, index);
+
+  CollectPrefetchedFrames(ring);
+
+  FramePtr frame = ring.frames.value(index);
+
+  if (!frame) {
+    auto pending = ring.pending.find(index);
+    if (pending != ring.pending.end()) {
+      // Already being read, wait for it rather than reading it twice
+      frame = pending->future.result();
+      ring.pending.erase(pending);
+    } else {
+      frame = ReadSequenceFrame(TransformImageSequenceFileName(stream().filename(), index), stream().stream(), p.divider);
+    }
+
+    if (frame) {
+      qint64 frame_bytes = qMax(1, frame->allocated_size());
+      qint64 ring_bytes = kSequenceCacheSize / sequence_rings_.size();
+      ring.capacity = int(qBound(qint64(2), ring_bytes / frame_bytes, qint64(kMaxSequenceFrames)));
+
+      ring.frames.insert(index, frame);
+    }
+  }
+
+  TrimSequenceFrames(ring, index);
+  PrefetchSequenceFrames(ring, index, p.divider);
+
+  if (!frame) {
+    return nullptr;
+  }
+
+  return p.renderer->CreateTexture(frame->video_params(), frame->data(), frame->linesize_pixels());
+}
+
+OIIODecoder::SequenceRing &OIIODecoder::GetSequenceRing(int divider)
+{
+  if (!sequence_rings_.contains(divider) && sequence_rings_.size() >= kMaxSequenceRings) {
+    auto oldest = sequence_rings_.begin();
+    for (auto it=sequence_rings_.begin(); it!=sequence_rings_.end(); it++) {
+      if (it->last_used < oldest->last_used) {
+        oldest = it;
+      }
+    }
+
+    ClearSequenceRing(*oldest);
+    sequence_rings_.erase(oldest);
+  }
+
+  SequenceRing &ring = sequence_rings_[divider];
+  ring.last_used = ++sequence_request_count_;
+  return ring;
+}
+
+void OIIODecoder::UpdateSequenceDirection(SequenceRing &ring, int64_t index)
+{
+  if (ring.last_index != -1 && index != ring.last_index) {
+    int request_direction = (index < ring.last_index) ? -1 : 1;
+
+    if (request_direction == ring.direction) {
+      ring.reversals = 0;
+    } else if (++ring.reversals >= kSequenceDirectionChangeCount) {
+      ring.direction = request_direction;
+      ring.reversals = 0;
+    }
+  }
+
+  ring.last_index = index;
+}
+
+void OIIODecoder::CollectPrefetchedFrames(SequenceRing &ring)
+{
+  for (auto it=ring.pending.begin(); it!=ring.pending.end(); ) {
+    if (it->future.isFinished()) {
+      if (FramePtr f = it->future.result()) {
+        ring.frames.insert(it.key(), f);
+      }
+      it = ring.pending.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
+void OIIODecoder::TrimSequenceFrames(SequenceRing &ring, int64_t index)
+{
+  int direction = ring.direction;
+
+  // Frames behind the playhead go first, then whichever are furthest ahead
+  while (ring.frames.size() > ring.capacity) {
+    auto behind = (direction > 0) ? ring.frames.begin() : std::prev(ring.frames.end());
+    if ((behind.key() - index) * direction < 0) {
+      ring.frames.erase(behind);
+    } else {
+      ring.frames.erase((direction > 0) ? std::prev(ring.frames.end()) : ring.frames.begin());
+    }
+  }
+
+  // Cancel reads that are no longer ahead of us so they don't hold up the ones that are
+  int prefetch = qMin(kSequencePrefetchCount, ring.capacity - 1);
+  for (auto it=ring.pending.begin(); it!=ring.pending.end(); ) {
+    int64_t distance = (it.key() - index) * direction;
+    if (distance <= 0 || distance > prefetch) {
+      it->cancelled->Cancel();
+      it = ring.pending.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
+void OIIODecoder::PrefetchSequenceFrames(SequenceRing &ring, int64_t index, int divider)
+{
+  int prefetch = qMin(kSequencePrefetchCount, ring.capacity - 1);
+
+  for (int i=1; i<=prefetch; i++) {
+    int64_t next = index + i * ring.direction;
+
+    if (next < 0) {
+      break;
+    }
+
+    if (ring.frames.contains(next) || ring.pending.contains(next)) {
+      continue;
+    }
+
+    QString filename = TransformImageSequenceFileName(stream().filename(), next);
+    if (!QFileInfo::exists(filename)) {
+      // Reached the end of the sequence
+      break;
+    }
+
+    PendingSequenceFrame pending;
+    pending.cancelled = std::make_shared<CancelAtom>();
+
+    std::shared_ptr<CancelAtom> cancelled = pending.cancelled;
+    int subimage = stream().stream();
+    pending.future = QtConcurrent::run(GetSequenceThreadPool(), [filename, subimage, divider, cancelled]{
+      return ReadSequenceFrame(filename, subimage, divider, cancelled.get());
+    });
+
+    ring.pending.insert(next, pending);
+  }
+}
+
+void OIIODecoder::ClearSequenceRing(SequenceRing &ring)
+{
+  ring.frames.clear();
+
+  for (auto it=ring.pending.begin(); it!=ring.pending.end(); it++) {
+    it->cancelled->Cancel();
+  }
+  ring.pending.clear();
+}
+
+void OIIODecoder::ClearSequenceFrames()
+{
+  for (auto it=sequence_rings_.begin(); it!=sequence_rings_.end(); it++) {
+    ClearSequenceRing(*it);
+  }
+  sequence_rings_.clear();
+}
+
 bool OIIODecoder::FileTypeIsSupported(const QString& fn)
 {
   // We prioritize OIIO over FFmpeg to pick up still images more effectively, but some OIIO decoders (notably OpenJPEG)
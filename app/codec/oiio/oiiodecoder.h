@@ -23,6 +23,8 @@
 
 #include <OpenImageIO/imageio.h>
 #include <OpenImageIO/imagebuf.h>
+#include <QFuture>
+#include <QMap>
 
 #include "codec/decoder.h"
 
@@ -39,9 +41,15 @@ public:
   virtual QString id() const override;
 
   virtual bool SupportsVideo() override{return true;}
+  virtual bool SupportsImageSequences() override{return true;}
 
   virtual FootageDescription Probe(const QString& filename, CancelAtom *cancelled) const override;
 
+  /**
+   * @brief Open, read and close one file of a sequence on its own ImageInput, safe to run on any thread
+   */
+  static FramePtr ReadSequenceFrame(const QString &filename, int subimage, int divider, CancelAtom *cancelled = nullptr);
+
 protected:
   virtual bool OpenInternal() override;
   virtual TexturePtr RetrieveVideoInternal(const RetrieveVideoParams& p) override;
@@ -58,6 +66,63 @@ private:
 
   static VideoParams GetVideoParamsFromImageSpec(const OIIO::ImageSpec &spec);
 
+  /**
+   * @brief Read an image into dst, reduced by divider
+   *
+   * Reduced reads come from the smallest MIP level that's still large enough when the file has
+   * them, only read the scanlines the output needs (or each row of tiles once for tiled files),
+   * and are box filtered across threads.
+   */
+  static void ReadImage(OIIO::ImageInput *input, int subimage, OIIO::TypeDesc::BASETYPE format, Frame *dst, int divider);
+
+  struct PendingSequenceFrame
+  {
+    QFuture<FramePtr> future;
+    std::shared_ptr<CancelAtom> cancelled;
+  };
+
+  /**
+   * @brief Frames read (and being read ahead) at one divider
+   */
+  struct SequenceRing
+  {
+    SequenceRing() :
+      capacity(2),
+      last_index(-1),
+      direction(1),
+      reversals(0),
+      last_used(0)
+    {
+    }
+
+    QMap<int64_t, FramePtr> frames;
+    QMap<int64_t, PendingSequenceFrame> pending;
+    int capacity;
+    int64_t last_index;
+    int direction;
+
+    /// Consecutive requests against `direction`, it only flips once there are enough of them
+    int reversals;
+
+    uint64_t last_used;
+  };
+
+  TexturePtr RetrieveSequenceFrame(const RetrieveVideoParams &p);
+
+  SequenceRing &GetSequenceRing(int divider);
+
+  static void UpdateSequenceDirection(SequenceRing &ring, int64_t index);
+
+  static void CollectPrefetchedFrames(SequenceRing &ring);
+
+  static void TrimSequenceFrames(SequenceRing &ring, int64_t index);
+
+  void PrefetchSequenceFrames(SequenceRing &ring, int64_t index, int divider);
+
+  static void ClearSequenceRing(SequenceRing &ring);
+
+  void ClearSequenceFrames();
+
   PixelFormat pix_fmt_;
   OIIO::TypeDesc::BASETYPE oiio_pix_fmt_;
 
@@ -66,6 +131,13 @@ private:
 
   static QStringList supported_formats_;
 
+  /**
+   * @brief Keyed by divider, so renders at different resolutions (e.g. viewer and thumbnails)
+   * don't throw away each other's frames and read-ahead
+   */
+  QMap<int, SequenceRing> sequence_rings_;
+  uint64_t sequence_request_count_;
+
 };
 
 }
@@ -69,10 +69,13 @@ void Config::SetDefaults()
   SetEntryInternal(QStringLiteral("DefaultStillLength"), NodeValue::kRational, QVariant::fromValue(rational(2)));
   SetEntryInternal(QStringLiteral("HoverFocus"), NodeValue::kBoolean, false);
   SetEntryInternal(QStringLiteral("AudioScrubbing"), NodeValue::kBoolean, true);
+  SetEntryInternal(QStringLiteral("RealtimeAudioPlayback"), NodeValue::kBoolean, true);
   SetEntryInternal(QStringLiteral("AutorecoveryEnabled"), NodeValue::kBoolean, true);
   SetEntryInternal(QStringLiteral("AutorecoveryInterval"), NodeValue::kInt, 1);
   SetEntryInternal(QStringLiteral("AutorecoveryMaximum"), NodeValue::kInt, 20);
   SetEntryInternal(QStringLiteral("DiskCacheSaveInterval"), NodeValue::kInt, 10000);
+  SetEntryInternal(QStringLiteral("UndoMemoryBudget"), NodeValue::kInt, 512);
+  SetEntryInternal(QStringLiteral("TexturePoolBudget"), NodeValue::kInt, 1024);
   SetEntryInternal(QStringLiteral("Language"), NodeValue::kText, QString());
   SetEntryInternal(QStringLiteral("ScrollZooms"), NodeValue::kBoolean, false);
   SetEntryInternal(QStringLiteral("EnableSeekToImport"), NodeValue::kBoolean, false);
@@ -54,6 +54,7 @@
 #include "node/color/colormanager/colormanager.h"
 #include "node/factory.h"
 #include "node/nodeundo.h"
+#include "node/project/serializer/journal.h"
 #include "node/project/serializer/serializer.h"
 #include "panel/panelmanager.h"
 #include "panel/project/project.h"
@@ -88,6 +89,7 @@ Core::Core(const CoreParams& params) :
   tool_(Tool::kPointer),
   addable_object_(Tool::kAddableEmpty),
   snapping_(true),
+  autorecovery_journal_(nullptr),
   core_params_(params),
   magic_(false),
   pixel_sampling_users_(0),
@@ -957,9 +959,16 @@ void Core::SaveAutorecovery()
     if (open_project_ && !open_project_->has_autorecovery_been_saved()) {
       QDir project_autorecovery_dir(QDir(FileFunctions::GetAutoRecoveryRoot()).filePath(open_project_->GetUuid().toString()));
       if (FileFunctions::DirectoryIsValid(project_autorecovery_dir)) {
-        QString this_autorecovery_path = project_autorecovery_dir.filePath(QStringLiteral("%1.ove").arg(QString::number(QDateTime::currentSecsSinceEpoch())));
+        // Only the changes since the last auto-recovery are written (in the background), with a
+        // new full snapshot taken every so often
+        if (!autorecovery_journal_ || autorecovery_journal_->project() != open_project_) {
+          delete autorecovery_journal_;
+          autorecovery_journal_ = new ProjectJournal(open_project_, this);
+        }
 
-        SaveProjectInternal(this_autorecovery_path);
+        QString this_autorecovery_path = autorecovery_journal_->Save(project_autorecovery_dir.path(),
+                                                                     QString::number(QDateTime::currentSecsSinceEpoch()),
+                                                                     main_window_->SaveLayout());
 
         open_project_->set_autorecovery_saved(true);
 
@@ -980,11 +989,14 @@ void Core::SaveAutorecovery()
 
         int64_t max_recoveries_per_file = OLIVE_CONFIG("AutorecoveryMaximum").toLongLong();
 
-        // Since we write an extra file, increment total allowed files by 1
-        max_recoveries_per_file++;
-
         // Delete old entries
-        QStringList recovery_files = project_autorecovery_dir.entryList(QDir::Files | QDir::NoDotAndDotDot, QDir::Name);
+        QStringList recovery_files = project_autorecovery_dir.entryList({QStringLiteral("*.ove")}, QDir::Files | QDir::NoDotAndDotDot, QDir::Name);
+
+        // Skip snapshots still being written in the background
+        recovery_files.erase(std::remove_if(recovery_files.begin(), recovery_files.end(), [](const QString &f){
+          return f.contains(QStringLiteral(".tmp"));
+        }), recovery_files.end());
+
         while (recovery_files.size() > max_recoveries_per_file) {
           bool deleted = false;
           for (int i=0; i<recovery_files.size(); i++) {
@@ -1006,6 +1018,22 @@ void Core::SaveAutorecovery()
             break;
           }
         }
+
+        // Delete snapshots (and their journals) that no remaining recovery refers to
+        QSet<QString> referenced_snapshots;
+        referenced_snapshots.insert(autorecovery_journal_->GetSnapshotFilename());
+        foreach (const QString &f, recovery_files) {
+          referenced_snapshots.insert(ProjectJournal::GetRecoveryPointSnapshot(project_autorecovery_dir.filePath(f)));
+        }
+
+        QStringList snapshot_files = project_autorecovery_dir.entryList({QStringLiteral("*.snapshot")}, QDir::Files | QDir::NoDotAndDotDot);
+        foreach (const QString &f, snapshot_files) {
+          QString snapshot_full_path = project_autorecovery_dir.filePath(f);
+          if (!referenced_snapshots.contains(snapshot_full_path)) {
+            QFile::remove(snapshot_full_path);
+            QFile::remove(ProjectJournal::GetJournalFilename(snapshot_full_path));
+          }
+        }
       } else {
         QMessageBox::critical(main_window_, tr("Auto-Recovery Error"),
                               tr("Failed to save auto-recovery to \"%1\". "
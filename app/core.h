@@ -38,6 +38,7 @@
 namespace olive {
 
 class MainWindow;
+class ProjectJournal;
 
 /**
  * @brief The main central Olive application instance
@@ -543,6 +544,11 @@ private:
    */
   QTimer autorecovery_timer_;
 
+  /**
+   * @brief Journal used to save autorecoveries incrementally
+   */
+  ProjectJournal *autorecovery_journal_;
+
   /**
    * @brief Application-wide undo stack instance
    */
@@ -54,6 +54,12 @@ PreferencesBehaviorTab::PreferencesBehaviorTab()
   AddItem(tr("Enable audio scrubbing"),
           QStringLiteral("AudioScrubbing"),
           audio_group);
+  AddItem(tr("Mix playback audio in realtime"),
+          QStringLiteral("RealtimeAudioPlayback"),
+          tr("Playback audio is mixed directly from the sequence on a dedicated high priority thread "
+             "so that changes to volume, pan, etc. are heard immediately. Disable this to have "
+             "playback wait behind background audio caching instead."),
+          audio_group);
 
   QTreeWidgetItem* timeline_group = AddParent(tr("Timeline"));
   AddItem(tr("Auto-Seek to Imported Clips"),
@@ -150,6 +150,23 @@ PreferencesGeneralTab::PreferencesGeneralTab()
     autorecovery_layout->addWidget(browse_autorecoveries, row, 1);
   }
 
+  {
+    QGroupBox* undo_groupbox = new QGroupBox(tr("Undo History"));
+    QGridLayout* undo_layout = new QGridLayout(undo_groupbox);
+    layout->addWidget(undo_groupbox);
+
+    int row = 0;
+
+    undo_layout->addWidget(new QLabel(tr("Maximum Memory Usage:")), row, 0);
+
+    undo_memory_budget_ = new IntegerSlider();
+    undo_memory_budget_->SetMinimum(16);
+    undo_memory_budget_->SetMaximum(16384);
+    undo_memory_budget_->SetFormat(tr("%1 MB"));
+    undo_memory_budget_->SetValue(OLIVE_CONFIG("UndoMemoryBudget").toLongLong());
+    undo_layout->addWidget(undo_memory_budget_, row, 1);
+  }
+
   layout->addStretch();
 }
 
@@ -179,6 +196,8 @@ void PreferencesGeneralTab::Accept(MultiUndoCommand *command)
   OLIVE_CONFIG("AutorecoveryInterval") = QVariant::fromValue(autorecovery_interval_->GetValue());
   OLIVE_CONFIG("AutorecoveryMaximum") = QVariant::fromValue(autorecovery_maximum_->GetValue());
   Core::instance()->SetAutorecoveryInterval(autorecovery_interval_->GetValue());
+
+  OLIVE_CONFIG("UndoMemoryBudget") = QVariant::fromValue(undo_memory_budget_->GetValue());
 }
 
 void PreferencesGeneralTab::AddLanguage(const QString &locale_name)
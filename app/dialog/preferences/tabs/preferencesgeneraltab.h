@@ -57,6 +57,8 @@ private:
 
   IntegerSlider* autorecovery_maximum_;
 
+  IntegerSlider* undo_memory_budget_;
+
 };
 
 }
@@ -70,16 +70,23 @@ int decompress_project(const QString &project)
 
   printf("%s\n", QCoreApplication::translate("main", "Decompressing project...").toUtf8().constData());
 
-  if (!olive::ProjectSerializer::CheckCompressedID(&project_file)) {
-    printf("%s\n", QCoreApplication::translate("main", "Failed to decompress, project may be corrupt").toUtf8().constData());
-    return 1;
-  }
+  QByteArray decompressed;
 
-  QByteArray b = project_file.readAll();
+  if (olive::ProjectSerializer::CheckChunkedID(&project_file)) {
+    // Chunked projects are reassembled into a single XML document
+    decompressed = olive::ProjectSerializer::ConvertChunkedToXml(&project_file);
+  } else {
+    project_file.seek(0);
 
-  project_file.close();
+    if (!olive::ProjectSerializer::CheckCompressedID(&project_file)) {
+      printf("%s\n", QCoreApplication::translate("main", "Failed to decompress, project may be corrupt").toUtf8().constData());
+      return 1;
+    }
+
+    decompressed = qUncompress(project_file.readAll());
+  }
 
-  QByteArray decompressed = qUncompress(b);
+  project_file.close();
 
   if (decompressed.isEmpty()) {
     printf("%s\n", QCoreApplication::translate("main", "Failed to decompress, project may be corrupt").toUtf8().constData());
@@ -418,6 +418,7 @@ void ClipBlock::InputConnectedEvent(const QString &input, int element, Node *out
     connect(output->audio_playback_cache(), &AudioPlaybackCache::Invalidated, this, &Block::PreviewChanged);
     connect(output->thumbnail_cache(), &FrameHashCache::Validated, this, &Block::PreviewChanged);
     connect(output->waveform_cache(), &AudioPlaybackCache::Validated, this, &Block::PreviewChanged);
+    connect(output->waveform_cache(), &AudioWaveformCache::TilesLoaded, this, &Block::PreviewChanged);
     connect(output->video_frame_cache(), &FrameHashCache::Validated, this, &Block::PreviewChanged);
     connect(output->audio_playback_cache(), &AudioPlaybackCache::Validated, this, &Block::PreviewChanged);
   }
@@ -434,6 +435,7 @@ void ClipBlock::InputDisconnectedEvent(const QString &input, int element, Node *
     disconnect(output->audio_playback_cache(), &AudioPlaybackCache::Invalidated, this, &Block::PreviewChanged);
     disconnect(output->thumbnail_cache(), &FrameHashCache::Validated, this, &Block::PreviewChanged);
     disconnect(output->waveform_cache(), &AudioPlaybackCache::Validated, this, &Block::PreviewChanged);
+    disconnect(output->waveform_cache(), &AudioWaveformCache::TilesLoaded, this, &Block::PreviewChanged);
     disconnect(output->video_frame_cache(), &FrameHashCache::Validated, this, &Block::PreviewChanged);
     disconnect(output->audio_playback_cache(), &AudioPlaybackCache::Validated, this, &Block::PreviewChanged);
   }
@@ -457,7 +459,8 @@ void ClipBlock::InputValueChangedEvent(const QString &input, int element)
         }
       }
     }
-  } else if (input == kLoopModeInput) {
+  } else if (input == kLoopModeInput || input == kMediaInInput
+             || input == kSpeedInput || input == kReverseInput) {
     emit PreviewChanged();
   }
 }
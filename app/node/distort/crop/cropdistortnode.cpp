@@ -79,6 +79,7 @@ void CropDistortNode::Value(const NodeValueRow &value, const NodeGlobals &global
 {
   ShaderJob job;
   job.Insert(value);
+  job.SetFusableInput(kTextureInput);
 
   if (TexturePtr texture = job.Get(kTextureInput).toTexture()) {
     job.Insert(QStringLiteral("resolution_in"), NodeValue(NodeValue::kVec2, QVector2D(texture->params().width(), texture->params().height()), this));
@@ -73,6 +73,7 @@ void MaskDistortNode::Value(const NodeValueRow &value, const NodeGlobals &global
     ShaderJob invert;
     invert.SetShaderID(QStringLiteral("invert"));
     invert.Insert(QStringLiteral("tex_in"), job);
+    invert.SetFusableInput(QStringLiteral("tex_in"));
     job.set_value(Texture::Job(job_params, invert));
   }
 
@@ -82,6 +83,7 @@ void MaskDistortNode::Value(const NodeValueRow &value, const NodeGlobals &global
 
     merge.SetShaderID(QStringLiteral("mrg"));
     merge.Insert(QStringLiteral("tex_a"), value[kBaseInput]);
+    merge.SetFusableInput(QStringLiteral("tex_a"));
 
     if (value[kFeatherInput].toDouble() > 0.0) {
       // Nest a blur shader in there too
@@ -53,9 +53,12 @@ void OpacityEffect::Value(const NodeValueRow &value, const NodeGlobals &globals,
     if (TexturePtr opacity_tex = value[kValueInput].toTexture()) {
       ShaderJob job(value);
       job.SetShaderID(QStringLiteral("rgbmult"));
+      job.SetFusableInput(kTextureInput);
       table->Push(NodeValue::kTexture, tex->toJob(job), this);
     } else if (!qFuzzyCompare(value[kValueInput].toDouble(), 1.0)) {
-      table->Push(NodeValue::kTexture, tex->toJob(ShaderJob(value)), this);
+      ShaderJob job(value);
+      job.SetFusableInput(kTextureInput);
+      table->Push(NodeValue::kTexture, tex->toJob(job), this);
     } else {
       // 1.0 float is a no-op, so just push the texture
       table->Push(value[kTextureInput]);
@@ -113,8 +113,12 @@ void BlurFilterNode::Retranslate()
 
 ShaderCode BlurFilterNode::GetShaderCode(const ShaderRequest &request) const
 {
-  Q_UNUSED(request)
-  return ShaderCode(FileFunctions::ReadFileAsString(":/shaders/blur.frag"));
+  if (request.id == QStringLiteral("resample")) {
+    // Default shader, scaling is done by the texture sampler
+    return ShaderCode();
+  } else {
+    return ShaderCode(FileFunctions::ReadFileAsString(":/shaders/blur.frag"));
+  }
 }
 
 void BlurFilterNode::Value(const NodeValueRow &value, const NodeGlobals &globals, NodeValueTable *table) const
@@ -157,7 +161,35 @@ void BlurFilterNode::Value(const NodeValueRow &value, const NodeGlobals &globals
       ShaderJob job(value);
       job.Insert(QStringLiteral("resolution_in"), NodeValue(NodeValue::kVec2, tex->virtual_resolution(), this));
       job.SetIterations(iterations, kTextureInput);
-      table->Push(NodeValue::kTexture, tex->toJob(job), this);
+
+      int levels = GetPyramidLevelCount(value, tex->params());
+
+      if (levels == 0) {
+        table->Push(NodeValue::kTexture, tex->toJob(job), this);
+      } else {
+        // Blur a downscaled copy with a proportionally smaller radius so the number of samples per
+        // pixel stays bounded no matter how large the radius is, then scale the result back up
+        int scale = 1 << levels;
+
+        VideoParams small_params = tex->params();
+        small_params.set_divider(small_params.divider() * scale);
+
+        ShaderJob downsample;
+        downsample.SetShaderID(QStringLiteral("resample"));
+        downsample.Insert(QStringLiteral("ove_maintex"), value[kTextureInput]);
+
+        job.Insert(kTextureInput, NodeValue(NodeValue::kTexture, Texture::Job(small_params, downsample), this));
+        job.Insert(kRadiusInput, NodeValue(NodeValue::kFloat, value[kRadiusInput].toDouble() / scale, this));
+        job.Insert(kRadialCenterInput, NodeValue(NodeValue::kVec2, value[kRadialCenterInput].toVec2() / scale, this));
+        job.Insert(QStringLiteral("resolution_in"), NodeValue(NodeValue::kVec2, tex->virtual_resolution() / scale, this));
+
+        ShaderJob upsample;
+        upsample.SetShaderID(QStringLiteral("resample"));
+        upsample.Insert(QStringLiteral("ove_maintex"), NodeValue(NodeValue::kTexture, Texture::Job(small_params, job), this));
+        upsample.SetInterpolation(QStringLiteral("ove_maintex"), Texture::kLinear);
+
+        table->Push(NodeValue::kTexture, tex->toJob(upsample), this);
+      }
     } else {
       // If we're not performing the blur job, just push the texture
       table->Push(value[kTextureInput]);
@@ -207,6 +239,35 @@ void BlurFilterNode::InputValueChangedEvent(const QString &input, int element)
   super::InputValueChangedEvent(input, element);
 }
 
+int BlurFilterNode::GetPyramidLevelCount(const NodeValueRow &value, const VideoParams &params)
+{
+  Method method = static_cast<Method>(value[kMethodInput].toInt());
+
+  if (method == kDirectional || method == kRadial
+      || !(value[kHorizInput].toBool() && value[kVertInput].toBool())) {
+    // Downscaling would also soften the axis that isn't being blurred. Directional and radial
+    // blurs only blur along one axis at each pixel, so they never qualify.
+    return 0;
+  }
+
+  double radius = value[kRadiusInput].toDouble();
+  int levels = 0;
+
+  while (radius > kMaxPyramidLevelRadius && levels < kMaxPyramidLevels) {
+    VideoParams next = params;
+    next.set_divider(params.divider() << (levels + 1));
+
+    if (next.effective_width() < kMinPyramidLevelSize || next.effective_height() < kMinPyramidLevelSize) {
+      break;
+    }
+
+    radius *= 0.5;
+    levels++;
+  }
+
+  return levels;
+}
+
 void BlurFilterNode::UpdateInputs(Method method)
 {
   SetInputFlag(kHorizInput, kInputFlagHidden, !(method == kBox || method == kGaussian));
@@ -78,6 +78,18 @@ protected:
 private:
   void UpdateInputs(Method method);
 
+  /**
+   * @brief How many times to halve the input before blurring it, 0 to blur at full size
+   */
+  static int GetPyramidLevelCount(const NodeValueRow &value, const VideoParams &params);
+
+  /// Radii above this (in sequence pixels) are blurred on a downscaled copy instead
+  static const int kMaxPyramidLevelRadius = 16;
+
+  static const int kMaxPyramidLevels = 6;
+
+  static const int kMinPyramidLevelSize = 16;
+
   PointGizmo *radial_center_gizmo_;
 
 };
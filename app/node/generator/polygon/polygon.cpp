@@ -28,6 +28,16 @@ namespace olive {
 const QString PolygonGenerator::kPointsInput = QStringLiteral("points_in");
 const QString PolygonGenerator::kColorInput = QStringLiteral("color_in");
 
+// Filled paths are cached up to this many bytes across all polygon and mask nodes
+static const int kPolygonRasterCacheSize = 128 * 1024 * 1024;
+
+// Fills are only cached once their key has been seen this recently, so animated masks don't fill the cache
+static const int kPolygonSeenKeyCount = 64;
+
+QMutex PolygonGenerator::raster_cache_lock_;
+QCache<QByteArray, QImage> PolygonGenerator::raster_cache_(kPolygonRasterCacheSize);
+QCache<QByteArray, bool> PolygonGenerator::seen_keys_(kPolygonSeenKeyCount);
+
 #define super GeneratorWithMerge
 
 PolygonGenerator::PolygonGenerator()
@@ -98,6 +108,7 @@ ShaderJob PolygonGenerator::GetGenerateJob(const NodeValueRow &value, const Vide
   rgb.SetShaderID(QStringLiteral("rgb"));
   rgb.Insert(QStringLiteral("texture_in"), NodeValue(NodeValue::kTexture, job, this));
   rgb.Insert(QStringLiteral("color_in"), value[kColorInput]);
+  rgb.SetFusableInput(QStringLiteral("texture_in"));
 
   return rgb;
 }
@@ -114,11 +125,37 @@ void PolygonGenerator::GenerateFrame(FramePtr frame, const GenerateJob &job) con
   // a single-channel QImage (alpha only) and then transplant that alpha channel to our float buffer
   // with correct float RGB.
   QImage img((uchar *) frame->data(), frame->width(), frame->height(), frame->linesize_bytes(), QImage::Format_RGBA8888_Premultiplied);
-  img.fill(Qt::transparent);
 
   auto points = job.Get(kPointsInput).toArray();
+  int size = InputArraySize(kPointsInput);
+
+  // Masks are very often static, so reuse the last fill of these exact points at this resolution
+  // rather than flattening and rasterizing the path again
+  QByteArray key = GetRasterKey(points, size, frame->video_params());
+  bool cache_fill;
+
+  {
+    QMutexLocker locker(&raster_cache_lock_);
+    if (QImage *cached = raster_cache_.object(key)) {
+      if (cached->size() == img.size()) {
+        int row_bytes = qMin(cached->bytesPerLine(), img.bytesPerLine());
+        for (int y=0; y<img.height(); y++) {
+          memcpy(img.scanLine(y), cached->constScanLine(y), row_bytes);
+        }
+        return;
+      }
+    }
 
-  QPainterPath path = GeneratePath(points, InputArraySize(kPointsInput));
+    // Animated points produce a new key every frame, only keep fills that have been asked for twice
+    cache_fill = seen_keys_.contains(key);
+    if (!cache_fill) {
+      seen_keys_.insert(key, new bool(true));
+    }
+  }
+
+  img.fill(Qt::transparent);
+
+  QPainterPath path = GeneratePath(points, size);
 
   QPainter p(&img);
   double par = frame->video_params().pixel_aspect_ratio().toDouble();
@@ -128,6 +165,14 @@ void PolygonGenerator::GenerateFrame(FramePtr frame, const GenerateJob &job) con
   p.setPen(Qt::NoPen);
 
   p.drawPath(path);
+  p.end();
+
+  int bytes = img.bytesPerLine() * img.height();
+  if (cache_fill && bytes <= kPolygonRasterCacheSize / 4) {
+    QMutexLocker locker(&raster_cache_lock_);
+    seen_keys_.remove(key);
+    raster_cache_.insert(key, new QImage(img.copy()), bytes);
+  }
 }
 
 template<typename T>
@@ -253,6 +298,36 @@ void PolygonGenerator::AddPointToPath(QPainterPath *path, const Bezier &before,
   path->cubicTo(QPointF(a.x, a.y), QPointF(b.x, b.y), QPointF(c.x, c.y));
 }
 
+QByteArray PolygonGenerator::GetRasterKey(const NodeValueArray &points, int size, const VideoParams &params)
+{
+  // Exact values are compared, so the doubles are stored as raw bytes rather than formatted
+  QVector<double> values;
+  values.reserve(size * 6 + 4);
+
+  values.append(params.width());
+  values.append(params.height());
+  values.append(params.divider());
+  values.append(params.pixel_aspect_ratio().toDouble());
+
+  if (!points.empty()) {
+    for (int i=0; i<size; i++) {
+      const Bezier &pt = points.at(i).toBezier();
+      Imath::V2d v = pt.to_vec();
+      Imath::V2d cp1 = pt.control_point_1_to_vec();
+      Imath::V2d cp2 = pt.control_point_2_to_vec();
+
+      values.append(v.x);
+      values.append(v.y);
+      values.append(cp1.x);
+      values.append(cp1.y);
+      values.append(cp2.x);
+      values.append(cp2.y);
+    }
+  }
+
+  return QByteArray(reinterpret_cast<const char*>(values.constData()), values.size() * int(sizeof(double)));
+}
+
 QPainterPath PolygonGenerator::GeneratePath(const NodeValueArray &points, int size)
 {
   QPainterPath path;
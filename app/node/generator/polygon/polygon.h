@@ -21,6 +21,8 @@
 #ifndef POLYGONGENERATOR_H
 #define POLYGONGENERATOR_H
 
+#include <QCache>
+#include <QMutex>
 #include <QPainterPath>
 
 #include "node/generator/shape/generatorwithmerge.h"
@@ -69,6 +71,12 @@ private:
 
   static QPainterPath GeneratePath(const NodeValueArray &points, int size);
 
+  static QByteArray GetRasterKey(const NodeValueArray &points, int size, const VideoParams &params);
+
+  static QMutex raster_cache_lock_;
+  static QCache<QByteArray, QImage> raster_cache_;
+  static QCache<QByteArray, bool> seen_keys_;
+
   template<typename T>
   void ValidateGizmoVectorSize(QVector<T*> &vec, int new_sz);
 
@@ -23,6 +23,7 @@
 #include <QAbstractTextDocumentLayout>
 #include <QDateTime>
 #include <QTextDocument>
+#include <QtMath>
 
 #include "common/html.h"
 #include "core.h"
@@ -44,6 +45,18 @@ const QString TextGeneratorV3::kVerticalAlignmentInput = QStringLiteral("valign_
 const QString TextGeneratorV3::kUseArgsInput = QStringLiteral("use_args_in");
 const QString TextGeneratorV3::kArgsInput = QStringLiteral("args_in");
 
+// 96 DPI in DPM (96 / 2.54 * 100)
+static const int kTextDotsPerMeter = 3780;
+
+// Text rasters are cached up to this many bytes across all text nodes
+static const int kTextRasterCacheSize = 64 * 1024 * 1024;
+
+// Cached rasters are positioned to this fraction of a pixel
+static const int kTextRasterSubpixelSteps = 8;
+
+QMutex TextGeneratorV3::raster_cache_lock_;
+QCache<QString, QImage> TextGeneratorV3::raster_cache_(kTextRasterCacheSize);
+
 TextGeneratorV3::TextGeneratorV3() :
   ShapeNodeBase(false),
   dont_emit_valign_(false)
@@ -134,38 +147,60 @@ void TextGeneratorV3::GenerateFrame(FramePtr frame, const GenerateJob& job) cons
   QImage img(reinterpret_cast<uchar*>(frame->data()), frame->width(), frame->height(), frame->linesize_bytes(), QImage::Format_RGBA8888_Premultiplied);
   img.fill(Qt::transparent);
 
-  // 96 DPI in DPM (96 / 2.54 * 100)
-  const int dpm = 3780;
-  img.setDotsPerMeterX(dpm);
-  img.setDotsPerMeterY(dpm);
+  img.setDotsPerMeterX(kTextDotsPerMeter);
+  img.setDotsPerMeterY(kTextDotsPerMeter);
+
+  QString html = job.Get(kTextInput).toString();
+  QVector2D size = job.Get(kSizeInput).toVec2();
+  QVector2D pos = job.Get(kPositionInput).toVec2();
+  VerticalAlignment valign = static_cast<VerticalAlignment>(job.Get(kVerticalAlignmentInput).toInt());
+  int divider = frame->video_params().divider();
+
+  // Top-left corner of the text box in sequence pixels
+  QPointF origin(pos.x() - size.x()/2 + frame->video_params().width()/2,
+                 pos.y() - size.y()/2 + frame->video_params().height()/2);
 
+  QPainter p(&img);
+
+  // QPainter rounds image positions to whole pixels, so the fraction is baked into the raster
+  QPointF scaled_origin = origin / divider;
+  QPoint whole_origin(qFloor(scaled_origin.x()), qFloor(scaled_origin.y()));
+  QPointF subpixel_offset = scaled_origin - whole_origin;
+  subpixel_offset.setX(qRound(subpixel_offset.x() * kTextRasterSubpixelSteps) / double(kTextRasterSubpixelSteps));
+  subpixel_offset.setY(qRound(subpixel_offset.y() * kTextRasterSubpixelSteps) / double(kTextRasterSubpixelSteps));
+
+  QImage raster = GetTextRaster(html, size, valign, divider, subpixel_offset);
+
+  if (!raster.isNull()) {
+    p.drawImage(whole_origin, raster);
+  } else {
+    p.scale(1.0 / divider, 1.0 / divider);
+    p.translate(origin);
+    DrawText(&p, &img, html, size, valign);
+  }
+}
+
+void TextGeneratorV3::DrawText(QPainter *p, QPaintDevice *device, const QString &html, const QVector2D &size, VerticalAlignment valign)
+{
   QTextDocument text_doc;
-  text_doc.documentLayout()->setPaintDevice(&img);
+  text_doc.documentLayout()->setPaintDevice(device);
 
-  QString html = job.Get(kTextInput).toString();
   Html::HtmlToDoc(&text_doc, html);
 
-  QVector2D size = job.Get(kSizeInput).toVec2();
   text_doc.setTextWidth(size.x());
 
-  // Draw rich text onto image
-  QPainter p(&img);
-  p.scale(1.0 / frame->video_params().divider(), 1.0 / frame->video_params().divider());
-
-  QVector2D pos = job.Get(kPositionInput).toVec2();
-  p.translate(pos.x() - size.x()/2, pos.y() - size.y()/2);
-  p.translate(frame->video_params().width()/2, frame->video_params().height()/2);
-  p.setClipRect(0, 0, size.x(), size.y());
+  // Draw rich text clipped to the box, painter is expected to be at the box's top-left corner
+  p->setClipRect(0, 0, size.x(), size.y());
 
-  switch (static_cast<VerticalAlignment>(job.Get(kVerticalAlignmentInput).toInt())) {
+  switch (valign) {
   case kVAlignTop:
     // Do nothing
     break;
   case kVAlignMiddle:
-    p.translate(0, size.y()/2-text_doc.size().height()/2);
+    p->translate(0, size.y()/2-text_doc.size().height()/2);
     break;
   case kVAlignBottom:
-    p.translate(0, size.y()-text_doc.size().height());
+    p->translate(0, size.y()-text_doc.size().height());
     break;
   }
 
@@ -173,7 +208,47 @@ void TextGeneratorV3::GenerateFrame(FramePtr frame, const GenerateJob& job) cons
   QAbstractTextDocumentLayout::PaintContext ctx;
   ctx.palette.setColor(QPalette::Text, Qt::white);
 
-  text_doc.documentLayout()->draw(&p, ctx);
+  text_doc.documentLayout()->draw(p, ctx);
+}
+
+QImage TextGeneratorV3::GetTextRaster(const QString &html, const QVector2D &size, VerticalAlignment valign, int divider, const QPointF &offset)
+{
+  QString key = QStringLiteral("%1:%2:%3:%4:%5:%6:%7").arg(QString::number(size.x()),
+                                                           QString::number(size.y()),
+                                                           QString::number(valign),
+                                                           QString::number(divider),
+                                                           QString::number(offset.x()),
+                                                           QString::number(offset.y()),
+                                                           html);
+
+  {
+    QMutexLocker locker(&raster_cache_lock_);
+    if (QImage *cached = raster_cache_.object(key)) {
+      return *cached;
+    }
+  }
+
+  QSize raster_size(qCeil(size.x() / divider + offset.x()), qCeil(size.y() / divider + offset.y()));
+  qint64 raster_bytes = qint64(raster_size.width()) * qint64(raster_size.height()) * 4;
+  if (raster_size.isEmpty() || raster_bytes > kTextRasterCacheSize / 4) {
+    return QImage();
+  }
+
+  QImage img(raster_size, QImage::Format_RGBA8888_Premultiplied);
+  img.fill(Qt::transparent);
+  img.setDotsPerMeterX(kTextDotsPerMeter);
+  img.setDotsPerMeterY(kTextDotsPerMeter);
+
+  QPainter p(&img);
+  p.translate(offset);
+  p.scale(1.0 / divider, 1.0 / divider);
+  DrawText(&p, &img, html, size, valign);
+  p.end();
+
+  QMutexLocker locker(&raster_cache_lock_);
+  raster_cache_.insert(key, new QImage(img), int(raster_bytes));
+
+  return img;
 }
 
 void TextGeneratorV3::UpdateGizmoPositions(const NodeValueRow &row, const NodeGlobals &globals)
@@ -21,6 +21,9 @@
 #ifndef TEXTGENERATORV3_H
 #define TEXTGENERATORV3_H
 
+#include <QCache>
+#include <QMutex>
+
 #include "node/generator/shape/shapenodebase.h"
 #include "node/gizmo/text.h"
 
@@ -73,6 +76,21 @@ protected:
   virtual void InputValueChangedEvent(const QString &input, int element) override;
 
 private:
+  static void DrawText(QPainter *p, QPaintDevice *device, const QString &html, const QVector2D &size, VerticalAlignment valign);
+
+  /**
+   * @brief Get the text box laid out and rasterized at this divider, from the cache if possible
+   *
+   * The text is drawn `offset` pixels into the raster so it can be placed at a whole pixel. The
+   * raster only depends on the text, box size, alignment, divider and sub-pixel offset, so moving
+   * the box or animating anything downstream reuses it. Returns a null image if the box is too
+   * large to cache, in which case the text should be drawn directly.
+   */
+  static QImage GetTextRaster(const QString &html, const QVector2D &size, VerticalAlignment valign, int divider, const QPointF &offset);
+
+  static QMutex raster_cache_lock_;
+  static QCache<QString, QImage> raster_cache_;
+
   TextGizmo *text_gizmo_;
 
   bool dont_emit_valign_;
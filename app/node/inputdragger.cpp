@@ -111,12 +111,17 @@ void NodeInputDragger::Drag(QVariant value)
 
   //input_->blockSignals(true);
 
+  // Drags fire constantly, so only invalidate each downstream node once per step
+  Node::BeginInvalidationBatch();
+
   if (input_.input().IsKeyframing()) {
     dragging_key_->set_value(value);
   } else {
     node->SetSplitStandardValueOnTrack(input_, value);
   }
 
+  Node::EndInvalidationBatch();
+
   //input_->blockSignals(false);
 }
 
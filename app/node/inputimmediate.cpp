@@ -20,13 +20,19 @@
 
 #include "inputimmediate.h"
 
+#include <QMutex>
+
 #include "common/lerp.h"
 #include "common/tohex.h"
 
 namespace olive {
 
+// Rebuilds are rare compared to evaluations, so every input shares one lock for them
+static QMutex keyframe_curve_lock;
+
 NodeInputImmediate::NodeInputImmediate(NodeValue::Type type, const SplitValue &default_val) :
   default_value_(default_val),
+  dirty_keyframe_curves_(0),
   keyframing_(false)
 {
   set_data_type(type);
@@ -178,9 +184,16 @@ void NodeInputImmediate::set_data_type(NodeValue::Type type)
 {
   int track_size = NodeValue::get_number_of_keyframe_tracks(type);
 
+  data_type_ = type;
+
   keyframe_tracks_.resize(track_size);
+  keyframe_curves_.resize(track_size);
   standard_value_.resize(track_size);
 
+  for (int i=0; i<track_size; i++) {
+    invalidate_keyframe_curve(i);
+  }
+
   set_split_standard_value(default_value_);
 }
 
@@ -253,6 +266,8 @@ void NodeInputImmediate::insert_keyframe(NodeKeyframe* key)
   if (next) {
     next->set_previous(key);
   }
+
+  invalidate_keyframe_curve(key->track());
 }
 
 void NodeInputImmediate::remove_keyframe(NodeKeyframe *key)
@@ -269,6 +284,30 @@ void NodeInputImmediate::remove_keyframe(NodeKeyframe *key)
   key->set_next(nullptr);
 
   keyframe_tracks_[key->track()].removeOne(key);
+
+  invalidate_keyframe_curve(key->track());
+}
+
+const NodeKeyframeCurve &NodeInputImmediate::keyframe_curve(int track) const
+{
+  uint32_t bit = 1u << track;
+
+  if (dirty_keyframe_curves_.load(std::memory_order_acquire) & bit) {
+    QMutexLocker locker(&keyframe_curve_lock);
+
+    // Another thread may have rebuilt it while we were waiting
+    if (dirty_keyframe_curves_.load(std::memory_order_relaxed) & bit) {
+      keyframe_curves_[track].Rebuild(keyframe_tracks_.at(track), data_type_);
+      dirty_keyframe_curves_.fetch_and(~bit, std::memory_order_release);
+    }
+  }
+
+  return keyframe_curves_.at(track);
+}
+
+void NodeInputImmediate::invalidate_keyframe_curve(int track)
+{
+  dirty_keyframe_curves_.fetch_or(1u << track, std::memory_order_release);
 }
 
 void NodeInputImmediate::delete_all_keyframes(QObject* parent)
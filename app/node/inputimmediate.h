@@ -21,8 +21,11 @@
 #ifndef NODEINPUTIMMEDIATE_H
 #define NODEINPUTIMMEDIATE_H
 
+#include <atomic>
+
 #include "common/xmlutils.h"
 #include "node/keyframe.h"
+#include "node/keyframecurve.h"
 #include "node/value.h"
 #include "splitvalue.h"
 
@@ -111,6 +114,22 @@ public:
     return keyframe_tracks_;
   }
 
+  /**
+   * @brief Return the compact evaluation copy of a keyframe track
+   *
+   * Rebuilt here if the track changed since it was last evaluated. Safe to call from several
+   * threads at once, as long as the track isn't being modified at the same time.
+   */
+  const NodeKeyframeCurve &keyframe_curve(int track) const;
+
+  /**
+   * @brief Mark a track's keyframe curve out of date after one of its keyframes changed
+   *
+   * The rebuild is deferred until the curve is next evaluated, so loading or dragging many
+   * keyframes doesn't rebuild it once per change.
+   */
+  void invalidate_keyframe_curve(int track);
+
   /**
    * @brief Return whether keyframing is enabled on this input or not
    */
@@ -170,6 +189,18 @@ private:
    */
   QVector<NodeKeyframeTrack> keyframe_tracks_;
 
+  /**
+   * @brief Evaluation copies of keyframe_tracks_, rebuilt lazily by keyframe_curve()
+   */
+  mutable QVector<NodeKeyframeCurve> keyframe_curves_;
+
+  /**
+   * @brief Bit per track whose entry in keyframe_curves_ is out of date
+   */
+  mutable std::atomic_uint32_t dirty_keyframe_curves_;
+
+  NodeValue::Type data_type_;
+
   /**
    * @brief Internal keyframing enabled setting
    */
@@ -0,0 +1,170 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "keyframecurve.h"
+
+#include <algorithm>
+
+#include "common/lerp.h"
+
+namespace olive {
+
+NodeKeyframeCurve::NodeKeyframeCurve() :
+  can_interpolate_(false)
+{
+}
+
+void NodeKeyframeCurve::Rebuild(const NodeKeyframeTrack &track, NodeValue::Type type)
+{
+  Clear();
+
+  int sz = track.size();
+
+  can_interpolate_ = NodeValue::type_can_be_interpolated(type);
+
+  times_.resize(sz);
+  types_.resize(sz);
+
+  if (can_interpolate_) {
+    values_.resize(sz);
+    in_x_.resize(sz);
+    in_y_.resize(sz);
+    out_x_.resize(sz);
+    out_y_.resize(sz);
+  }
+
+  for (int i=0; i<sz; i++) {
+    NodeKeyframe *key = track.at(i);
+
+    times_[i] = key->time().toDouble();
+    types_[i] = key->type();
+
+    if (can_interpolate_) {
+      double v;
+      if (type == NodeValue::kRational) {
+        v = key->value().value<rational>().toDouble();
+      } else {
+        v = key->value().toDouble();
+      }
+
+      QPointF cin = key->valid_bezier_control_in();
+      QPointF cout = key->valid_bezier_control_out();
+
+      values_[i] = v;
+      in_x_[i] = times_[i] + cin.x();
+      in_y_[i] = v + cin.y();
+      out_x_[i] = times_[i] + cout.x();
+      out_y_[i] = v + cout.y();
+    }
+  }
+}
+
+void NodeKeyframeCurve::Clear()
+{
+  times_.clear();
+  values_.clear();
+  types_.clear();
+  in_x_.clear();
+  in_y_.clear();
+  out_x_.clear();
+  out_y_.clear();
+  can_interpolate_ = false;
+}
+
+int NodeKeyframeCurve::GetIndexAtTime(double time) const
+{
+  // First keyframe strictly after this time, the one before it is ours
+  auto it = std::upper_bound(times_.cbegin(), times_.cend(), time);
+  return int(it - times_.cbegin()) - 1;
+}
+
+bool NodeKeyframeCurve::IsExact(int index, double time) const
+{
+  return index < 0
+      || index >= size() - 1
+      || !can_interpolate_
+      || times_[index] == time
+      || types_[index] == NodeKeyframe::kHold;
+}
+
+double NodeKeyframeCurve::Interpolate(int index, double time) const
+{
+  int before = index;
+  int after = index + 1;
+
+  Imath::V2d before_pt(times_[before], values_[before]);
+  Imath::V2d after_pt(times_[after], values_[after]);
+
+  if (types_[before] == NodeKeyframe::kBezier && types_[after] == NodeKeyframe::kBezier) {
+    // Perform a cubic bezier with two control points
+    return Bezier::CubicXtoY(time,
+                             before_pt,
+                             Imath::V2d(out_x_[before], out_y_[before]),
+                             Imath::V2d(in_x_[after], in_y_[after]),
+                             after_pt);
+  } else if (types_[before] == NodeKeyframe::kBezier) {
+    // Perform a quadratic bezier with only one control point
+    return Bezier::QuadraticXtoY(time, before_pt, Imath::V2d(out_x_[before], out_y_[before]), after_pt);
+  } else if (types_[after] == NodeKeyframe::kBezier) {
+    return Bezier::QuadraticXtoY(time, before_pt, Imath::V2d(in_x_[after], in_y_[after]), after_pt);
+  } else {
+    // To have arrived here, the keyframes must both be linear
+    double period_progress = (time - times_[before]) / (times_[after] - times_[before]);
+    return lerp(values_[before], values_[after], period_progress);
+  }
+}
+
+double NodeKeyframeCurve::Evaluate(double time) const
+{
+  int index = GetIndexAtTime(time);
+
+  if (IsExact(index, time)) {
+    return values_[qMax(0, index)];
+  }
+
+  return Interpolate(index, time);
+}
+
+void NodeKeyframeCurve::Evaluate(const double *times, double *out, int count) const
+{
+  if (count <= 0) {
+    return;
+  }
+
+  int index = GetIndexAtTime(times[0]);
+  int last = size() - 1;
+
+  for (int i=0; i<count; i++) {
+    double t = times[i];
+
+    // Times are ascending, so we only ever need to step forward
+    while (index < last && times_[index + 1] <= t) {
+      index++;
+    }
+
+    if (IsExact(index, t)) {
+      out[i] = values_[qMax(0, index)];
+    } else {
+      out[i] = Interpolate(index, t);
+    }
+  }
+}
+
+}
@@ -0,0 +1,118 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef NODEKEYFRAMECURVE_H
+#define NODEKEYFRAMECURVE_H
+
+#include <vector>
+
+#include "node/keyframe.h"
+#include "node/value.h"
+
+namespace olive {
+
+/**
+ * @brief Compact copy of a keyframe track used for evaluation
+ *
+ * NodeKeyframe objects are individually allocated QObjects that store their values as QVariants,
+ * which makes walking them for every evaluation expensive. This keeps the parts needed for
+ * interpolation (times, values, types and absolute bezier control points) in contiguous arrays.
+ *
+ * The curve doesn't track the keyframes itself, NodeInputImmediate marks it out of date whenever
+ * a keyframe in its track is added, removed or modified, and rebuilds it when it's next evaluated.
+ */
+class NodeKeyframeCurve
+{
+public:
+  NodeKeyframeCurve();
+
+  /**
+   * @brief Replace the contents of this curve with the keyframes in a track
+   *
+   * Values and control points are only stored if `type` can be interpolated. Other types only keep
+   * times so that the keyframe applying to a given time can still be found quickly.
+   */
+  void Rebuild(const NodeKeyframeTrack &track, NodeValue::Type type);
+
+  void Clear();
+
+  bool IsEmpty() const { return times_.empty(); }
+
+  int size() const { return int(times_.size()); }
+
+  bool CanInterpolate() const { return can_interpolate_; }
+
+  const std::vector<double> &times() const { return times_; }
+  const std::vector<double> &values() const { return values_; }
+  const std::vector<NodeKeyframe::Type> &types() const { return types_; }
+
+  /**
+   * @brief Returns the index of the last keyframe at or before `time`, or -1 if there is none
+   */
+  int GetIndexAtTime(double time) const;
+
+  /**
+   * @brief Returns whether the value at `time` is exactly the value of keyframe `index`
+   *
+   * This is the case before the first keyframe, after the last, directly on a keyframe, during a
+   * hold, or for types that can't be interpolated. `index` should come from GetIndexAtTime().
+   */
+  bool IsExact(int index, double time) const;
+
+  /**
+   * @brief Interpolates between keyframe `index` and the one after it
+   *
+   * Only valid if IsExact() returned false for this index and time.
+   */
+  double Interpolate(int index, double time) const;
+
+  /**
+   * @brief Evaluates the curve at a single time
+   */
+  double Evaluate(double time) const;
+
+  /**
+   * @brief Evaluates the curve at many times in one pass
+   *
+   * `times` must be in ascending order so the keyframe search only ever walks forward. The curve
+   * must be interpolatable and not empty.
+   */
+  void Evaluate(const double *times, double *out, int count) const;
+
+private:
+  std::vector<double> times_;
+
+  std::vector<double> values_;
+
+  std::vector<NodeKeyframe::Type> types_;
+
+  // Absolute positions of each keyframe's (valid) bezier control points
+  std::vector<double> in_x_;
+  std::vector<double> in_y_;
+  std::vector<double> out_x_;
+  std::vector<double> out_y_;
+
+  bool can_interpolate_;
+
+};
+
+}
+
+#endif // NODEKEYFRAMECURVE_H
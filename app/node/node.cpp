@@ -24,6 +24,7 @@
 #include <QGuiApplication>
 #include <QDebug>
 #include <QFile>
+#include <QSet>
 
 #include "common/lerp.h"
 #include "core.h"
@@ -38,6 +39,42 @@
 
 namespace olive {
 
+namespace {
+
+struct PendingInvalidation
+{
+  QString input;
+  int element;
+  Node::InvalidateCacheOptions options;
+  TimeRangeList ranges;
+};
+
+struct InvalidationBatch
+{
+  int depth = 0;
+  bool flushing = false;
+  QHash<Node*, QVector<PendingInvalidation> > pending;
+};
+
+thread_local InvalidationBatch invalidation_batch;
+
+void SortDownstreamNodes(Node *n, QSet<Node*> &visited, QVector<Node*> &post_order)
+{
+  if (visited.contains(n)) {
+    return;
+  }
+
+  visited.insert(n);
+
+  for (const Node::OutputConnection &conn : n->output_connections()) {
+    SortDownstreamNodes(conn.second.node(), visited, post_order);
+  }
+
+  post_order.append(n);
+}
+
+}
+
 #define super QObject
 
 const QString Node::kEnabledInput = QStringLiteral("enabled_in");
@@ -60,6 +97,9 @@ Node::Node() :
 
 Node::~Node()
 {
+  // Drop any invalidations still waiting to be delivered to us
+  invalidation_batch.pending.remove(this);
+
   // Disconnect all edges
   DisconnectAll();
 
@@ -186,6 +226,9 @@ QBrush Node::brush(qreal top, qreal bottom) const
 
 void Node::ConnectEdge(Node *output, const NodeInput &input)
 {
+  // Pending invalidations were relayed through the graph as it was before this change
+  FlushInvalidationBatch();
+
   // Ensure graph is the same
   Q_ASSERT(input.node()->parent() == output->parent());
 
@@ -212,6 +255,9 @@ void Node::ConnectEdge(Node *output, const NodeInput &input)
 
 void Node::DisconnectEdge(Node *output, const NodeInput &input)
 {
+  // Pending invalidations were relayed through the graph as it was before this change
+  FlushInvalidationBatch();
+
   // Ensure graph is the same
   Q_ASSERT(input.node()->parent() == output->parent());
 
@@ -426,107 +472,23 @@ QVariant Node::GetSplitValueAtTimeOnTrack(const QString &input, const rational &
 {
   if (!IsUsingStandardValue(input, track, element)) {
     const NodeKeyframeTrack& key_track = GetKeyframeTracks(input, element).at(track);
+    const NodeKeyframeCurve& curve = GetKeyframeCurve(input, track, element);
 
-    if (key_track.first()->time() >= time) {
-      // This time precedes any keyframe, so we just return the first value
-      return key_track.first()->value();
-    }
-
-    if (key_track.last()->time() <= time) {
-      // This time is after any keyframes so we return the last value
-      return key_track.last()->value();
-    }
-
-    NodeValue::Type type = GetInputDataType(input);
+    double t = time.toDouble();
+    int index = curve.GetIndexAtTime(t);
 
-    // If we're here, the time must be somewhere in between the keyframes
-    NodeKeyframe *before = nullptr, *after = nullptr;
-
-    int low = 0;
-    int high = key_track.size()-1;
-    while (low <= high) {
-      int mid = low + (high - low) / 2;
-      NodeKeyframe *mid_key = key_track.at(mid);
-      NodeKeyframe *next_key = key_track.at(mid + 1);
-
-      if (mid_key->time() <= time && next_key->time() > time) {
-        before = mid_key;
-        after = next_key;
-        break;
-      } else if (mid_key->time() < time) {
-        low = mid + 1;
-      } else {
-        high = mid - 1;
-      }
+    if (curve.IsExact(index, t)) {
+      // Before the first keyframe, after the last, on a keyframe or in a hold, so value is precise
+      return key_track.at(qMax(0, index))->value();
     }
 
-    if (before) {
-      if (before->time() == time
-          || ((!NodeValue::type_can_be_interpolated(type) || before->type() == NodeKeyframe::kHold) && after->time() > time)) {
-
-        // Time == keyframe time, so value is precise
-        return before->value();
-
-      } else if (after->time() == time) {
-
-        // Time == keyframe time, so value is precise
-        return after->value();
-
-      } else if (before->time() < time && after->time() > time) {
-        // We must interpolate between these keyframes
-
-        double before_val, after_val, interpolated;
-        if (type == NodeValue::kRational) {
-          before_val = before->value().value<rational>().toDouble();
-          after_val = after->value().value<rational>().toDouble();
-        } else {
-          before_val = before->value().toDouble();
-          after_val = after->value().toDouble();
-        }
-
-        if (before->type() == NodeKeyframe::kBezier && after->type() == NodeKeyframe::kBezier) {
-
-          // Perform a cubic bezier with two control points
-          interpolated = Bezier::CubicXtoY(time.toDouble(),
-                                           Imath::V2d(before->time().toDouble(), before_val),
-                                           Imath::V2d(before->time().toDouble() + before->valid_bezier_control_out().x(), before_val + before->valid_bezier_control_out().y()),
-                                           Imath::V2d(after->time().toDouble() + after->valid_bezier_control_in().x(), after_val + after->valid_bezier_control_in().y()),
-                                           Imath::V2d(after->time().toDouble(), after_val));
-
-        } else if (before->type() == NodeKeyframe::kBezier || after->type() == NodeKeyframe::kBezier) {
-          // Perform a quadratic bezier with only one control point
-
-          Imath::V2d control_point;
-
-          if (before->type() == NodeKeyframe::kBezier) {
-            control_point.x = (before->valid_bezier_control_out().x() + before->time().toDouble());
-            control_point.y = (before->valid_bezier_control_out().y() + before_val);
-          } else {
-            control_point.x = (after->valid_bezier_control_in().x() + after->time().toDouble());
-            control_point.y = (after->valid_bezier_control_in().y() + after_val);
-          }
-
-          // Interpolate value using quadratic beziers
-          interpolated = Bezier::QuadraticXtoY(time.toDouble(),
-                                               Imath::V2d(before->time().toDouble(), before_val),
-                                               control_point,
-                                               Imath::V2d(after->time().toDouble(), after_val));
-
-        } else {
-          // To have arrived here, the keyframes must both be linear
-          qreal period_progress = (time.toDouble() - before->time().toDouble()) / (after->time().toDouble() - before->time().toDouble());
-
-          interpolated = lerp(before_val, after_val, period_progress);
-        }
+    // We must interpolate between these keyframes
+    double interpolated = curve.Interpolate(index, t);
 
-        if (type == NodeValue::kRational) {
-          return QVariant::fromValue(rational::fromDouble(interpolated));
-        } else {
-          return interpolated;
-        }
-      }
+    if (GetInputDataType(input) == NodeValue::kRational) {
+      return QVariant::fromValue(rational::fromDouble(interpolated));
     } else {
-      qWarning() << "Binary search for keyframes failed";
+      return interpolated;
     }
   }
 
@@ -598,6 +560,11 @@ const QVector<NodeKeyframeTrack> &Node::GetKeyframeTracks(const QString &input,
   return GetImmediate(input, element)->keyframe_tracks();
 }
 
+const NodeKeyframeCurve &Node::GetKeyframeCurve(const QString &input, int track, int element) const
+{
+  return GetImmediate(input, element)->keyframe_curve(track);
+}
+
 QVector<NodeKeyframe *> Node::GetKeyframesAtTime(const QString &input, const rational &time, int element) const
 {
   NodeInputImmediate* imm = GetImmediate(input, element);
@@ -1125,12 +1092,89 @@ Node *Node::CopyNodeInGraph(Node *node, MultiUndoCommand *command)
 
 void Node::SendInvalidateCache(const TimeRange &range, const InvalidateCacheOptions &options)
 {
+  InvalidationBatch &batch = invalidation_batch;
+
+  // Zero-length ranges can't be unioned, so they're always sent immediately
+  bool defer = (batch.depth > 0 || batch.flushing) && range.in() != range.out();
+
   for (const OutputConnection& conn : output_connections_) {
     // Send clear cache signal to the Node
     const NodeInput& in = conn.second;
 
-    in.node()->InvalidateCache(range, in.input(), in.element(), options);
+    if (defer) {
+      QVector<PendingInvalidation> &list = batch.pending[in.node()];
+
+      auto it = std::find_if(list.begin(), list.end(), [&in, &options](const PendingInvalidation &p){
+        return p.input == in.input() && p.element == in.element() && p.options == options;
+      });
+
+      if (it == list.end()) {
+        list.append({in.input(), in.element(), options, TimeRangeList({range})});
+      } else {
+        it->ranges.insert(range);
+      }
+    } else {
+      in.node()->InvalidateCache(range, in.input(), in.element(), options);
+    }
+  }
+}
+
+void Node::BeginInvalidationBatch()
+{
+  invalidation_batch.depth++;
+}
+
+void Node::EndInvalidationBatch()
+{
+  Q_ASSERT(invalidation_batch.depth > 0);
+
+  invalidation_batch.depth--;
+
+  if (invalidation_batch.depth == 0) {
+    FlushInvalidationBatch();
+  }
+}
+
+void Node::FlushInvalidationBatch()
+{
+  InvalidationBatch &batch = invalidation_batch;
+
+  if (batch.flushing || batch.pending.isEmpty()) {
+    // Anything queued while flushing is picked up by the loop below
+    return;
+  }
+
+  batch.flushing = true;
+
+  while (!batch.pending.isEmpty()) {
+    // Order everything downstream of the pending nodes so that each node has received all of its
+    // invalidations before it relays them any further
+    QSet<Node*> visited;
+    QVector<Node*> post_order;
+    for (auto it=batch.pending.cbegin(); it!=batch.pending.cend(); it++) {
+      SortDownstreamNodes(it.key(), visited, post_order);
+    }
+
+    for (auto it=post_order.crbegin(); it!=post_order.crend(); it++) {
+      Node *n = *it;
+
+      auto pending = batch.pending.find(n);
+      if (pending == batch.pending.end()) {
+        continue;
+      }
+
+      QVector<PendingInvalidation> list = pending.value();
+      batch.pending.erase(pending);
+
+      for (const PendingInvalidation &p : list) {
+        for (const TimeRange &r : p.ranges) {
+          n->InvalidateCache(r, p.input, p.element, p.options);
+        }
+      }
+    }
   }
+
+  batch.flushing = false;
 }
 
 void Node::InvalidateAll(const QString &input, int element)
@@ -2271,6 +2315,8 @@ void Node::childEvent(QChildEvent *event)
 void Node::InvalidateFromKeyframeBezierInChange()
 {
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
+  GetImmediate(key->input(), key->element())->invalidate_keyframe_curve(key->track());
+
   const NodeKeyframeTrack& track = GetTrackFromKeyframe(key);
   int keyframe_index = track.indexOf(key);
 
@@ -2287,6 +2333,8 @@ void Node::InvalidateFromKeyframeBezierInChange()
 void Node::InvalidateFromKeyframeBezierOutChange()
 {
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
+  GetImmediate(key->input(), key->element())->invalidate_keyframe_curve(key->track());
+
   const NodeKeyframeTrack& track = GetTrackFromKeyframe(key);
   int keyframe_index = track.indexOf(key);
 
@@ -2318,6 +2366,8 @@ void Node::InvalidateFromKeyframeTimeChange()
 
     // Invalidate new area that the keyframe has been moved to
     invalidate_range.insert(GetRangeAffectedByKeyframe(key));
+  } else {
+    immediate->invalidate_keyframe_curve(key->track());
   }
 
   // Invalidate entire area surrounding the keyframe (either where it currently is, or where it used to be before it
@@ -2332,6 +2382,8 @@ void Node::InvalidateFromKeyframeTimeChange()
 void Node::InvalidateFromKeyframeValueChange()
 {
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
+  GetImmediate(key->input(), key->element())->invalidate_keyframe_curve(key->track());
+
   ParameterValueChanged(key->key_track_ref().input(), GetRangeAffectedByKeyframe(key));
 
   emit KeyframeValueChanged(key);
@@ -2340,6 +2392,8 @@ void Node::InvalidateFromKeyframeValueChange()
 void Node::InvalidateFromKeyframeTypeChanged()
 {
   NodeKeyframe* key = static_cast<NodeKeyframe*>(sender());
+  GetImmediate(key->input(), key->element())->invalidate_keyframe_curve(key->track());
+
   const NodeKeyframeTrack& track = GetTrackFromKeyframe(key);
 
   if (track.size() == 1) {
@@ -509,6 +509,17 @@ public:
     return GetKeyframeTracks(input.input(), input.element());
   }
 
+  /**
+   * @brief Get the compact evaluation copy of a keyframe track
+   *
+   * Useful for evaluating a curve at many times at once (see NodeKeyframeCurve::Evaluate).
+   */
+  const NodeKeyframeCurve& GetKeyframeCurve(const QString& input, int track, int element = -1) const;
+  const NodeKeyframeCurve& GetKeyframeCurve(const NodeKeyframeTrackReference& ref) const
+  {
+    return GetKeyframeCurve(ref.input().input(), ref.track(), ref.input().element());
+  }
+
   QVector<NodeKeyframe*> GetKeyframesAtTime(const QString& input, const rational& time, int element = -1) const;
   QVector<NodeKeyframe*> GetKeyframesAtTime(const NodeInput& input, const rational& time) const
   {
@@ -855,6 +866,23 @@ public:
     InvalidateCache(range, from.input(), from.element(), options);
   }
 
+  /**
+   * @brief Start coalescing cache invalidations sent between nodes
+   *
+   * While a batch is open, invalidations that nodes relay to their outputs are collected rather
+   * than sent immediately. Ranges sent to the same input are unioned, and when the outermost batch
+   * ends, they're delivered once per node in topological order. This stops graphs with fan-out
+   * and re-convergence from invalidating (and requeuing renders for) the same node many times for
+   * a single edit.
+   *
+   * Batches nest, and any pending invalidations are delivered before edges are connected or
+   * disconnected so that they're never relayed through a graph that no longer matches them. Every
+   * call must be paired with EndInvalidationBatch().
+   */
+  static void BeginInvalidationBatch();
+
+  static void EndInvalidationBatch();
+
   /**
    * @brief Adjusts time that should be sent to nodes connected to certain inputs.
    *
@@ -1017,6 +1045,11 @@ protected:
 
   void SendInvalidateCache(const TimeRange &range, const InvalidateCacheOptions &options);
 
+  /**
+   * @brief Deliver any invalidations collected by the current batch
+   */
+  static void FlushInvalidationBatch();
+
   enum GizmoScaleHandles {
     kGizmoScaleTopLeft,
     kGizmoScaleTopCenter,
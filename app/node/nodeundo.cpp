@@ -418,6 +418,17 @@ Project *NodeParamSetKeyframeValueCommand::GetRelevantProject() const
   return key_->parent()->project();
 }
 
+bool NodeParamSetKeyframeValueCommand::can_merge_with(const UndoCommand *command) const
+{
+  const NodeParamSetKeyframeValueCommand *other = dynamic_cast<const NodeParamSetKeyframeValueCommand*>(command);
+  return other && other->key_ == key_;
+}
+
+void NodeParamSetKeyframeValueCommand::merge_with(const UndoCommand *command)
+{
+  new_value_ = static_cast<const NodeParamSetKeyframeValueCommand*>(command)->new_value_;
+}
+
 void NodeParamSetKeyframeValueCommand::redo()
 {
   key_->set_value(new_value_);
@@ -521,6 +532,18 @@ Project *NodeParamSetStandardValueCommand::GetRelevantProject() const
   return ref_.input().node()->project();
 }
 
+bool NodeParamSetStandardValueCommand::can_merge_with(const UndoCommand *command) const
+{
+  const NodeParamSetStandardValueCommand *other = dynamic_cast<const NodeParamSetStandardValueCommand*>(command);
+  return other && other->ref_ == ref_;
+}
+
+void NodeParamSetStandardValueCommand::merge_with(const UndoCommand *command)
+{
+  // Keep our old value so undoing restores the value from before the first edit
+  new_value_ = static_cast<const NodeParamSetStandardValueCommand*>(command)->new_value_;
+}
+
 void NodeParamSetStandardValueCommand::redo()
 {
   ref_.input().node()->SetSplitStandardValueOnTrack(ref_, new_value_);
@@ -237,6 +237,11 @@ public:
 
   virtual Project* GetRelevantProject() const override;
 
+  virtual size_t memory_cost() const override
+  {
+    return kBaseMemoryCost + GetRetainedMemoryCost(&memory_manager_);
+  }
+
 protected:
   virtual void redo() override
   {
@@ -334,6 +339,11 @@ public:
 
   virtual Project* GetRelevantProject() const override;
 
+  virtual size_t memory_cost() const override
+  {
+    return kBaseMemoryCost + GetRetainedMemoryCost(&memory_manager_);
+  }
+
 protected:
   virtual void redo() override;
   virtual void undo() override;
@@ -364,6 +374,15 @@ public:
     return graph_;
   }
 
+  virtual size_t memory_cost() const override
+  {
+    size_t cost = kBaseMemoryCost + GetRetainedMemoryCost(&memory_manager_);
+    if (command_) {
+      cost += command_->memory_cost();
+    }
+    return cost;
+  }
+
 protected:
   virtual void prepare() override;
 
@@ -415,6 +434,11 @@ public:
     }
   }
 
+  virtual size_t memory_cost() const override
+  {
+    return command_ ? command_->memory_cost() : kBaseMemoryCost;
+  }
+
 protected:
   virtual void prepare() override
   {
@@ -610,6 +634,11 @@ public:
 
   virtual Project * GetRelevantProject() const override;
 
+  virtual size_t memory_cost() const override
+  {
+    return kBaseMemoryCost + GetRetainedMemoryCost(&memory_manager_);
+  }
+
 protected:
   virtual void redo() override;
 
@@ -658,6 +687,11 @@ public:
 
   virtual Project* GetRelevantProject() const override;
 
+  virtual size_t memory_cost() const override
+  {
+    return kBaseMemoryCost + GetRetainedMemoryCost(&memory_manager_);
+  }
+
 protected:
   virtual void redo() override;
   virtual void undo() override;
@@ -678,6 +712,11 @@ public:
 
   virtual Project* GetRelevantProject() const override;
 
+  virtual size_t memory_cost() const override
+  {
+    return kBaseMemoryCost + GetRetainedMemoryCost(&memory_manager_);
+  }
+
 protected:
   virtual void redo() override;
   virtual void undo() override;
@@ -719,6 +758,10 @@ public:
 
   virtual Project* GetRelevantProject() const override;
 
+  virtual bool can_merge_with(const UndoCommand *command) const override;
+
+  virtual void merge_with(const UndoCommand *command) override;
+
 protected:
   virtual void redo() override;
   virtual void undo() override;
@@ -739,6 +782,10 @@ public:
 
   virtual Project* GetRelevantProject() const override;
 
+  virtual bool can_merge_with(const UndoCommand *command) const override;
+
+  virtual void merge_with(const UndoCommand *command) override;
+
 protected:
   virtual void redo() override;
   virtual void undo() override;
@@ -769,6 +816,18 @@ public:
     return ref_.node()->project();
   }
 
+  virtual bool can_merge_with(const UndoCommand *command) const override
+  {
+    const NodeParamSetSplitStandardValueCommand *other = dynamic_cast<const NodeParamSetSplitStandardValueCommand*>(command);
+    return other && other->ref_ == ref_;
+  }
+
+  virtual void merge_with(const UndoCommand *command) override
+  {
+    // Keep our old value so undoing restores the value from before the first edit
+    new_value_ = static_cast<const NodeParamSetSplitStandardValueCommand*>(command)->new_value_;
+  }
+
 protected:
   virtual void redo() override
   {
@@ -848,6 +907,11 @@ public:
 
   virtual Project* GetRelevantProject() const override { return nullptr; }
 
+  virtual size_t memory_cost() const override
+  {
+    return kBaseMemoryCost + GetRetainedMemoryCost(&memory_manager_);
+  }
+
 protected:
   virtual void prepare() override;
 
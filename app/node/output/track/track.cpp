@@ -269,54 +269,88 @@ Block *Track::BlockContainingTime(const rational &time) const
 
 Block *Track::NearestBlockBefore(const rational &time) const
 {
-  foreach (Block* block, blocks_) {
-    // Blocks are sorted by time, so the first Block who's out point is at/after this time is the correct Block
-    if (block->in() == time) {
-      break;
-    }
+  // Blocks are sorted by time, so the first Block who's out point is at/after this time is the correct Block
+  int index = GetFirstBlockIndexEndingAfter(time, true);
+  if (index == blocks_.size()) {
+    return nullptr;
+  }
 
-    if (block->out() >= time) {
-      return block;
-    }
+  Block *block = blocks_.at(index);
+  if (block->in() == time) {
+    return nullptr;
   }
 
-  return nullptr;
+  return block;
 }
 
 Block *Track::NearestBlockBeforeOrAt(const rational &time) const
 {
-  foreach (Block* block, blocks_) {
-    // Blocks are sorted by time, so the first Block who's out point is at/after this time is the correct Block
-    if (block->out() > time) {
-      return block;
-    }
-  }
-
-  return nullptr;
+  // Blocks are sorted by time, so the first Block who's out point is at/after this time is the correct Block
+  int index = GetFirstBlockIndexEndingAfter(time, false);
+  return (index == blocks_.size()) ? nullptr : blocks_.at(index);
 }
 
 Block *Track::NearestBlockAfterOrAt(const rational &time) const
 {
-  foreach (Block* block, blocks_) {
-    // Blocks are sorted by time, so the first Block after this time is the correct Block
-    if (block->in() >= time) {
-      return block;
+  // Blocks are sorted by time, so the first Block after this time is the correct Block
+  int index = GetFirstBlockIndexStartingAfter(time, true);
+  return (index == blocks_.size()) ? nullptr : blocks_.at(index);
+}
+
+Block *Track::NearestBlockAfter(const rational &time) const
+{
+  // Blocks are sorted by time, so the first Block after this time is the correct Block
+  int index = GetFirstBlockIndexStartingAfter(time, false);
+  return (index == blocks_.size()) ? nullptr : blocks_.at(index);
+}
+
+QVector<Block *> Track::BlocksInRange(const TimeRange &range) const
+{
+  QVector<Block*> list;
+
+  for (int i=GetFirstBlockIndexEndingAfter(range.in(), false); i<blocks_.size(); i++) {
+    Block *b = blocks_.at(i);
+    if (b->in() >= range.out()) {
+      break;
     }
+    list.append(b);
   }
 
-  return nullptr;
+  return list;
 }
 
-Block *Track::NearestBlockAfter(const rational &time) const
+int Track::GetFirstBlockIndexEndingAfter(const rational &time, bool inclusive) const
 {
-  foreach (Block* block, blocks_) {
-    // Blocks are sorted by time, so the first Block after this time is the correct Block
-    if (block->in() > time) {
-      return block;
+  // Blocks are contiguous and sorted, so their out points are too and can be binary searched
+  auto it = inclusive
+      ? std::lower_bound(blocks_.cbegin(), blocks_.cend(), time, [](const Block *b, const rational &t){ return b->out() < t; })
+      : std::upper_bound(blocks_.cbegin(), blocks_.cend(), time, [](const rational &t, const Block *b){ return t < b->out(); });
+  return it - blocks_.cbegin();
+}
+
+int Track::GetFirstBlockIndexStartingAfter(const rational &time, bool inclusive) const
+{
+  auto it = inclusive
+      ? std::lower_bound(blocks_.cbegin(), blocks_.cend(), time, [](const Block *b, const rational &t){ return b->in() < t; })
+      : std::upper_bound(blocks_.cbegin(), blocks_.cend(), time, [](const rational &t, const Block *b){ return t < b->in(); });
+  return it - blocks_.cbegin();
+}
+
+int Track::GetIndexOfBlock(Block *block) const
+{
+  // Find the first block starting at this block's in point, then step over any zero length
+  // blocks that share it
+  for (int i=GetFirstBlockIndexStartingAfter(block->in(), true); i<blocks_.size(); i++) {
+    Block *b = blocks_.at(i);
+    if (b == block) {
+      return i;
+    } else if (b->in() != block->in()) {
+      break;
     }
   }
 
-  return nullptr;
+  // In/outs might not be up to date (e.g. while rebuilding from the array map)
+  return blocks_.indexOf(block);
 }
 
 bool Track::IsRangeFree(const TimeRange &range) const
@@ -380,7 +414,7 @@ void Track::InsertBlockBefore(Block* block, Block* after)
   if (!after) {
     AppendBlock(block);
   } else {
-    InsertBlockAtIndex(block, blocks_.indexOf(after));
+    InsertBlockAtIndex(block, GetIndexOfBlock(after));
   }
 }
 
@@ -389,7 +423,7 @@ void Track::InsertBlockAfter(Block *block, Block *before)
   if (!before) {
     PrependBlock(block);
   } else {
-    int before_index = blocks_.indexOf(before);
+    int before_index = GetIndexOfBlock(before);
 
     Q_ASSERT(before_index >= 0);
 
@@ -448,7 +482,7 @@ void Track::RippleRemoveBlock(Block *block)
   block->set_track(nullptr);
 
   // Update array
-  int index = blocks_.indexOf(block);
+  int index = GetIndexOfBlock(block);
   Q_ASSERT(index != -1);
 
   int array_index = block_array_indexes_.at(index);
@@ -489,7 +523,7 @@ void Track::ReplaceBlock(Block *old, Block *replace)
   replace->set_track(this);
 
   // Update array
-  int cache_index = blocks_.indexOf(old);
+  int cache_index = GetIndexOfBlock(old);
   int index_of_old_block = GetArrayIndexFromCacheIndex(cache_index);
 
   DisconnectEdge(old, NodeInput(this, kBlockInput, index_of_old_block));
@@ -587,7 +621,7 @@ void Track::UpdateInOutFrom(int index)
 
 int Track::GetArrayIndexFromBlock(Block *block) const
 {
-  return block_array_indexes_.at(blocks_.indexOf(block));
+  return block_array_indexes_.at(GetIndexOfBlock(block));
 }
 
 int Track::GetArrayIndexFromCacheIndex(int index) const
@@ -606,20 +640,10 @@ int Track::GetBlockIndexAtTime(const rational &time) const
     return -1;
   }
 
-  // Use binary search to find block at time
-  int low = 0;
-  int high = blocks_.size() - 1;
-  while (low <= high) {
-    int mid = low + (high - low) / 2;
-
-    Block* block = blocks_.at(mid);
-    if (block->in() <= time && block->out() > time) {
-      return mid;
-    } else if (block->out() <= time) {
-      low = mid + 1;
-    } else {
-      high = mid - 1;
-    }
+  // The block at this time is the first one that ends after it
+  int index = GetFirstBlockIndexEndingAfter(time, false);
+  if (index < blocks_.size() && blocks_.at(index)->in() <= time) {
+    return index;
   }
 
   return -1;
@@ -797,7 +821,7 @@ void Track::BlockLengthChanged()
   // Assumes sender is a Block
   Block* b = static_cast<Block*>(sender());
 
-  UpdateInOutFrom(blocks_.indexOf(b));
+  UpdateInOutFrom(GetIndexOfBlock(b));
 }
 
 uint qHash(const Track::Reference &r, uint seed)
@@ -320,6 +320,21 @@ public:
    */
   Block* NearestBlockAfter(const rational& time) const;
 
+  /**
+   * @brief Returns all blocks that overlap a time range
+   *
+   * Blocks that only touch the range at its in or out point are not included.
+   */
+  QVector<Block*> BlocksInRange(const TimeRange &range) const;
+
+  /**
+   * @brief Returns the index of the first block whose out point is after (or, if `inclusive`, at)
+   * a given time
+   *
+   * @return The index, or the number of blocks if no block ends after this time.
+   */
+  int GetFirstBlockIndexEndingAfter(const rational &time, bool inclusive = false) const;
+
   /*
    * @brief Returns whether a time range is empty or only has a gap
    */
@@ -460,6 +475,10 @@ private:
 
   int GetBlockIndexAtTime(const rational &time) const;
 
+  int GetFirstBlockIndexStartingAfter(const rational &time, bool inclusive) const;
+
+  int GetIndexOfBlock(Block *block) const;
+
   void ProcessAudioTrack(const NodeValueRow &value, const NodeGlobals &globals, NodeValueTable *table) const;
 
   int ConnectBlock(Block *b);
@@ -335,6 +335,7 @@ void ViewerOutput::InputConnectedEvent(const QString &input, int element, Node *
     emit TextureInputChanged();
   } else if (input == kSamplesInput) {
     connect(output->waveform_cache(), &AudioWaveformCache::Validated, this, &ViewerOutput::ConnectedWaveformChanged);
+    connect(output->waveform_cache(), &AudioWaveformCache::TilesLoaded, this, &ViewerOutput::ConnectedWaveformChanged);
   }
 
   super::InputConnectedEvent(input, element, output);
@@ -346,6 +347,7 @@ void ViewerOutput::InputDisconnectedEvent(const QString &input, int element, Nod
     emit TextureInputChanged();
   } else if (input == kSamplesInput) {
     disconnect(output->waveform_cache(), &AudioWaveformCache::Validated, this, &ViewerOutput::ConnectedWaveformChanged);
+    disconnect(output->waveform_cache(), &AudioWaveformCache::TilesLoaded, this, &ViewerOutput::ConnectedWaveformChanged);
   }
 
   super::InputDisconnectedEvent(input, element, output);
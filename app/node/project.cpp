@@ -91,6 +91,13 @@ SerializedData Project::Load(QXmlStreamReader *reader)
 {
   SerializedData data;
 
+  Load(reader, &data);
+
+  return data;
+}
+
+void Project::Load(QXmlStreamReader *reader, SerializedData *data)
+{
   while (XMLReadNextStartElement(reader)) {
     if (reader->name() == QStringLiteral("uuid")) {
 
@@ -100,33 +107,8 @@ SerializedData Project::Load(QXmlStreamReader *reader)
 
       while (XMLReadNextStartElement(reader)) {
         if (reader->name() == QStringLiteral("node")) {
-          QString id;
-
-          {
-            XMLAttributeLoop(reader, attr) {
-              if (attr.name() == QStringLiteral("id")) {
-                id = attr.value().toString();
-              }
-            }
-          }
-
-          if (id.isEmpty()) {
-            qWarning() << "Failed to load node with empty ID";
-            reader->skipCurrentElement();
-          } else {
-            Node* node = NodeFactory::CreateFromID(id);
-
-            if (!node) {
-              qWarning() << "Failed to find node with ID" << id;
-              reader->skipCurrentElement();
-            } else {
-              // Disable cache while node is being loaded (we'll re-enable it later)
-              node->SetCachesEnabled(false);
-
-              node->Load(reader, &data);
-
-              node->setParent(this);
-            }
+          if (Node *node = LoadNode(reader, data)) {
+            node->setParent(this);
           }
         } else {
           reader->skipCurrentElement();
@@ -151,23 +133,55 @@ SerializedData Project::Load(QXmlStreamReader *reader)
   QString root = GetSetting(kRootKey);
   if (!root.isEmpty()) {
     quintptr r = root.toULongLong();
-    if (Node *n = data.node_ptrs.value(r)) {
+    if (Node *n = data->node_ptrs.value(r)) {
       Q_ASSERT(!root_);
       root_ = dynamic_cast<Folder*>(n);
       SetSetting(kRootKey, QString::number(reinterpret_cast<quintptr>(root_)));
     }
   }
+}
 
-  return data;
+Node *Project::LoadNode(QXmlStreamReader *reader, SerializedData *data)
+{
+  QString id;
+
+  {
+    XMLAttributeLoop(reader, attr) {
+      if (attr.name() == QStringLiteral("id")) {
+        id = attr.value().toString();
+      }
+    }
+  }
+
+  if (id.isEmpty()) {
+    qWarning() << "Failed to load node with empty ID";
+    reader->skipCurrentElement();
+    return nullptr;
+  }
+
+  Node* node = NodeFactory::CreateFromID(id);
+
+  if (!node) {
+    qWarning() << "Failed to find node with ID" << id;
+    reader->skipCurrentElement();
+    return nullptr;
+  }
+
+  // Disable cache while node is being loaded (we'll re-enable it later)
+  node->SetCachesEnabled(false);
+
+  node->Load(reader, data);
+
+  return node;
 }
 
-void Project::Save(QXmlStreamWriter *writer) const
+void Project::Save(QXmlStreamWriter *writer, bool include_nodes) const
 {
   writer->writeAttribute(QStringLiteral("version"), QString::number(1));
 
   writer->writeTextElement(QStringLiteral("uuid"), this->GetUuid().toString());
 
-  if (!this->nodes().isEmpty()) {
+  if (include_nodes && !this->nodes().isEmpty()) {
     writer->writeStartElement(QStringLiteral("nodes"));
 
     foreach (Node* node, this->nodes()) {
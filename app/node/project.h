@@ -73,7 +73,24 @@ public:
   void Initialize();
 
   SerializedData Load(QXmlStreamReader *reader);
-  void Save(QXmlStreamWriter *writer) const;
+  void Save(QXmlStreamWriter *writer, bool include_nodes = true) const;
+
+  /**
+   * @brief Load project data into `data`, which may already contain nodes loaded elsewhere
+   *
+   * Used by the chunked project format, where nodes are loaded separately (and in parallel) from
+   * the project's own settings. Nodes already in `data` must be parented to this project first so
+   * the root folder can be resolved.
+   */
+  void Load(QXmlStreamReader *reader, SerializedData *data);
+
+  /**
+   * @brief Create and load a single node from a `node` element
+   *
+   * Returns nullptr (having skipped the element) if the node couldn't be created. Does not
+   * parent the node to any project, so this is safe to call from any thread.
+   */
+  static Node *LoadNode(QXmlStreamReader *reader, SerializedData *data);
 
   int GetNumberOfContextsNodeIsIn(Node *node, bool except_itself = false) const;
 
@@ -94,7 +94,7 @@ bool Folder::HasChildRecursive(Node *child) const
 
 int Folder::index_of_child_in_array(Node *item) const
 {
-  int index_of_item = item_children_.indexOf(item);
+  int index_of_item = index_of_child(item);
 
   if (index_of_item == -1) {
     return -1;
@@ -111,6 +111,7 @@ void Folder::InputConnectedEvent(const QString &input, int element, Node *output
     // The insert index is always our "count" because we only support appending in our internal
     // model. For sorting/organizing, a QSortFilterProxyModel is used instead.
     emit BeginInsertItem(item, item_child_count());
+    item_child_index_.insert(item, item_children_.size());
     item_children_.append(item);
     item_element_index_.append(element);
     item->SetFolder(this);
@@ -123,10 +124,14 @@ void Folder::InputDisconnectedEvent(const QString &input, int element, Node *out
   if (input == kChildInput && element != -1) {
     Node* item = output;
 
-    int child_index = item_children_.indexOf(item);
+    int child_index = index_of_child(item);
     emit BeginRemoveItem(item, child_index);
     item_children_.removeAt(child_index);
     item_element_index_.removeAt(child_index);
+    item_child_index_.remove(item);
+    for (int i=child_index; i<item_children_.size(); i++) {
+      item_child_index_.insert(item_children_.at(i), i);
+    }
     item->SetFolder(nullptr);
     emit EndRemoveItem();
   }
@@ -88,7 +88,7 @@ public:
 
   int index_of_child(Node* item) const
   {
-    return item_children_.indexOf(item);
+    return item_child_index_.value(item, -1);
   }
 
   int index_of_child_in_array(Node* item) const;
@@ -199,6 +199,9 @@ private:
   QVector<Node*> item_children_;
   QVector<int> item_element_index_;
 
+  // Reverse lookup of item_children_ so views can resolve an item's row without a linear search
+  QHash<Node*, int> item_child_index_;
+
 };
 
 class FolderAddChild : public UndoCommand
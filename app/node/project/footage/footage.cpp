@@ -23,6 +23,8 @@
 #include <QApplication>
 #include <QDir>
 #include <QStandardPaths>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
 
 #include "codec/decoder.h"
 #include "common/filefunctions.h"
@@ -30,15 +32,40 @@
 #include "common/xmlutils.h"
 #include "config/config.h"
 #include "core.h"
+#include "render/diskmanager.h"
 #include "render/job/footagejob.h"
 #include "ui/icons/icons.h"
 
 namespace olive {
 
 const QString Footage::kFilenameInput = QStringLiteral("file_in");
+const QString Footage::kProxyFilenameInput = QStringLiteral("proxy_file_in");
+const QString Footage::kProxyDividerInput = QStringLiteral("proxy_divider_in");
 
 #define super ViewerOutput
 
+namespace {
+
+// Probing is mostly waiting on storage (often network storage), so allow more probes in flight
+// than there are cores
+const int kMaxConcurrentProbes = 16;
+
+thread_local int deferred_probe_depth = 0;
+
+QThreadPool *GetProbeThreadPool()
+{
+  static QThreadPool pool;
+  static bool initialized = [](){
+    pool.setMaxThreadCount(qMax(kMaxConcurrentProbes, QThread::idealThreadCount()));
+    return true;
+  }();
+  Q_UNUSED(initialized)
+
+  return &pool;
+}
+
+}
+
 Footage::Footage(const QString &filename) :
   ViewerOutput(false, false),
   timestamp_(0),
@@ -50,6 +77,9 @@ Footage::Footage(const QString &filename) :
 
   PrependInput(kFilenameInput, NodeValue::kFile, InputFlags(kInputFlagNotConnectable | kInputFlagNotKeyframable));
 
+  AddInput(kProxyFilenameInput, NodeValue::kFile, InputFlags(kInputFlagNotConnectable | kInputFlagNotKeyframable | kInputFlagArray | kInputFlagHidden));
+  AddInput(kProxyDividerInput, NodeValue::kInt, InputFlags(kInputFlagNotConnectable | kInputFlagNotKeyframable | kInputFlagArray | kInputFlagHidden));
+
   Clear();
 
   if (!filename.isEmpty()) {
@@ -62,6 +92,7 @@ Footage::Footage(const QString &filename) :
   check_timer->start();
 
   connect(this->waveform_cache(), &AudioWaveformCache::Validated, this, &ViewerOutput::ConnectedWaveformChanged);
+  connect(this->waveform_cache(), &AudioWaveformCache::TilesLoaded, this, &ViewerOutput::ConnectedWaveformChanged);
 }
 
 void Footage::Retranslate()
@@ -69,6 +100,8 @@ void Footage::Retranslate()
   super::Retranslate();
 
   SetInputName(kFilenameInput, tr("Filename"));
+  SetInputName(kProxyFilenameInput, tr("Proxy Filename"));
+  SetInputName(kProxyDividerInput, tr("Proxy Divider"));
 }
 
 void Footage::InputValueChangedEvent(const QString &input, int element)
@@ -77,8 +110,19 @@ void Footage::InputValueChangedEvent(const QString &input, int element)
     // Reset internal stream cache
     Clear();
 
-    Reprobe();
+    if (deferred_probe_depth > 0) {
+      // Probe in the background, FinishDeferredProbes() will apply the result
+      set_timestamp(0);
+      pending_probe_ = QtConcurrent::run(GetProbeThreadPool(), &Footage::Probe, filename(), cancelled_);
+    } else {
+      Reprobe();
+    }
   } else {
+    if (input == kProxyFilenameInput) {
+      QMutexLocker locker(&proxy_exists_lock_);
+      proxy_exists_.clear();
+    }
+
     super::InputValueChangedEvent(input, element);
   }
 }
@@ -264,6 +308,18 @@ void Footage::Value(const NodeValueRow &value, const NodeGlobals &globals, NodeV
           vp.set_divider(1);
         }
 
+        // Decode from a proxy if there's one with at least as much detail as this divider needs
+        if (vp.divider() > 1
+            && vp.video_type() == VideoParams::kVideoTypeVideo
+            && ref.index() < InputArraySize(kProxyFilenameInput)) {
+          QString proxy = GetStandardValue(kProxyFilenameInput, ref.index()).toString();
+          int proxy_divider = GetStandardValue(kProxyDividerInput, ref.index()).toInt();
+
+          if (!proxy.isEmpty() && proxy_divider > 1 && proxy_divider <= vp.divider() && ProxyExists(proxy)) {
+            job.set_proxy(proxy, proxy_divider);
+          }
+        }
+
         job.set_video_params(vp);
 
         table->Push(NodeValue::kTexture, Texture::Job(vp, job), this, ref.ToString());
@@ -475,82 +531,157 @@ void Footage::RemovedFromGraphEvent(Project *p)
   disconnect(p->color_manager(), &ColorManager::DefaultInputChanged, this, &Footage::DefaultColorSpaceChanged);
 }
 
-void Footage::Reprobe()
+void Footage::BeginDeferredProbing()
 {
-  // Determine if file still exists
-  QString filename = this->filename();
+  deferred_probe_depth++;
+}
+
+void Footage::EndDeferredProbing()
+{
+  deferred_probe_depth--;
+}
+
+void Footage::FinishDeferredProbes(const QVector<Node *> &nodes)
+{
+  for (Node *n : nodes) {
+    if (Footage *f = dynamic_cast<Footage*>(n)) {
+      f->FinishProbe();
+    }
+  }
+}
+
+Footage::ProbeResult Footage::Probe(const QString &filename, CancelAtom *cancelled)
+{
+  ProbeResult result;
 
   // In case of failure to load file, set timestamp to a value that will always be invalid so we
   // continuously reprobe
-  set_timestamp(0);
+  result.timestamp = 0;
 
   if (!filename.isEmpty()) {
     QFileInfo info(filename);
 
     if (info.exists()) {
       // Grab timestamp
-      set_timestamp(info.lastModified().toMSecsSinceEpoch());
+      result.timestamp = info.lastModified().toMSecsSinceEpoch();
 
       // Determine if we've already cached the metadata of this file
       QString meta_cache_file = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath(FileFunctions::GetUniqueFileIdentifier(filename));
 
-      FootageDescription footage_info;
-
       // Try to load footage info from cache
-      if (!QFileInfo::exists(meta_cache_file) || !footage_info.Load(meta_cache_file)) {
+      if (!QFileInfo::exists(meta_cache_file) || !result.description.Load(meta_cache_file)) {
 
         // Probe and create cache
         QVector<DecoderPtr> decoder_list = Decoder::ReceiveListOfAllDecoders();
 
         foreach (DecoderPtr decoder, decoder_list) {
-          footage_info = decoder->Probe(filename, cancelled_);
+          result.description = decoder->Probe(filename, cancelled);
 
-          if (footage_info.IsValid()) {
+          if (result.description.IsValid()) {
             break;
           }
         }
 
-        if (!cancelled_ || !cancelled_->HeardCancel()) {
-          if (!footage_info.Save(meta_cache_file)) {
+        if (!cancelled || !cancelled->HeardCancel()) {
+          if (!result.description.Save(meta_cache_file)) {
             qWarning() << "Failed to save stream cache, footage will have to be re-probed";
           }
         }
 
       }
+    }
+  }
 
-      if (footage_info.IsValid()) {
-        decoder_ = footage_info.decoder();
+  return result;
+}
 
-        InputArrayResize(kVideoParamsInput, footage_info.GetVideoStreams().size());
-        for (int i=0; i<footage_info.GetVideoStreams().size(); i++) {
-          VideoParams video_stream = footage_info.GetVideoStreams().at(i);
+void Footage::Reprobe()
+{
+  // Any background probe is now out of date, but let it finish writing the metadata cache before
+  // probing the same file again
+  pending_probe_.waitForFinished();
+  pending_probe_ = QFuture<ProbeResult>();
 
-          if (i < InputArraySize(kVideoParamsInput)) {
-            VideoParams existing = this->GetVideoParams(i);
-            if (existing.is_valid()) {
-              video_stream = MergeVideoStream(video_stream, existing);
-            }
-          }
+  ApplyProbe(Probe(this->filename(), cancelled_), false);
+}
 
-          SetStream(Track::kVideo, QVariant::fromValue(video_stream), i);
-        }
+void Footage::FinishProbe()
+{
+  if (pending_probe_.isStarted() && !pending_probe_.isCanceled()) {
+    ProbeResult result = pending_probe_.result();
+    pending_probe_ = QFuture<ProbeResult>();
+
+    // A timestamp loaded from the project after the probe started takes precedence, exactly as if
+    // the probe had run synchronously, so files modified while the project was closed are still
+    // detected by CheckFootage()
+    if (timestamp() != 0) {
+      result.timestamp = timestamp();
+    }
+
+    // Stream params loaded from the project since the probe started are the user's, so they win
+    // exactly as if the probe had run before they were loaded
+    ApplyProbe(result, true);
+  }
+}
+
+void Footage::ApplyProbe(const ProbeResult &result, bool prefer_existing)
+{
+  set_timestamp(result.timestamp);
+
+  const FootageDescription &footage_info = result.description;
+
+  if (footage_info.IsValid()) {
+    decoder_ = footage_info.decoder();
 
-        InputArrayResize(kAudioParamsInput, footage_info.GetAudioStreams().size());
-        for (int i=0; i<footage_info.GetAudioStreams().size(); i++) {
-          SetStream(Track::kAudio, QVariant::fromValue(footage_info.GetAudioStreams().at(i)), i);
+    InputArrayResize(kVideoParamsInput, footage_info.GetVideoStreams().size());
+    for (int i=0; i<footage_info.GetVideoStreams().size(); i++) {
+      VideoParams video_stream = footage_info.GetVideoStreams().at(i);
+
+      if (i < InputArraySize(kVideoParamsInput)) {
+        VideoParams existing = this->GetVideoParams(i);
+        if (existing.is_valid()) {
+          video_stream = prefer_existing ? existing : MergeVideoStream(video_stream, existing);
         }
+      }
 
-        InputArrayResize(kSubtitleParamsInput, footage_info.GetSubtitleStreams().size());
-        for (int i=0; i<footage_info.GetSubtitleStreams().size(); i++) {
-          SetStream(Track::kSubtitle, QVariant::fromValue(footage_info.GetSubtitleStreams().at(i)), i);
+      SetStream(Track::kVideo, QVariant::fromValue(video_stream), i);
+    }
+
+    InputArrayResize(kAudioParamsInput, footage_info.GetAudioStreams().size());
+    for (int i=0; i<footage_info.GetAudioStreams().size(); i++) {
+      AudioParams audio_stream = footage_info.GetAudioStreams().at(i);
+
+      AudioParams existing = this->GetAudioParams(i);
+      if (existing.is_valid()) {
+        if (prefer_existing) {
+          audio_stream = existing;
+        } else {
+          audio_stream.set_enabled(existing.enabled());
         }
+      }
+
+      SetStream(Track::kAudio, QVariant::fromValue(audio_stream), i);
+    }
 
-        total_stream_count_ = footage_info.GetStreamCount();
+    InputArrayResize(kSubtitleParamsInput, footage_info.GetSubtitleStreams().size());
+    for (int i=0; i<footage_info.GetSubtitleStreams().size(); i++) {
+      SubtitleParams subtitle_stream = footage_info.GetSubtitleStreams().at(i);
 
-        SetValid();
+      SubtitleParams existing = this->GetSubtitleParams(i);
+      if (existing.is_valid()) {
+        if (prefer_existing) {
+          subtitle_stream = existing;
+        } else {
+          subtitle_stream.set_enabled(existing.enabled());
+        }
       }
 
+      SetStream(Track::kSubtitle, QVariant::fromValue(subtitle_stream), i);
     }
+
+    total_stream_count_ = footage_info.GetStreamCount();
+
+    SetValid();
   }
 }
 
@@ -558,6 +689,7 @@ VideoParams Footage::MergeVideoStream(const VideoParams &base, const VideoParams
 {
   VideoParams merged = base;
 
+  merged.set_enabled(over.enabled());
   merged.set_pixel_aspect_ratio(over.pixel_aspect_ratio());
   merged.set_interlacing(over.interlacing());
   merged.set_colorspace(over.colorspace());
@@ -576,6 +708,12 @@ VideoParams Footage::MergeVideoStream(const VideoParams &base, const VideoParams
 
 void Footage::CheckFootage()
 {
+  // Proxies can be removed by the disk cache, check them again on the next render
+  {
+    QMutexLocker locker(&proxy_exists_lock_);
+    proxy_exists_.clear();
+  }
+
   // Don't check files if not the active window
   if (qApp->activeWindow()) {
     QString fn = filename();
@@ -599,6 +737,23 @@ void Footage::CheckFootage()
   }
 }
 
+bool Footage::ProxyExists(const QString &filename) const
+{
+  QMutexLocker locker(&proxy_exists_lock_);
+
+  auto it = proxy_exists_.constFind(filename);
+  if (it == proxy_exists_.cend()) {
+    it = proxy_exists_.insert(filename, QFileInfo::exists(filename));
+
+    // Keep proxies that are still in use from being the first thing the disk cache removes
+    if (it.value() && project()) {
+      QMetaObject::invokeMethod(DiskManager::instance(), "Accessed", Q_ARG(QString, project()->cache_path()), Q_ARG(QString, filename));
+    }
+  }
+
+  return it.value();
+}
+
 void Footage::DefaultColorSpaceChanged()
 {
   bool inv = false;
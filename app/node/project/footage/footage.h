@@ -22,8 +22,10 @@
 #define FOOTAGE_H
 
 #include <olive/core/core.h>
+#include <QFuture>
 #include <QList>
 #include <QDateTime>
+#include <QMutex>
 
 #include "codec/decoder.h"
 #include "footagedescription.h"
@@ -175,10 +177,31 @@ public:
   virtual void SaveCustom(QXmlStreamWriter *writer) const override;
 
   static const QString kFilenameInput;
+  static const QString kProxyFilenameInput;
+  static const QString kProxyDividerInput;
 
   virtual void AddedToGraphEvent(Project *p)  override;
   virtual void RemovedFromGraphEvent(Project *p) override;
 
+  /**
+   * @brief Probe footage in the background while nodes are being loaded on this thread
+   *
+   * Between BeginDeferredProbing() and EndDeferredProbing(), setting a Footage's filename starts
+   * its probe on a shared I/O thread pool instead of blocking, so files are stat'd, hashed and
+   * probed concurrently while the rest of the graph is still being constructed. The results are
+   * applied by FinishDeferredProbes().
+   */
+  static void BeginDeferredProbing();
+  static void EndDeferredProbing();
+
+  /**
+   * @brief Wait for and apply any background probes of Footage in `nodes`
+   *
+   * Results are applied in the order of `nodes` on the calling thread so loading is deterministic
+   * regardless of which probe finishes first.
+   */
+  static void FinishDeferredProbes(const QVector<Node*> &nodes);
+
 protected:
   virtual void InputValueChangedEvent(const QString &input, int element) override;
 
@@ -187,8 +210,34 @@ protected:
 private:
   QString GetColorspaceToUse(const VideoParams& params) const;
 
+  struct ProbeResult
+  {
+    qint64 timestamp;
+    FootageDescription description;
+  };
+
+  static ProbeResult Probe(const QString &filename, CancelAtom *cancelled);
+
   void Reprobe();
 
+  /**
+   * @brief Set streams from a probe result
+   *
+   * Streams that already have valid params keep the user's settings. With `prefer_existing`, those
+   * params are kept whole (they were just loaded from the project), otherwise only the
+   * user-editable fields are merged over the probe.
+   */
+  void ApplyProbe(const ProbeResult &result, bool prefer_existing);
+
+  void FinishProbe();
+
+  /**
+   * @brief Check whether a proxy file exists without touching the filesystem on every render
+   *
+   * Results are kept until the proxy inputs change or the next CheckFootage().
+   */
+  bool ProxyExists(const QString &filename) const;
+
   VideoParams MergeVideoStream(const VideoParams &base, const VideoParams &over);
 
   /**
@@ -205,8 +254,13 @@ private:
 
   CancelAtom *cancelled_;
 
+  QFuture<ProbeResult> pending_probe_;
+
   int total_stream_count_;
 
+  mutable QMutex proxy_exists_lock_;
+  mutable QHash<QString, bool> proxy_exists_;
+
 private slots:
   void CheckFootage();
 
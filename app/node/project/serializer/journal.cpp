@@ -0,0 +1,484 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "journal.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
+#include <QUuid>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include "common/xmlutils.h"
+#include "node/group/group.h"
+#include "node/output/viewer/viewer.h"
+
+namespace olive {
+
+const int ProjectJournal::kMaxEntriesBeforeCompaction = 64;
+
+ProjectJournal::ProjectJournal(Project *project, QObject *parent) :
+  QObject(parent),
+  project_(project),
+  entries_since_snapshot_(0),
+  snapshot_size_(0),
+  journal_size_(0),
+  pending_write_is_snapshot_(false)
+{
+  connect(project, &Project::NodeAdded, this, &ProjectJournal::NodeAdded);
+  connect(project, &Project::NodeRemoved, this, &ProjectJournal::NodeRemoved);
+  connect(project, &Project::ValueChanged, this, [this](const NodeInput &input){
+    MarkDirty(input.node());
+  });
+  connect(project, &Project::InputConnected, this, [this](Node *, const NodeInput &input){
+    MarkDirty(input.node());
+  });
+  connect(project, &Project::InputDisconnected, this, [this](Node *, const NodeInput &input){
+    MarkDirty(input.node());
+  });
+  connect(project, &Project::GroupAddedInputPassthrough, this, [this](NodeGroup *group){
+    MarkDirty(group);
+  });
+  connect(project, &Project::GroupRemovedInputPassthrough, this, [this](NodeGroup *group){
+    MarkDirty(group);
+  });
+  connect(project, &Project::GroupChangedOutputPassthrough, this, [this](NodeGroup *group){
+    MarkDirty(group);
+  });
+
+  for (Node *n : project->nodes()) {
+    ConnectNode(n);
+  }
+}
+
+ProjectJournal::~ProjectJournal()
+{
+  WaitForFinished();
+}
+
+QString ProjectJournal::Save(const QString &directory, const QString &name, const MainWindowLayoutInfo &layout)
+{
+  // Writes must land in order, so wait for the last one before starting another
+  WaitForFinished();
+
+  if (!project_) {
+    return QString();
+  }
+
+  bool append = !snapshot_filename_.isEmpty()
+      && entries_since_snapshot_ < kMaxEntriesBeforeCompaction
+      && journal_size_ < snapshot_size_ / 2;
+
+  QDir dir(directory);
+  QString filename = append ? snapshot_filename_ : dir.filePath(QStringLiteral("%1.snapshot").arg(name));
+
+  ProjectSerializer::SaveData data(ProjectSerializer::kProject, project_, filename);
+  data.SetLayout(layout);
+
+  if (append) {
+    QVector<Node*> changed;
+    changed.reserve(dirty_nodes_.size());
+    for (Node *n : dirty_nodes_) {
+      changed.append(n);
+    }
+
+    QVector<quintptr> removed;
+    removed.reserve(removed_nodes_.size());
+    for (quintptr ptr : removed_nodes_) {
+      removed.append(ptr);
+    }
+
+    data.SetIncremental(true);
+    data.SetOnlySerializeNodes(changed);
+    data.SetRemovedNodes(removed);
+  } else {
+    snapshot_token_ = QUuid::createUuid().toString();
+  }
+
+  QVector<ProjectSerializer::Chunk> chunks = ProjectSerializer::SerializeChunks(data);
+
+  dirty_nodes_.clear();
+  removed_nodes_.clear();
+
+  // Tag the project chunk so journal entries can be matched to their snapshot
+  for (ProjectSerializer::Chunk &c : chunks) {
+    if (c.type == ProjectSerializer::kChunkProject) {
+      c.name = snapshot_token_;
+    }
+  }
+
+  pending_write_is_snapshot_ = !append;
+
+  if (append) {
+    entries_since_snapshot_++;
+  } else {
+    snapshot_filename_ = filename;
+    entries_since_snapshot_ = 0;
+    journal_size_ = 0;
+  }
+
+  // Each save gets its own recovery point referring to the snapshot and how much of its journal
+  // to replay
+  QFileInfo snapshot_info(snapshot_filename_);
+  QString point_filename = dir.filePath(QStringLiteral("%1.%2.ove").arg(name, snapshot_info.completeBaseName()));
+
+  ProjectSerializer::Chunk point;
+  point.type = ProjectSerializer::kChunkRecoveryPoint;
+  point.name = snapshot_info.fileName();
+  point.data = QByteArray::number(entries_since_snapshot_);
+
+  if (append) {
+    QString journal_filename = GetJournalFilename(snapshot_filename_);
+
+    pending_write_ = QtConcurrent::run([journal_filename, chunks, point_filename, point]{
+      QByteArray entry;
+      QBuffer buf(&entry);
+      buf.open(QBuffer::WriteOnly);
+      if (!ProjectSerializer::SaveChunked(&buf, chunks)) {
+        return qint64(0);
+      }
+      buf.close();
+
+      QFile f(journal_filename);
+      if (!f.open(QFile::Append)) {
+        return qint64(0);
+      }
+
+      QDataStream stream(&f);
+      stream.setVersion(QDataStream::Qt_5_0);
+      stream << entry;
+
+      f.close();
+
+      ProjectSerializer::WriteChunks(point_filename, {point});
+
+      return qint64(entry.size());
+    });
+  } else {
+    pending_write_ = QtConcurrent::run([filename, chunks, point_filename, point]{
+      if (ProjectSerializer::WriteChunks(filename, chunks).code() != ProjectSerializer::kSuccess) {
+        return qint64(0);
+      }
+
+      // Remove any journal left over from a previous snapshot with this name
+      QFile::remove(GetJournalFilename(filename));
+
+      ProjectSerializer::WriteChunks(point_filename, {point});
+
+      return QFileInfo(filename).size();
+    });
+  }
+
+  return point_filename;
+}
+
+void ProjectJournal::WaitForFinished()
+{
+  if (pending_write_.isStarted() && !pending_write_.isCanceled()) {
+    qint64 sz = pending_write_.result();
+
+    if (pending_write_is_snapshot_) {
+      snapshot_size_ = sz;
+    } else {
+      journal_size_ += sz;
+    }
+
+    pending_write_ = QFuture<qint64>();
+  }
+}
+
+QString ProjectJournal::GetJournalFilename(const QString &snapshot_filename)
+{
+  return snapshot_filename + QStringLiteral(".journal");
+}
+
+QString ProjectJournal::GetRecoveryPointSnapshot(const QString &point_filename)
+{
+  // Recovery points are named "<name>.<snapshot>.ove"
+  QFileInfo info(point_filename);
+  QStringList parts = info.fileName().split('.');
+  if (parts.size() != 3 || parts.at(2).compare(QStringLiteral("ove"), Qt::CaseInsensitive) != 0) {
+    return QString();
+  }
+
+  return info.dir().filePath(QStringLiteral("%1.snapshot").arg(parts.at(1)));
+}
+
+bool ProjectJournal::ReadRecoveryPoint(const QString &point_filename, const ProjectSerializer::Chunk &point, uint *version, QVector<ProjectSerializer::Chunk> *chunks)
+{
+  QString snapshot_filename = QFileInfo(point_filename).dir().filePath(point.name);
+
+  QFile f(snapshot_filename);
+  if (!f.open(QFile::ReadOnly)) {
+    return false;
+  }
+
+  bool ok = ProjectSerializer::CheckChunkedID(&f) && ProjectSerializer::ReadChunks(&f, version, chunks);
+
+  f.close();
+
+  if (ok) {
+    Replay(GetJournalFilename(snapshot_filename), chunks, point.data.toInt());
+  }
+
+  return ok;
+}
+
+void SplitNodeChunk(const QByteArray &data, QVector<quintptr> *order, QHash<quintptr, QByteArray> *nodes)
+{
+  QXmlStreamReader reader(data);
+
+  while (XMLReadNextStartElement(&reader)) {
+    if (reader.name() != QStringLiteral("nodes") && reader.name() != QStringLiteral("removed")) {
+      reader.skipCurrentElement();
+      continue;
+    }
+
+    while (XMLReadNextStartElement(&reader)) {
+      if (reader.name() != QStringLiteral("node")) {
+        reader.skipCurrentElement();
+        continue;
+      }
+
+      quintptr ptr = 0;
+      XMLAttributeLoop((&reader), attr) {
+        if (attr.name() == QStringLiteral("ptr")) {
+          ptr = attr.value().toULongLong();
+        }
+      }
+
+      // Copy the node element verbatim
+      QByteArray xml;
+      QXmlStreamWriter writer(&xml);
+      writer.writeCurrentToken(reader);
+
+      int depth = 1;
+      while (depth > 0 && !reader.atEnd()) {
+        reader.readNext();
+
+        if (reader.isStartElement()) {
+          depth++;
+        } else if (reader.isEndElement()) {
+          depth--;
+        }
+
+        writer.writeCurrentToken(reader);
+      }
+
+      if (ptr) {
+        order->append(ptr);
+        nodes->insert(ptr, xml);
+      }
+    }
+  }
+}
+
+QByteArray JoinNodeChunk(const QVector<quintptr> &order, const QHash<quintptr, QByteArray> &nodes)
+{
+  QByteArray b = QByteArrayLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?><nodes>");
+
+  for (quintptr ptr : order) {
+    auto it = nodes.constFind(ptr);
+    if (it != nodes.cend()) {
+      b.append(it.value());
+    }
+  }
+
+  b.append(QByteArrayLiteral("</nodes>"));
+
+  return b;
+}
+
+void ProjectJournal::Replay(const QString &journal_filename, QVector<ProjectSerializer::Chunk> *chunks, int max_entries)
+{
+  QFile f(journal_filename);
+  if (!f.open(QFile::ReadOnly)) {
+    return;
+  }
+
+  // Index every node in the snapshot by pointer
+  QString token;
+  int project_chunk = -1;
+  QVector<QVector<quintptr> > chunk_order(chunks->size());
+  QHash<quintptr, QByteArray> nodes;
+  QSet<quintptr> placed;
+
+  for (int i=0; i<chunks->size(); i++) {
+    const ProjectSerializer::Chunk &c = chunks->at(i);
+    if (c.type == ProjectSerializer::kChunkProject) {
+      project_chunk = i;
+      token = c.name;
+    } else if (c.type == ProjectSerializer::kChunkNodes) {
+      SplitNodeChunk(c.data, &chunk_order[i], &nodes);
+      for (quintptr ptr : chunk_order.at(i)) {
+        placed.insert(ptr);
+      }
+    }
+  }
+
+  if (token.isEmpty()) {
+    // Snapshot wasn't written by a journal
+    return;
+  }
+
+  QVector<quintptr> added;
+
+  QDataStream stream(&f);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  int replayed = 0;
+
+  while (replayed < max_entries && !stream.atEnd()) {
+    QByteArray entry;
+    stream >> entry;
+
+    // If Olive quit while an entry was being written, it'll be incomplete
+    if (stream.status() != QDataStream::Ok) {
+      break;
+    }
+
+    QBuffer buf(&entry);
+    buf.open(QBuffer::ReadOnly);
+
+    uint version;
+    QVector<ProjectSerializer::Chunk> entry_chunks;
+    if (!ProjectSerializer::CheckChunkedID(&buf) || !ProjectSerializer::ReadChunks(&buf, &version, &entry_chunks)) {
+      break;
+    }
+
+    bool matches_snapshot = false;
+    for (const ProjectSerializer::Chunk &c : entry_chunks) {
+      if (c.type == ProjectSerializer::kChunkProject && c.name == token) {
+        matches_snapshot = true;
+        break;
+      }
+    }
+
+    if (!matches_snapshot) {
+      continue;
+    }
+
+    replayed++;
+
+    for (const ProjectSerializer::Chunk &c : entry_chunks) {
+      switch (c.type) {
+      case ProjectSerializer::kChunkProject:
+        (*chunks)[project_chunk].data = c.data;
+        break;
+      case ProjectSerializer::kChunkNodes:
+      {
+        QVector<quintptr> changed;
+        SplitNodeChunk(c.data, &changed, &nodes);
+        for (quintptr ptr : changed) {
+          if (!placed.contains(ptr)) {
+            placed.insert(ptr);
+            added.append(ptr);
+          }
+        }
+        break;
+      }
+      case ProjectSerializer::kChunkRemovedNodes:
+      {
+        QVector<quintptr> removed;
+        QHash<quintptr, QByteArray> unused;
+        SplitNodeChunk(c.data, &removed, &unused);
+        for (quintptr ptr : removed) {
+          nodes.remove(ptr);
+        }
+        break;
+      }
+      }
+    }
+  }
+
+  // Rebuild node chunks with the replayed nodes
+  for (int i=0; i<chunks->size(); i++) {
+    if (chunks->at(i).type == ProjectSerializer::kChunkNodes) {
+      (*chunks)[i].data = JoinNodeChunk(chunk_order.at(i), nodes);
+    }
+  }
+
+  if (!added.isEmpty()) {
+    ProjectSerializer::Chunk c;
+    c.type = ProjectSerializer::kChunkNodes;
+    c.data = JoinNodeChunk(added, nodes);
+    chunks->append(c);
+  }
+}
+
+void ProjectJournal::ConnectNode(Node *node)
+{
+  auto mark = [this, node]{ MarkDirty(node); };
+
+  connect(node, &Node::LabelChanged, this, mark);
+  connect(node, &Node::ColorChanged, this, mark);
+  connect(node, &Node::LinksChanged, this, mark);
+  connect(node, &Node::InputArraySizeChanged, this, mark);
+  connect(node, &Node::InputValueHintChanged, this, mark);
+  connect(node, &Node::KeyframeAdded, this, mark);
+  connect(node, &Node::KeyframeRemoved, this, mark);
+  connect(node, &Node::KeyframeTimeChanged, this, mark);
+  connect(node, &Node::KeyframeTypeChanged, this, mark);
+  connect(node, &Node::KeyframeValueChanged, this, mark);
+  connect(node, &Node::KeyframeEnableChanged, this, mark);
+  connect(node, &Node::NodeAddedToContext, this, mark);
+  connect(node, &Node::NodePositionInContextChanged, this, mark);
+  connect(node, &Node::NodeRemovedFromContext, this, mark);
+
+  if (ViewerOutput *viewer = dynamic_cast<ViewerOutput*>(node)) {
+    TimelineMarkerList *markers = viewer->GetMarkers();
+    connect(markers, &TimelineMarkerList::MarkerAdded, this, mark);
+    connect(markers, &TimelineMarkerList::MarkerRemoved, this, mark);
+    connect(markers, &TimelineMarkerList::MarkerModified, this, mark);
+  }
+}
+
+void ProjectJournal::MarkDirty(Node *node)
+{
+  if (node && node->parent() == project_) {
+    dirty_nodes_.insert(node);
+  }
+}
+
+void ProjectJournal::NodeAdded(Node *node)
+{
+  ConnectNode(node);
+
+  removed_nodes_.remove(reinterpret_cast<quintptr>(node));
+  dirty_nodes_.insert(node);
+}
+
+void ProjectJournal::NodeRemoved(Node *node)
+{
+  // Reconnected in NodeAdded if the node is added back (e.g. by undo)
+  disconnect(node, nullptr, this, nullptr);
+  if (ViewerOutput *viewer = dynamic_cast<ViewerOutput*>(node)) {
+    disconnect(viewer->GetMarkers(), nullptr, this, nullptr);
+  }
+
+  dirty_nodes_.remove(node);
+  removed_nodes_.insert(reinterpret_cast<quintptr>(node));
+}
+
+}
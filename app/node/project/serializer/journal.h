@@ -0,0 +1,144 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef PROJECTJOURNAL_H
+#define PROJECTJOURNAL_H
+
+#include <QFuture>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+
+#include "serializer.h"
+
+namespace olive {
+
+/**
+ * @brief Saves a project as a full snapshot followed by a journal of what changed since
+ *
+ * The journal tracks which nodes were added, changed or removed as edits are made to the project
+ * (i.e. as the undo stack's commands run). Each save after the first appends only those nodes to
+ * a journal file next to the snapshot, so the cost of a save is proportional to the edit rather
+ * than to the project. After enough entries, the journal is compacted by writing a new snapshot.
+ *
+ * Every save also writes a small recovery point ("<name>.<snapshot>.ove") that refers to the
+ * snapshot and the number of journal entries to replay, so each save can still be restored on its
+ * own. Snapshots themselves ("<name>.snapshot") aren't listed as recoveries.
+ *
+ * Serializing happens on the calling thread since it reads the node graph, but compression and
+ * file I/O happen in the background.
+ *
+ * Node pointers are used to match journal entries to the snapshot, so a journal is only valid for
+ * a snapshot taken in the same session. Each snapshot is tagged with a random token that its
+ * journal entries repeat, and entries that don't match are ignored when replaying.
+ */
+class ProjectJournal : public QObject
+{
+  Q_OBJECT
+public:
+  ProjectJournal(Project *project, QObject *parent = nullptr);
+
+  virtual ~ProjectJournal() override;
+
+  DISABLE_COPY_MOVE(ProjectJournal)
+
+  Project *project() const { return project_; }
+
+  /**
+   * @brief Save changes made to the project since the last save
+   *
+   * If a snapshot has been written and the journal hasn't grown too large, changes are appended
+   * to the existing snapshot's journal. Otherwise a new full snapshot named `name` is written into
+   * `directory`.
+   *
+   * @return The recovery point for this save
+   */
+  QString Save(const QString &directory, const QString &name, const MainWindowLayoutInfo &layout);
+
+  /**
+   * @brief Block until any background writes are complete
+   */
+  void WaitForFinished();
+
+  /**
+   * @brief The snapshot the current journal entries are appended to, or empty if there isn't one
+   */
+  const QString &GetSnapshotFilename() const { return snapshot_filename_; }
+
+  static QString GetJournalFilename(const QString &snapshot_filename);
+
+  /**
+   * @brief Get the snapshot a recovery point written by Save() refers to
+   *
+   * Returns an empty string if `point_filename` isn't a recovery point.
+   */
+  static QString GetRecoveryPointSnapshot(const QString &point_filename);
+
+  /**
+   * @brief Read the chunks of the project a recovery point refers to
+   *
+   * `point` is the recovery point chunk read from `point_filename`.
+   */
+  static bool ReadRecoveryPoint(const QString &point_filename, const ProjectSerializer::Chunk &point, uint *version, QVector<ProjectSerializer::Chunk> *chunks);
+
+  /**
+   * @brief Apply up to `max_entries` journal entries for a snapshot to its decompressed chunks
+   */
+  static void Replay(const QString &journal_filename, QVector<ProjectSerializer::Chunk> *chunks, int max_entries);
+
+private:
+  void ConnectNode(Node *node);
+
+  void MarkDirty(Node *node);
+
+  void NodeAdded(Node *node);
+
+  void NodeRemoved(Node *node);
+
+  /**
+   * @brief Maximum number of entries appended before the journal is compacted into a snapshot
+   */
+  static const int kMaxEntriesBeforeCompaction;
+
+  QPointer<Project> project_;
+
+  QString snapshot_filename_;
+
+  QString snapshot_token_;
+
+  QSet<Node*> dirty_nodes_;
+
+  QSet<quintptr> removed_nodes_;
+
+  int entries_since_snapshot_;
+
+  qint64 snapshot_size_;
+
+  qint64 journal_size_;
+
+  QFuture<qint64> pending_write_;
+
+  bool pending_write_is_snapshot_;
+
+};
+
+}
+
+#endif // PROJECTJOURNAL_H
@@ -21,22 +21,29 @@
 #include "serializer.h"
 
 #include <QApplication>
+#include <QDataStream>
 #include <QFile>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrent>
 #include <QXmlStreamReader>
 
 #include "common/xmlutils.h"
 #include "core.h"
+#include "journal.h"
 #include "node/group/group.h"
+#include "node/project/footage/footage.h"
 #include "serializer190219.h"
 #include "serializer210528.h"
 #include "serializer210907.h"
 #include "serializer211228.h"
 #include "serializer220403.h"
 #include "serializer230220.h"
+#include "serializer261018.h"
 
 namespace olive {
 
 QVector<ProjectSerializer*> ProjectSerializer::instances_;
+const uint ProjectSerializer::kChunkedFormatVersion = 1;
 
 void ProjectSerializer::Initialize()
 {
@@ -50,6 +57,7 @@ void ProjectSerializer::Initialize()
   instances_.append(new ProjectSerializer211228);
   instances_.append(new ProjectSerializer220403);
   instances_.append(new ProjectSerializer230220);
+  instances_.append(new ProjectSerializer261018);
 }
 
 void ProjectSerializer::Destroy()
@@ -63,6 +71,15 @@ ProjectSerializer::Result ProjectSerializer::Load(Project *project, const QStrin
   QFile project_file(filename);
 
   if (project_file.open(QFile::ReadOnly)) {
+    // Chunked project files are marked with "OVCK" and don't contain one XML document to parse
+    if (CheckChunkedID(&project_file)) {
+      Result r = LoadChunked(project, &project_file, load_type);
+      project_file.close();
+      return r;
+    }
+
+    project_file.seek(0);
+
     // Some project files are compressed, marked with "OVEC" at the beginning of the file. Check for
     // that signature now.
     std::unique_ptr<QXmlStreamReader> reader;
@@ -150,6 +167,15 @@ ProjectSerializer::Result ProjectSerializer::Paste(LoadType load_type, Project *
 
 ProjectSerializer::Result ProjectSerializer::Save(const SaveData &data, bool compress)
 {
+  // Compressed projects are split into independently compressed chunks if the serializer
+  // supports it, otherwise they're stored as one compressed XML document
+  if (compress) {
+    QVector<Chunk> chunks = SerializeChunks(data);
+    if (!chunks.isEmpty()) {
+      return WriteChunks(data.GetFilename(), chunks);
+    }
+  }
+
   QString temp_save = FileFunctions::GetSafeTemporaryFilename(data.GetFilename());
 
   QFile project_file(temp_save);
@@ -193,6 +219,47 @@ ProjectSerializer::Result ProjectSerializer::Save(const SaveData &data, bool com
   }
 }
 
+QVector<ProjectSerializer::Chunk> ProjectSerializer::SerializeChunks(const SaveData &data)
+{
+  return instances_.last()->SaveChunks(data);
+}
+
+ProjectSerializer::Result ProjectSerializer::WriteChunks(const QString &filename, const QVector<Chunk> &chunks)
+{
+  QString temp_save = FileFunctions::GetSafeTemporaryFilename(filename);
+
+  QFile project_file(temp_save);
+
+  if (project_file.open(QFile::WriteOnly)) {
+    // Builds that can't read chunked files parse this line as XML and report the project as too new
+    project_file.write(QStringLiteral("<?xml version=\"1.0\" encoding=\"UTF-8\"?><olive version=\"%1\"><project/></olive>\n")
+                       .arg(QString::number(instances_.last()->Version())).toUtf8());
+
+    bool ok = SaveChunked(&project_file, chunks);
+
+    project_file.close();
+
+    if (!ok) {
+      Result r(kFileError);
+      r.SetDetails(temp_save);
+      return r;
+    }
+
+    // Save was successful, we can now rewrite the original file
+    if (FileFunctions::RenameFileAllowOverwrite(temp_save, filename)) {
+      return kSuccess;
+    } else {
+      Result r(kOverwriteError);
+      r.SetDetails(temp_save);
+      return r;
+    }
+  } else {
+    Result r(kFileError);
+    r.SetDetails(temp_save);
+    return r;
+  }
+}
+
 ProjectSerializer::Result ProjectSerializer::Save(QXmlStreamWriter *writer, const SaveData &data)
 {
   writer->setAutoFormatting(true);
@@ -201,9 +268,9 @@ ProjectSerializer::Result ProjectSerializer::Save(QXmlStreamWriter *writer, cons
 
   writer->writeStartElement("olive");
 
-  // By default, save as last serializer which, assuming the instances are ordered correctly,
-  // will be the newest file format. But we may allow saving as older versions later on.
-  ProjectSerializer *serializer = instances_.last();
+  // By default, save as the newest XML format. Versions that only changed the chunked container
+  // don't apply to a plain XML document, and stamping them would lock out builds that could read it.
+  ProjectSerializer *serializer = GetNewestXmlSerializer();
 
   // Version is stored in YYMMDD from whenever the project format was last changed
   // Allows easy integer math for checking project versions.
@@ -240,51 +307,314 @@ ProjectSerializer::Result ProjectSerializer::Copy(const SaveData &data)
   return res;
 }
 
-bool ProjectSerializer::CheckCompressedID(QFile *file)
+bool ProjectSerializer::CheckCompressedID(QIODevice *file)
 {
   QByteArray b = file->read(4);
   return !memcmp(b.data(), "OVEC", 4);
 }
 
+bool ProjectSerializer::CheckChunkedID(QIODevice *file)
+{
+  // Skip the XML stub written by WriteChunks()
+  if (file->peek(1) == QByteArrayLiteral("<")) {
+    file->readLine();
+  }
+
+  QByteArray b = file->read(4);
+  return b.size() == 4 && !memcmp(b.data(), "OVCK", 4);
+}
+
+void CopyNodeChunkToXml(const QByteArray &data, QXmlStreamWriter *writer)
+{
+  QXmlStreamReader reader(data);
+  int depth = 0;
+
+  // Copy everything inside the chunk's root "nodes" element
+  while (!reader.atEnd()) {
+    reader.readNext();
+
+    if (reader.isStartElement()) {
+      depth++;
+      if (depth > 1) {
+        writer->writeCurrentToken(reader);
+      }
+    } else if (reader.isEndElement()) {
+      if (depth > 1) {
+        writer->writeCurrentToken(reader);
+      }
+      depth--;
+    } else if (depth > 1) {
+      writer->writeCurrentToken(reader);
+    }
+  }
+}
+
+QByteArray ProjectSerializer::ConvertChunkedToXml(QFile *file)
+{
+  uint version;
+  QVector<Chunk> chunks;
+
+  if (!ReadChunkedFile(file, &version, &chunks)) {
+    return QByteArray();
+  }
+
+  QByteArray out;
+  QXmlStreamWriter writer(&out);
+  writer.setAutoFormatting(true);
+
+  for (const Chunk &c : chunks) {
+    if (c.type != kChunkProject) {
+      continue;
+    }
+
+    // The project chunk is the regular XML document minus its nodes, so copy it and splice the
+    // nodes from every node chunk back in just before the project element closes
+    QXmlStreamReader reader(c.data);
+    int depth = 0;
+
+    while (!reader.atEnd()) {
+      reader.readNext();
+
+      if (reader.isStartElement()) {
+        depth++;
+      } else if (reader.isEndElement()) {
+        if (depth == 3 && reader.name() == QStringLiteral("project")) {
+          writer.writeStartElement(QStringLiteral("nodes"));
+
+          for (const Chunk &n : chunks) {
+            if (n.type == kChunkNodes) {
+              CopyNodeChunkToXml(n.data, &writer);
+            }
+          }
+
+          writer.writeEndElement(); // nodes
+        }
+
+        depth--;
+      }
+
+      writer.writeCurrentToken(reader);
+    }
+
+    if (reader.hasError()) {
+      return QByteArray();
+    }
+  }
+
+  return out;
+}
+
 bool ProjectSerializer::IsCancelled() const
 {
   return false;
 }
 
 ProjectSerializer::Result ProjectSerializer::LoadWithSerializerVersion(uint version, Project *project, QXmlStreamReader *reader, LoadType load_type)
+{
+  // We should now have the version, if we have a serializer for it, use it to load the project
+  ResultCode error;
+  ProjectSerializer *serializer = GetSerializerForVersion(version, &error);
+
+  if (serializer) {
+    // Probe footage concurrently while the rest of the graph is constructed
+    Footage::BeginDeferredProbing();
+    LoadData ld = serializer->Load(project, reader, load_type, nullptr);
+    Footage::EndDeferredProbing();
+
+    // Serializers that don't finish probes themselves are handled here
+    if (project) {
+      Footage::FinishDeferredProbes(project->nodes());
+    }
+    Footage::FinishDeferredProbes(ld.nodes);
+
+    Result r(kSuccess);
+    if (reader->hasError()) {
+      r = Result(kXmlError);
+      r.SetDetails(QCoreApplication::translate("Serializer", "%1 on line %2").arg(reader->errorString(), QString::number(reader->lineNumber())));
+    }
+    r.SetLoadData(ld);
+    return r;
+  } else {
+    return error;
+  }
+}
+
+ProjectSerializer *ProjectSerializer::GetSerializerForVersion(uint version, ResultCode *error)
 {
   // Failed to find version in file
   if (version == 0) {
-    return kUnknownVersion;
+    *error = kUnknownVersion;
+    return nullptr;
   }
 
-  // We should now have the version, if we have a serializer for it, use it to load the project
-  ProjectSerializer *serializer = nullptr;
-
   foreach (ProjectSerializer *s, instances_) {
     if (version == s->Version()) {
-      serializer = s;
-      break;
+      return s;
     } else if (version < s->Version()) {
       // Assuming the instance list is in order, if the project version is less than any version
       // we find, we must not support it anymore
-      return kProjectTooOld;
+      *error = kProjectTooOld;
+      return nullptr;
     }
   }
 
-  if (serializer) {
-    LoadData ld = serializer->Load(project, reader, load_type, nullptr);
-    Result r(kSuccess);
-    if (reader->hasError()) {
-      r = Result(kXmlError);
-      r.SetDetails(QCoreApplication::translate("Serializer", "%1 on line %2").arg(reader->errorString(), QString::number(reader->lineNumber())));
+  // Reached the end of the list with no serializer, assume too new
+  *error = kProjectTooNew;
+  return nullptr;
+}
+
+ProjectSerializer *ProjectSerializer::GetNewestXmlSerializer()
+{
+  // Assuming the instance list is in order, the first one from the end that changed the XML is the newest
+  for (auto it=instances_.crbegin(); it!=instances_.crend(); it++) {
+    if (!(*it)->IsChunkedOnly()) {
+      return *it;
     }
-    r.SetLoadData(ld);
-    return r;
+  }
+
+  return instances_.first();
+}
+
+bool ProjectSerializer::ReadChunks(QIODevice *device, uint *version, QVector<Chunk> *chunks)
+{
+  QDataStream stream(device);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  quint32 format_version, serializer_version, count;
+  stream >> format_version >> serializer_version >> count;
+
+  // Every chunk takes up at least a few bytes, so a count larger than the device means it's corrupt
+  if (stream.status() != QDataStream::Ok
+      || format_version > kChunkedFormatVersion
+      || qint64(count) > device->size()) {
+    return false;
+  }
+
+  *version = serializer_version;
+
+  // Read table of contents, offsets are relative to the end of the table
+  QVector<quint64> offsets(count);
+  QVector<quint64> sizes(count);
+  chunks->resize(count);
+
+  for (quint32 i=0; i<count; i++) {
+    quint32 type;
+    stream >> type >> (*chunks)[i].name >> offsets[i] >> sizes[i];
+    (*chunks)[i].type = static_cast<ChunkType>(type);
+  }
+
+  if (stream.status() != QDataStream::Ok) {
+    return false;
+  }
+
+  qint64 data_start = device->pos();
+
+  for (quint32 i=0; i<count; i++) {
+    if (!device->seek(data_start + qint64(offsets.at(i)))) {
+      return false;
+    }
+
+    (*chunks)[i].data = device->read(qint64(sizes.at(i)));
+
+    if (quint64((*chunks)[i].data.size()) != sizes.at(i)) {
+      return false;
+    }
+  }
+
+  // Decompress every chunk in parallel
+  QVector<QFuture<QByteArray> > futures(count);
+  for (quint32 i=0; i<count; i++) {
+    QByteArray compressed = chunks->at(i).data;
+    futures[i] = QtConcurrent::run([compressed]{
+      return qUncompress(compressed);
+    });
+  }
+
+  bool ok = true;
+  for (quint32 i=0; i<count; i++) {
+    (*chunks)[i].data = futures[i].result();
+    if ((*chunks)[i].data.isEmpty()) {
+      ok = false;
+    }
+  }
+
+  return ok;
+}
+
+bool ProjectSerializer::ReadChunkedFile(QFile *file, uint *version, QVector<Chunk> *chunks)
+{
+  if (!ReadChunks(file, version, chunks)) {
+    return false;
+  }
+
+  // Auto-recovery points refer to a snapshot and how many of its journal entries to apply
+  if (chunks->size() == 1 && chunks->first().type == kChunkRecoveryPoint) {
+    Chunk point = chunks->first();
+    chunks->clear();
+
+    return ProjectJournal::ReadRecoveryPoint(file->fileName(), point, version, chunks);
+  }
+
+  return true;
+}
+
+ProjectSerializer::Result ProjectSerializer::LoadChunked(Project *project, QFile *file, LoadType load_type)
+{
+  uint version;
+  QVector<Chunk> chunks;
+
+  if (!ReadChunkedFile(file, &version, &chunks)) {
+    return kFileError;
+  }
+
+  ResultCode error;
+  ProjectSerializer *serializer = GetSerializerForVersion(version, &error);
+
+  if (serializer) {
+    return serializer->LoadChunks(project, chunks, load_type);
   } else {
-    // Reached the end of the list with no serializer, assume too new
-    return kProjectTooNew;
+    return error;
+  }
+}
+
+bool ProjectSerializer::SaveChunked(QIODevice *device, const QVector<Chunk> &chunks)
+{
+  // Compress every chunk in parallel
+  QVector<QFuture<QByteArray> > futures(chunks.size());
+  for (int i=0; i<chunks.size(); i++) {
+    QByteArray uncompressed = chunks.at(i).data;
+    futures[i] = QtConcurrent::run([uncompressed]{
+      return qCompress(uncompressed);
+    });
+  }
+
+  QVector<QByteArray> compressed(chunks.size());
+  for (int i=0; i<chunks.size(); i++) {
+    compressed[i] = futures[i].result();
+  }
+
+  device->write("OVCK");
+
+  QDataStream stream(device);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  stream << quint32(kChunkedFormatVersion) << quint32(instances_.last()->Version()) << quint32(chunks.size());
+
+  // Write table of contents, offsets are relative to the end of the table
+  quint64 offset = 0;
+  for (int i=0; i<chunks.size(); i++) {
+    quint64 size = compressed.at(i).size();
+    stream << quint32(chunks.at(i).type) << chunks.at(i).name << offset << size;
+    offset += size;
   }
+
+  for (const QByteArray &b : compressed) {
+    if (device->write(b) != b.size()) {
+      return false;
+    }
+  }
+
+  return stream.status() == QDataStream::Ok;
 }
 
 void ProjectSerializer::SaveData::SetOnlySerializeNodesAndResolveGroups(QVector<Node *> nodes)
@@ -64,6 +64,35 @@ public:
     kNoData
   };
 
+  enum ChunkType {
+    /// Project settings and window layout (everything except nodes)
+    kChunkProject,
+
+    /// A group of nodes, e.g. one sequence's graph or one folder's footage
+    kChunkNodes,
+
+    /// Pointers of nodes removed since the snapshot an incremental save applies to
+    kChunkRemovedNodes,
+
+    /// Snapshot filename (as the name) and journal entry count (as the data) of a recovery point
+    kChunkRecoveryPoint
+  };
+
+  /**
+   * @brief An independently compressed section of a chunked project file
+   *
+   * Chunked project files start with a one-line XML stub that older builds reject as too new,
+   * then "OVCK", followed by a table of contents listing each chunk's type, name, and location. Each chunk is a small XML document compressed on its own, so chunks
+   * can be decompressed and parsed in parallel rather than inflating the entire project into
+   * memory up front.
+   */
+  struct Chunk
+  {
+    ChunkType type;
+    QString name;
+    QByteArray data;
+  };
+
   using SerializedProperties = QHash<Node*, QMap<QString, QString> >;
   using SerializedKeyframes = QHash<QString, QVector<NodeKeyframe*> >;
 
@@ -123,6 +152,7 @@ public:
       type_ = type;
       project_ = project;
       filename_ = filename;
+      incremental_ = false;
     }
 
     Project *GetProject() const { return project_; }
@@ -149,6 +179,19 @@ public:
     const SerializedProperties &GetProperties() const { return properties_; }
     void SetProperties(const SerializedProperties &p) { properties_ = p; }
 
+    /**
+     * @brief Whether this is an incremental save of a project's changes
+     *
+     * Incremental saves write the project's settings and layout, only the nodes set in
+     * SetOnlySerializeNodes() (which may be none), and the nodes set in SetRemovedNodes(). Only
+     * supported when saving chunks.
+     */
+    bool IsIncremental() const { return incremental_; }
+    void SetIncremental(bool e) { incremental_ = e; }
+
+    const QVector<quintptr> &GetRemovedNodes() const { return removed_nodes_; }
+    void SetRemovedNodes(const QVector<quintptr> &nodes) { removed_nodes_ = nodes; }
+
   private:
     LoadType type_;
 
@@ -166,6 +209,10 @@ public:
 
     std::vector<NodeKeyframe*> only_serialize_keyframes_;
 
+    bool incremental_;
+
+    QVector<quintptr> removed_nodes_;
+
   };
 
   static void Initialize();
@@ -180,20 +227,95 @@ public:
   static Result Save(QXmlStreamWriter *write_device, const SaveData &data);
   static Result Copy(const SaveData &data);
 
-  static bool CheckCompressedID(QFile *file);
+  /**
+   * @brief Serialize project data into uncompressed chunks using the newest serializer
+   *
+   * Must be called on the thread that owns the project. The chunks can then be compressed and
+   * written on any thread with WriteChunks(). Returns an empty list if the data can't be chunked.
+   */
+  static QVector<Chunk> SerializeChunks(const SaveData &data);
+
+  /**
+   * @brief Compress and write chunks from SerializeChunks() as a chunked project file
+   */
+  static Result WriteChunks(const QString &filename, const QVector<Chunk> &chunks);
+
+  /**
+   * @brief Compress chunks and write them to `device` with an "OVCK" header and table of contents
+   */
+  static bool SaveChunked(QIODevice *device, const QVector<Chunk> &chunks);
+
+  /**
+   * @brief Read and decompress chunks from a device positioned just after its "OVCK" ID
+   */
+  static bool ReadChunks(QIODevice *device, uint *version, QVector<Chunk> *chunks);
+
+  static bool CheckCompressedID(QIODevice *file);
+  static bool CheckChunkedID(QIODevice *file);
+
+  /**
+   * @brief Reassemble a chunked project file (positioned after its ID) into a single XML document
+   *
+   * Returns an empty array if the file couldn't be read.
+   */
+  static QByteArray ConvertChunkedToXml(QFile *file);
 
 protected:
   virtual LoadData Load(Project *project, QXmlStreamReader *reader, LoadType load_type, void *reserved) const = 0;
 
   virtual void Save(QXmlStreamWriter *writer, const SaveData &data, void *reserved) const {}
 
+  /**
+   * @brief Load a project from decompressed chunks
+   *
+   * Only serializers that wrote chunked files need to override this.
+   */
+  virtual Result LoadChunks(Project *project, const QVector<Chunk> &chunks, LoadType load_type) const
+  {
+    return kUnknownVersion;
+  }
+
+  /**
+   * @brief Split a project into uncompressed chunks for a chunked project file
+   *
+   * Returning an empty list (the default) falls back to saving a single compressed XML document.
+   */
+  virtual QVector<Chunk> SaveChunks(const SaveData &data) const
+  {
+    return QVector<Chunk>();
+  }
+
   virtual uint Version() const = 0;
 
+  /**
+   * @brief Whether this version only changed the chunked file container, not the XML inside it
+   *
+   * Plain XML documents are stamped with the newest version that returns false here, so builds
+   * that predate the chunked container can still open them.
+   */
+  virtual bool IsChunkedOnly() const
+  {
+    return false;
+  }
+
   bool IsCancelled() const;
 
 private:
   static Result LoadWithSerializerVersion(uint version, Project *project, QXmlStreamReader *reader, LoadType load_type);
 
+  static ProjectSerializer *GetSerializerForVersion(uint version, ResultCode *error);
+
+  static ProjectSerializer *GetNewestXmlSerializer();
+
+  /**
+   * @brief Read a chunked file (positioned after its ID), resolving auto-recovery points
+   */
+  static bool ReadChunkedFile(QFile *file, uint *version, QVector<Chunk> *chunks);
+
+  static Result LoadChunked(Project *project, QFile *file, LoadType load_type);
+
+  static const uint kChunkedFormatVersion;
+
   static QVector<ProjectSerializer*> instances_;
 
 };
@@ -23,6 +23,7 @@
 #include "config/config.h"
 #include "node/factory.h"
 #include "node/group/group.h"
+#include "node/project/footage/footage.h"
 #include "node/serializeddata.h"
 
 namespace olive {
@@ -457,6 +458,9 @@ void ProjectSerializer230220::Save(QXmlStreamWriter *writer, const SaveData &dat
 
 void ProjectSerializer230220::PostConnect(const QVector<Node *> &nodes, SerializedData *project_data) const
 {
+  // Apply footage probes started while loading, in node order, before anything depends on them
+  Footage::FinishDeferredProbes(nodes);
+
   foreach (const SerializedData::SerializedConnection& con, project_data->desired_connections) {
     if (Node *out = project_data->node_ptrs.value(con.output_node)) {
       Node::ConnectEdge(out, con.input);
@@ -40,7 +40,6 @@ protected:
     return 230220;
   }
 
-private:
   void PostConnect(const QVector<Node*> &nodes, SerializedData *project_data) const;
 
 };
@@ -0,0 +1,356 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2023 Olive Studios LLC
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "serializer261018.h"
+
+#include <QFuture>
+#include <QtConcurrent/QtConcurrent>
+
+#include "node/project/folder/folder.h"
+#include "node/project/footage/footage.h"
+#include "node/project/sequence/sequence.h"
+#include "node/serializeddata.h"
+
+namespace olive {
+
+struct SplitNodeElements
+{
+  QVector<QByteArray> nodes;
+  QString error;
+};
+
+SplitNodeElements SplitNodeElementsFromChunk(const QByteArray &b)
+{
+  SplitNodeElements split;
+  QXmlStreamReader reader(b);
+
+  while (XMLReadNextStartElement(&reader)) {
+    if (reader.name() == QStringLiteral("nodes")) {
+      while (XMLReadNextStartElement(&reader)) {
+        if (reader.name() == QStringLiteral("node")) {
+          // Copy the node element verbatim so it can be loaded on its own
+          QByteArray xml;
+          QXmlStreamWriter writer(&xml);
+          writer.writeCurrentToken(reader);
+
+          int depth = 1;
+          while (depth > 0 && !reader.atEnd()) {
+            reader.readNext();
+
+            if (reader.isStartElement()) {
+              depth++;
+            } else if (reader.isEndElement()) {
+              depth--;
+            }
+
+            writer.writeCurrentToken(reader);
+          }
+
+          split.nodes.append(xml);
+        } else {
+          reader.skipCurrentElement();
+        }
+      }
+    } else {
+      reader.skipCurrentElement();
+    }
+  }
+
+  if (reader.hasError()) {
+    split.error = QCoreApplication::translate("Serializer", "%1 on line %2").arg(reader.errorString(), QString::number(reader.lineNumber()));
+  }
+
+  return split;
+}
+
+ProjectSerializer::Result ProjectSerializer261018::LoadChunks(Project *project, const QVector<Chunk> &chunks, LoadType load_type) const
+{
+  if (load_type != kProject || !project) {
+    return kNoData;
+  }
+
+  // Parse node chunks into individual node elements in parallel. Nodes are QObjects, so they're
+  // only constructed and loaded on the project's thread.
+  QVector<QFuture<SplitNodeElements> > futures;
+  QByteArray project_chunk;
+
+  for (const Chunk &c : chunks) {
+    if (c.type == kChunkNodes) {
+      QByteArray b = c.data;
+      futures.append(QtConcurrent::run([b]{
+        return SplitNodeElementsFromChunk(b);
+      }));
+    } else if (c.type == kChunkProject) {
+      project_chunk = c.data;
+    }
+  }
+
+  SerializedData project_data;
+  QString error;
+
+  // Footage probes from every chunk share one I/O pool and are applied in PostConnect
+  Footage::BeginDeferredProbing();
+
+  for (QFuture<SplitNodeElements> &f : futures) {
+    SplitNodeElements split = f.result();
+
+    if (!split.error.isEmpty()) {
+      if (error.isEmpty()) {
+        error = split.error;
+      }
+      continue;
+    }
+
+    for (const QByteArray &xml : split.nodes) {
+      QXmlStreamReader reader(xml);
+
+      if (XMLReadNextStartElement(&reader)) {
+        if (Node *n = Project::LoadNode(&reader, &project_data)) {
+          n->setParent(project);
+        }
+      }
+    }
+  }
+
+  Footage::EndDeferredProbing();
+
+  if (!error.isEmpty()) {
+    Footage::FinishDeferredProbes(project->nodes());
+
+    Result r(kXmlError);
+    r.SetDetails(error);
+    return r;
+  }
+
+  // Load project settings and layout last, since they refer to nodes from the other chunks
+  LoadData load_data;
+  QXmlStreamReader reader(project_chunk);
+
+  while (XMLReadNextStartElement(&reader)) {
+    if (reader.name() == QStringLiteral("olive")) {
+      XMLAttributeLoop((&reader), attr) {
+        if (attr.name() == QStringLiteral("url")) {
+          project->SetSavedURL(attr.value().toString());
+        }
+      }
+
+      while (XMLReadNextStartElement(&reader)) {
+        if (reader.name() == QStringLiteral("project")) {
+          while (XMLReadNextStartElement(&reader)) {
+            if (reader.name() == QStringLiteral("project")) {
+              project->Load(&reader, &project_data);
+            } else if (reader.name() == QStringLiteral("layout")) {
+              load_data.layout = MainWindowLayoutInfo::fromXml(&reader, project_data.node_ptrs);
+            } else {
+              reader.skipCurrentElement();
+            }
+          }
+        } else {
+          reader.skipCurrentElement();
+        }
+      }
+    } else {
+      reader.skipCurrentElement();
+    }
+  }
+
+  if (reader.hasError()) {
+    Result r(kXmlError);
+    r.SetDetails(QCoreApplication::translate("Serializer", "%1 on line %2").arg(reader.errorString(), QString::number(reader.lineNumber())));
+    return r;
+  }
+
+  PostConnect(project->nodes(), &project_data);
+
+  Result r(kSuccess);
+  r.SetLoadData(load_data);
+  return r;
+}
+
+QByteArray SaveNodeChunk(const QVector<Node*> &nodes)
+{
+  QByteArray b;
+  QXmlStreamWriter writer(&b);
+
+  writer.writeStartDocument();
+
+  writer.writeStartElement(QStringLiteral("nodes"));
+
+  for (Node *n : nodes) {
+    writer.writeStartElement(QStringLiteral("node"));
+    n->Save(&writer);
+    writer.writeEndElement(); // node
+  }
+
+  writer.writeEndElement(); // nodes
+
+  writer.writeEndDocument();
+
+  return b;
+}
+
+QVector<ProjectSerializer::Chunk> ProjectSerializer261018::SaveChunks(const SaveData &data) const
+{
+  QVector<Chunk> chunks;
+
+  Project *project = data.GetProject();
+  if (data.type() != kProject || !project) {
+    return chunks;
+  }
+
+  // Project settings and layout, written in the same structure as the XML format but without nodes
+  {
+    Chunk c;
+    c.type = kChunkProject;
+
+    QXmlStreamWriter writer(&c.data);
+
+    writer.writeStartDocument();
+
+    writer.writeStartElement(QStringLiteral("olive"));
+
+    writer.writeAttribute(QStringLiteral("version"), QString::number(Version()));
+
+    if (!data.GetFilename().isEmpty()) {
+      writer.writeAttribute(QStringLiteral("url"), data.GetFilename());
+    }
+
+    writer.writeStartElement(QStringLiteral("project"));
+
+    writer.writeStartElement(QStringLiteral("project"));
+    project->Save(&writer, false);
+    writer.writeEndElement(); // project
+
+    writer.writeStartElement(QStringLiteral("layout"));
+    data.GetLayout().toXml(&writer);
+    writer.writeEndElement(); // layout
+
+    writer.writeEndElement(); // project
+
+    writer.writeEndElement(); // olive
+
+    writer.writeEndDocument();
+
+    chunks.append(c);
+  }
+
+  // Incremental saves only contain the nodes that changed and the ones that were removed
+  if (data.IsIncremental()) {
+    if (!data.GetOnlySerializeNodes().isEmpty()) {
+      Chunk c;
+      c.type = kChunkNodes;
+      c.data = SaveNodeChunk(data.GetOnlySerializeNodes());
+      chunks.append(c);
+    }
+
+    if (!data.GetRemovedNodes().isEmpty()) {
+      Chunk c;
+      c.type = kChunkRemovedNodes;
+
+      QXmlStreamWriter writer(&c.data);
+
+      writer.writeStartDocument();
+
+      writer.writeStartElement(QStringLiteral("removed"));
+
+      for (quintptr ptr : data.GetRemovedNodes()) {
+        writer.writeStartElement(QStringLiteral("node"));
+        writer.writeAttribute(QStringLiteral("ptr"), QString::number(ptr));
+        writer.writeEndElement(); // node
+      }
+
+      writer.writeEndElement(); // removed
+
+      writer.writeEndDocument();
+
+      chunks.append(c);
+    }
+
+    return chunks;
+  }
+
+  // Group footage by folder, then each sequence with the nodes in its graph
+  QVector<QPair<QString, QVector<Node*> > > groups;
+  QHash<Folder*, int> folder_groups;
+  QSet<Node*> grouped;
+
+  for (Node *n : project->nodes()) {
+    if (dynamic_cast<Footage*>(n)) {
+      Folder *f = n->folder();
+      int index = folder_groups.value(f, -1);
+
+      if (index == -1) {
+        index = groups.size();
+        folder_groups.insert(f, index);
+        groups.append({f ? f->GetLabel() : QString(), QVector<Node*>()});
+      }
+
+      groups[index].second.append(n);
+      grouped.insert(n);
+    }
+  }
+
+  for (Node *n : project->nodes()) {
+    if (Sequence *s = dynamic_cast<Sequence*>(n)) {
+      QVector<Node*> group;
+
+      // A nested sequence may have been grouped with its parent's graph already
+      if (!grouped.contains(s)) {
+        group.append(s);
+        grouped.insert(s);
+      }
+
+      for (auto it=s->GetContextPositions().cbegin(); it!=s->GetContextPositions().cend(); it++) {
+        if (!grouped.contains(it.key())) {
+          group.append(it.key());
+          grouped.insert(it.key());
+        }
+      }
+
+      if (!group.isEmpty()) {
+        groups.append({s->GetLabel(), group});
+      }
+    }
+  }
+
+  // Everything else is split evenly so no chunk is too large to parse in parallel
+  QVector<Node*> remaining;
+  for (Node *n : project->nodes()) {
+    if (!grouped.contains(n)) {
+      remaining.append(n);
+    }
+  }
+
+  for (int i=0; i<remaining.size(); i+=kMaxNodesPerChunk) {
+    groups.append({QString(), remaining.mid(i, kMaxNodesPerChunk)});
+  }
+
+  for (const QPair<QString, QVector<Node*> > &g : groups) {
+    Chunk c;
+    c.type = kChunkNodes;
+    c.name = g.first;
+    c.data = SaveNodeChunk(g.second);
+    chunks.append(c);
+  }
+
+  return chunks;
+}
+
+}
@@ -0,0 +1,64 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2023 Olive Studios LLC
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef PROJECTSERIALIZER261018_H
+#define PROJECTSERIALIZER261018_H
+
+#include "serializer230220.h"
+
+namespace olive {
+
+/**
+ * @brief Adds chunked project files to the 230220 format
+ *
+ * The XML format is unchanged, the version only differs so that builds that can't read chunked
+ * files report the project as too new.
+ */
+class ProjectSerializer261018 : public ProjectSerializer230220
+{
+public:
+  ProjectSerializer261018() = default;
+
+protected:
+  virtual Result LoadChunks(Project *project, const QVector<Chunk> &chunks, LoadType load_type) const override;
+
+  virtual QVector<Chunk> SaveChunks(const SaveData &data) const override;
+
+  virtual uint Version() const override
+  {
+    return 261018;
+  }
+
+  virtual bool IsChunkedOnly() const override
+  {
+    return true;
+  }
+
+private:
+  /**
+   * @brief Nodes that don't belong to a sequence or folder are split into chunks of this size
+   */
+  static const int kMaxNodesPerChunk = 512;
+
+};
+
+}
+
+#endif // PROJECTSERIALIZER261018_H
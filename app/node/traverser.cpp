@@ -24,6 +24,7 @@
 #include "node/block/clip/clip.h"
 #include "render/job/footagejob.h"
 #include "render/rendermanager.h"
+#include "render/shaderfusion.h"
 
 namespace olive {
 
@@ -358,6 +359,11 @@ void NodeTraverser::ResolveJobs(NodeValue &val)
         if (resolved_texture_cache_.contains(job_tex.get())) {
           val.set_value(resolved_texture_cache_.value(job_tex.get()));
         } else {
+          if (ShaderJob *sj = dynamic_cast<ShaderJob*>(base_job)) {
+            // Merge any per-pixel shaders feeding this one before they get resolved into textures
+            FuseShaderChain(val.source(), sj, job_tex->params());
+          }
+
           // Resolve any sub-jobs
           for (auto it=base_job->GetValues().begin(); it!=base_job->GetValues().end(); it++) {
             // Jobs will almost always be submitted with one of these types
@@ -471,6 +477,87 @@ void NodeTraverser::ResolveJobs(NodeValue &val)
   }
 }
 
+void NodeTraverser::FuseShaderChain(const Node *node, ShaderJob *job, const VideoParams &params)
+{
+  // Walk from this job inwards while each texture input is another fusable shader of the same size
+  // that nothing has resolved yet
+  QVector<const Node*> nodes = {node};
+  QVector<ShaderJob*> jobs = {job};
+
+  if (job->GetFusableInput().isEmpty()
+      || job->GetIterationCount() > 1
+      || !job->GetVertexCoordinates().isEmpty()
+      || job->IsFused()) {
+    return;
+  }
+
+  while (jobs.size() < kMaxFusedStages) {
+    NodeValue input = jobs.last()->Get(jobs.last()->GetFusableInput());
+    if (input.type() != NodeValue::kTexture || !input.source()) {
+      break;
+    }
+
+    TexturePtr tex = input.toTexture();
+    if (!tex || resolved_texture_cache_.contains(tex.get())) {
+      break;
+    }
+
+    ShaderJob *inner = dynamic_cast<ShaderJob*>(tex->job());
+    if (!inner
+        || inner->GetFusableInput().isEmpty()
+        || inner->GetIterationCount() > 1
+        || !inner->GetVertexCoordinates().isEmpty()
+        || inner->IsFused()
+        || tex->params().effective_width() != params.effective_width()
+        || tex->params().effective_height() != params.effective_height()) {
+      break;
+    }
+
+    nodes.append(input.source());
+    jobs.append(inner);
+  }
+
+  if (jobs.size() < 2) {
+    return;
+  }
+
+  // Stages are numbered from the innermost job outwards, each one's values get that stage's prefix
+  ShaderJob fused;
+  QVector<ShaderJob::FusedStage> stages;
+
+  for (int i=0; i<jobs.size(); i++) {
+    int index = jobs.size() - 1 - i;
+    const ShaderJob *sj = jobs.at(index);
+    QString prefix = ShaderFusion::GetStagePrefix(i);
+
+    for (auto it=sj->GetValues().cbegin(); it!=sj->GetValues().cend(); it++) {
+      if (i > 0 && it.key() == sj->GetFusableInput()) {
+        // Replaced by a call to the previous stage
+        continue;
+      }
+
+      fused.Insert(prefix + it.key(), it.value());
+    }
+
+    for (auto it=sj->GetInterpolationMap().cbegin(); it!=sj->GetInterpolationMap().cend(); it++) {
+      fused.SetInterpolation(prefix + it.key(), it.value());
+    }
+
+    stages.append({nodes.at(index), sj->GetShaderID(), sj->GetFusableInput()});
+  }
+
+  // Only replace the chain once we know the fused shader can be built, otherwise the stages are
+  // rendered separately as usual
+  ShaderCode code;
+  if (!ShaderFusion::GenerateCode(stages, &code)) {
+    return;
+  }
+
+  fused.SetFusedStages(stages);
+
+  *job = fused;
+}
+
 TexturePtr NodeTraverser::CreateDummyTexture(const VideoParams &p)
 {
   return std::make_shared<Texture>(p);
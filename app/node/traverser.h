@@ -30,7 +30,7 @@
 #include "render/cancelatom.h"
 #include "render/job/footagejob.h"
 #include "render/job/colortransformjob.h"
-#include "render/job/footagejob.h"
+#include "render/job/shaderjob.h"
 #include "value.h"
 
 namespace olive {
@@ -145,6 +145,10 @@ protected:
 private:
   TexturePtr CreateDummyTexture(const VideoParams &p);
 
+  void FuseShaderChain(const Node *node, ShaderJob *job, const VideoParams &params);
+
+  static const int kMaxFusedStages = 8;
+
   VideoParams video_params_;
 
   AudioParams audio_params_;
@@ -36,6 +36,7 @@ TaskManagerPanel::TaskManagerPanel() :
   // Connect task view to the task manager
   connect(TaskManager::instance(), &TaskManager::TaskAdded, view_, &TaskView::AddTask);
   connect(TaskManager::instance(), &TaskManager::TaskRemoved, view_, &TaskView::RemoveTask);
+  connect(TaskManager::instance(), &TaskManager::TaskStarted, view_, &TaskView::TaskStarted);
   connect(TaskManager::instance(), &TaskManager::TaskFailed, view_, &TaskView::TaskFailed);
   connect(view_, &TaskView::TaskCancelled, TaskManager::instance(), &TaskManager::CancelTask);
 
@@ -48,6 +48,11 @@ namespace olive {
  * AudioPlaybackCache also provides a playback device (accessible from CreatePlaybackDevice()) that
  * acts identically to a file-based IO device, transparently joining segments together and acting
  * like one contiguous file.
+ *
+ * Playback itself does not have to wait for this cache. When "RealtimeAudioPlayback" is enabled,
+ * PreviewAutoCacher::GetRangeOfAudio() mixes playback audio straight from the graph on a
+ * dedicated high priority render thread, so edits are audible before their range here has been
+ * re-rendered.
  */
 class AudioPlaybackCache : public PlaybackCache
 {
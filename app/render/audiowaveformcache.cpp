@@ -20,18 +20,78 @@
 
 #include "audiowaveformcache.h"
 
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
+
+#include "render/diskmanager.h"
+
 namespace olive {
 
 #define super PlaybackCache
 
+namespace {
+
+QThreadPool *GetTileThreadPool()
+{
+  // Loading is mostly waiting on storage, a couple of threads is plenty and leaves the rest of the
+  // machine for rendering
+  static QThreadPool pool;
+  static bool initialized = [](){
+    pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+    return true;
+  }();
+  Q_UNUSED(initialized)
+
+  return &pool;
+}
+
+QThreadPool *GetTileWriterThreadPool()
+{
+  // Writes to a store are serialized anyway, one thread keeps them from piling up behind each other
+  static QThreadPool pool;
+  static bool initialized = [](){
+    pool.setMaxThreadCount(1);
+    return true;
+  }();
+  Q_UNUSED(initialized)
+
+  return &pool;
+}
+
+}
+
 AudioWaveformCache::AudioWaveformCache(QObject *parent) :
   super{parent}
 {
-  waveforms_ = std::make_shared<AudioVisualWaveform>();
+  waveforms_ = std::make_shared<AudioWaveformTileStore>();
+
+  if (DiskManager::instance()) {
+    connect(DiskManager::instance(), &DiskManager::DeletedFrame, this, &AudioWaveformCache::FileDeleted);
+    connect(DiskManager::instance(), &DiskManager::InvalidateProject, this, &AudioWaveformCache::ProjectInvalidated);
+  }
+}
+
+AudioWaveformCache::~AudioWaveformCache()
+{
+  // Loads signal us when they finish, so they can't outlive us
+  for (QFuture<void> &f : loads_) {
+    f.waitForFinished();
+  }
+}
+
+void AudioWaveformCache::SetParameters(const AudioParams &p)
+{
+  SyncDirectory();
+
+  params_ = p;
+  waveforms_->set_channel_count(p.channel_count());
 }
 
 void AudioWaveformCache::WriteWaveform(const TimeRange &range, const TimeRangeList &valid_ranges, const AudioVisualWaveform *waveform)
 {
+  SyncDirectory();
+
   // Write each valid range to the segments
   foreach (const TimeRange& r, valid_ranges) {
     if (waveform) {
@@ -40,9 +100,18 @@ void AudioWaveformCache::WriteWaveform(const TimeRange &range, const TimeRangeLi
 
     Validate(r);
   }
+
+  if (waveform) {
+    // Persist the changed tiles without holding up the GUI thread. The job holds its own reference
+    // to the store, so it's fine for it to outlive us.
+    WaveformPtr store = waveforms_;
+    QtConcurrent::run(GetTileWriterThreadPool(), [store](){
+      store->WriteDirtyTiles();
+    });
+  }
 }
 
-void DrawSubRect(QPainter *painter, const QRect &rect, const double &scale, const TimeRange &wave_range, const AudioVisualWaveform &waveform, const TimeRange &subrange)
+void DrawSubRect(QPainter *painter, const QRect &rect, const double &scale, const TimeRange &wave_range, AudioWaveformTileStore &waveform, const TimeRange &subrange, std::vector<AudioWaveformTileStore::TileKey> *missing)
 {
   // Find start time of passthrough
   TimeRange intersect = wave_range.Intersected(subrange);
@@ -55,17 +124,23 @@ void DrawSubRect(QPainter *painter, const QRect &rect, const double &scale, cons
                   rect.height());
 
   // Draw waveform with this info
-  AudioVisualWaveform::DrawWaveform(painter, pass_rect, scale, waveform, intersect.in());
+  waveform.Draw(painter, pass_rect, scale, intersect.in(), missing);
 }
 
 void AudioWaveformCache::Draw(QPainter *painter, const QRect &rect, const double &scale, const rational &start_time) const
 {
+  SyncDirectory();
+
+  std::vector<AudioWaveformTileStore::TileKey> missing;
+
   if (!passthroughs_.empty()) {
     TimeRange wave_range(start_time, start_time + rational::fromDouble(rect.width() / scale));
     TimeRangeList draw_range = {wave_range};
     for (const WaveformPassthrough &p : passthroughs_) {
       if (draw_range.OverlapsWith(p, true, false)) {
-        DrawSubRect(painter, rect, scale, wave_range, *p.waveform, p);
+        std::vector<AudioWaveformTileStore::TileKey> passthrough_missing;
+        DrawSubRect(painter, rect, scale, wave_range, *p.waveform, p, &passthrough_missing);
+        LoadTiles(p.waveform, passthrough_missing);
 
         // Remove this range
         draw_range.remove(p);
@@ -73,20 +148,26 @@ void AudioWaveformCache::Draw(QPainter *painter, const QRect &rect, const double
     }
 
     for (const TimeRange &r : draw_range) {
-      DrawSubRect(painter, rect, scale, wave_range, *waveforms_, r);
+      DrawSubRect(painter, rect, scale, wave_range, *waveforms_, r, &missing);
     }
   } else {
-    AudioVisualWaveform::DrawWaveform(painter, rect, scale, *waveforms_, start_time);
+    waveforms_->Draw(painter, rect, scale, start_time, &missing);
   }
+
+  LoadTiles(waveforms_, missing);
 }
 
 AudioVisualWaveform::Sample AudioWaveformCache::GetSummaryFromTime(const rational &start, const rational &length) const
 {
+  SyncDirectory();
+
   return waveforms_->GetSummaryFromTime(start, length);
 }
 
 rational AudioWaveformCache::length() const
 {
+  SyncDirectory();
+
   return waveforms_->length();
 }
 
@@ -105,6 +186,63 @@ void AudioWaveformCache::SetPassthrough(PlaybackCache *cache)
   SetSavingEnabled(c->IsSavingEnabled());
 }
 
+void AudioWaveformCache::SyncDirectory() const
+{
+  if (!DiskManager::instance()) {
+    return;
+  }
+
+  // Our directory depends on the project and UUID, either of which may have changed since we
+  // last accessed the store
+  if (waveforms_->SetDirectory(GetCacheDirectory(), GetThisCacheDirectory().path())) {
+    // What we validated isn't in the store anymore. This may be called while drawing, so don't
+    // signal from in here.
+    QMetaObject::invokeMethod(const_cast<AudioWaveformCache*>(this), &AudioWaveformCache::InvalidateAll, Qt::QueuedConnection);
+  }
+}
+
+void AudioWaveformCache::LoadTiles(WaveformPtr waveform, const std::vector<AudioWaveformTileStore::TileKey> &keys) const
+{
+  if (keys.empty()) {
+    return;
+  }
+
+  // Forget about loads that have already finished
+  for (int i=loads_.size()-1; i>=0; i--) {
+    if (loads_.at(i).isFinished()) {
+      loads_.removeAt(i);
+    }
+  }
+
+  AudioWaveformCache *self = const_cast<AudioWaveformCache*>(this);
+
+  loads_.append(QtConcurrent::run(GetTileThreadPool(), [waveform, keys, self](){
+    waveform->LoadTiles(keys);
+
+    QMetaObject::invokeMethod(self, &AudioWaveformCache::TilesLoaded, Qt::QueuedConnection);
+  }));
+}
+
+void AudioWaveformCache::FileDeleted(const QString &path, const QString &filename)
+{
+  if (path != GetCacheDirectory() || QFileInfo(filename).dir() != GetThisCacheDirectory()) {
+    return;
+  }
+
+  // Whatever this file held will have to be rendered again
+  TimeRange range;
+  if (AudioWaveformTileStore::GetFileTimeRange(filename, &range)) {
+    Invalidate(range);
+  }
+}
+
+void AudioWaveformCache::ProjectInvalidated(Project *p)
+{
+  if (GetProject() == p) {
+    InvalidateAll();
+  }
+}
+
 void AudioWaveformCache::InvalidateEvent(const TimeRange& range)
 {
   TimeRangeList::util_remove(&passthroughs_, range);
@@ -21,25 +21,33 @@
 #ifndef AUDIOWAVEFORMCACHE_H
 #define AUDIOWAVEFORMCACHE_H
 
+#include <QFuture>
+
 #include "audio/audiovisualwaveform.h"
+#include "audiowaveformtilestore.h"
 #include "playbackcache.h"
 
 namespace olive {
 
+/**
+ * @brief PlaybackCache of the visual waveform of some audio
+ *
+ * Waveform data is kept in an AudioWaveformTileStore inside this cache's directory, so only the
+ * parts currently being drawn need to be in memory. Drawing never waits on disk, tiles that aren't
+ * in memory are loaded in the background and TilesLoaded() is emitted once they can be drawn.
+ */
 class AudioWaveformCache : public PlaybackCache
 {
   Q_OBJECT
 public:
   AudioWaveformCache(QObject *parent = nullptr);
 
+  virtual ~AudioWaveformCache() override;
+
   void WriteWaveform(const TimeRange &range, const TimeRangeList &valid_ranges, const AudioVisualWaveform *waveform);
 
   const AudioParams &GetParameters() const { return params_; }
-  void SetParameters(const AudioParams &p)
-  {
-    params_ = p;
-    waveforms_->set_channel_count(p.channel_count());
-  }
+  void SetParameters(const AudioParams &p);
 
   void Draw(QPainter* painter, const QRect &rect, const double &scale, const rational &start_time) const;
 
@@ -49,11 +57,18 @@ public:
 
   virtual void SetPassthrough(PlaybackCache *cache) override;
 
+signals:
+  void TilesLoaded();
+
 protected:
   virtual void InvalidateEvent(const TimeRange& range) override;
 
 private:
-  using WaveformPtr = std::shared_ptr<AudioVisualWaveform>;
+  using WaveformPtr = std::shared_ptr<AudioWaveformTileStore>;
+
+  void SyncDirectory() const;
+
+  void LoadTiles(WaveformPtr waveform, const std::vector<AudioWaveformTileStore::TileKey> &keys) const;
 
   WaveformPtr waveforms_;
 
@@ -71,6 +86,13 @@ private:
 
   std::vector<WaveformPassthrough> passthroughs_;
 
+  mutable QVector<QFuture<void>> loads_;
+
+private slots:
+  void FileDeleted(const QString &path, const QString &filename);
+
+  void ProjectInvalidated(Project *p);
+
 };
 
 }
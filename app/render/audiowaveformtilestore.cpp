@@ -0,0 +1,696 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "audiowaveformtilestore.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "common/filefunctions.h"
+#include "config/config.h"
+#include "render/diskmanager.h"
+
+namespace olive {
+
+QMutex AudioWaveformTileStore::lock_;
+std::list<AudioWaveformTileStore::LRUEntry> AudioWaveformTileStore::lru_;
+size_t AudioWaveformTileStore::resident_bytes_ = 0;
+
+// Quantized values cover -4.0 to 4.0 so that levels over 0dB (e.g. in the audio monitor) are
+// still represented
+static const float kQuantizeScale = 32767.0f / 4.0f;
+
+AudioWaveformTileStore::AudioWaveformTileStore() :
+  channels_(0),
+  index_dirty_(false)
+{
+}
+
+AudioWaveformTileStore::~AudioWaveformTileStore()
+{
+  QMutexLocker write_locker(&write_lock_);
+  QMutexLocker locker(&lock_);
+
+  FlushDirtyTiles();
+  if (index_dirty_) {
+    SaveIndex();
+  }
+  DropAllTiles();
+}
+
+bool AudioWaveformTileStore::SetDirectory(const QString &cache_path, const QString &dir)
+{
+  QMutexLocker write_locker(&write_lock_);
+  QMutexLocker locker(&lock_);
+
+  if (directory_ == dir) {
+    return false;
+  }
+
+  if (directory_.isEmpty() && !tiles_.empty()) {
+    // Nothing has been written anywhere yet, so everything is still in memory and can be
+    // persisted into the new directory as-is
+    cache_path_ = cache_path;
+    directory_ = dir;
+
+    for (auto it=tiles_.begin(); it!=tiles_.end(); it++) {
+      it->second.dirty = true;
+    }
+
+    FlushDirtyTiles();
+    SaveIndex();
+    EvictTiles();
+
+    return false;
+  }
+
+  // Anything held in memory belongs to the old directory
+  bool had_data = !directory_.isEmpty() && length_ > 0;
+
+  FlushDirtyTiles();
+  if (index_dirty_) {
+    SaveIndex();
+  }
+  DropAllTiles();
+
+  cache_path_ = cache_path;
+  directory_ = dir;
+
+  if (LoadIndex()) {
+    return false;
+  }
+
+  length_ = 0;
+
+  return had_data;
+}
+
+void AudioWaveformTileStore::set_channel_count(int channels)
+{
+  QMutexLocker write_locker(&write_lock_);
+  QMutexLocker locker(&lock_);
+
+  if (channels_ == channels) {
+    return;
+  }
+
+  // Tiles are interleaved so they're meaningless with a different channel count
+  DropAllTiles();
+
+  channels_ = channels;
+
+  SaveIndex();
+}
+
+void AudioWaveformTileStore::OverwriteSums(const AudioVisualWaveform &sums, const rational &dest, const rational &offset, const rational &length)
+{
+  QMutexLocker locker(&lock_);
+
+  if (!channels_ || !sums.channel_count()) {
+    return;
+  }
+
+  int copy_channels = std::min(channels_, sums.channel_count());
+
+  for (int level=0; level<GetLevelCount(); level++) {
+    rational rate = GetLevelRate(level);
+    double rate_dbl = rate.toDouble();
+
+    const AudioVisualWaveform::Sample &their_arr = sums.GetMipmap(rate);
+    int64_t their_frames = their_arr.size() / sums.channel_count();
+
+    int64_t our_start = std::floor(dest.toDouble() * rate_dbl);
+    int64_t their_start = std::floor(offset.toDouble() * rate_dbl);
+    if (their_start >= their_frames) {
+      continue;
+    }
+
+    int64_t copy_len = their_frames - their_start;
+    if (!length.isNull()) {
+      copy_len = std::min(copy_len, int64_t(std::floor(length.toDouble() * rate_dbl)));
+    }
+
+    int64_t copied = 0;
+    while (copied < copy_len) {
+      int64_t frame = our_start + copied;
+      int64_t tile_index = frame / kTileFrames;
+      int64_t offset_in_tile = frame % kTileFrames;
+      int64_t count = std::min(copy_len - copied, kTileFrames - offset_in_tile);
+
+      Tile *t = GetTile(level, tile_index);
+
+      for (int64_t i=0; i<count; i++) {
+        const AudioVisualWaveform::SamplePerChannel *src = &their_arr.at((their_start + copied + i) * sums.channel_count());
+        qint16 *dst = &t->data[(offset_in_tile + i) * channels_ * 2];
+
+        for (int c=0; c<copy_channels; c++) {
+          dst[c*2] = Quantize(src[c].min);
+          dst[c*2+1] = Quantize(src[c].max);
+        }
+      }
+
+      t->dirty = true;
+      t->revision++;
+
+      copied += count;
+    }
+  }
+
+  length_ = std::max(length_, dest + ((length.isNull()) ? sums.length() - offset : length));
+  index_dirty_ = true;
+
+  // Dirty tiles aren't evicted, they're written (and can then be evicted) by WriteDirtyTiles()
+  EvictTiles();
+}
+
+void AudioWaveformTileStore::WriteDirtyTiles()
+{
+  QMutexLocker write_locker(&write_lock_);
+  QMutexLocker locker(&lock_);
+
+  if (!IsDirectoryWritable()) {
+    return;
+  }
+
+  struct PendingTile
+  {
+    TileKey key;
+    uint64_t revision;
+    std::vector<qint16> data;
+    bool written;
+  };
+
+  std::vector<PendingTile> pending;
+  for (auto it=tiles_.begin(); it!=tiles_.end(); it++) {
+    if (it->second.dirty) {
+      pending.push_back({it->first, it->second.revision, it->second.data, false});
+    }
+  }
+
+  bool write_index = index_dirty_;
+  index_dirty_ = false;
+
+  if (pending.empty() && !write_index) {
+    return;
+  }
+
+  // Nothing else can change these while we hold write_lock_
+  QString dir = directory_;
+  QString cache_path = cache_path_;
+  int channels = channels_;
+  rational length = length_;
+
+  // Write without the lock, it's shared by every store and drawing shouldn't wait on disk
+  locker.unlock();
+
+  for (PendingTile &p : pending) {
+    p.written = WriteTileFile(GetTileFilename(dir, p.key), cache_path, p.data);
+  }
+
+  bool index_written = !write_index || WriteIndexFile(dir, cache_path, channels, length);
+
+  locker.relock();
+
+  if (!index_written) {
+    index_dirty_ = true;
+  }
+
+  for (const PendingTile &p : pending) {
+    auto it = tiles_.find(p.key);
+
+    // Tiles changed again since we copied them stay dirty for the next write
+    if (p.written && it != tiles_.end() && it->second.revision == p.revision) {
+      it->second.dirty = false;
+    }
+  }
+
+  EvictTiles();
+}
+
+AudioVisualWaveform::Sample AudioWaveformTileStore::GetSummaryFromTime(const rational &start, const rational &length)
+{
+  QMutexLocker locker(&lock_);
+
+  if (channels_) {
+    int level = GetLevelForScale(length.flipped().toDouble());
+    double rate_dbl = GetLevelRate(level).toDouble();
+
+    int64_t start_frame = std::floor(start.toDouble() * rate_dbl);
+    int64_t frame_count = std::floor(length.toDouble() * rate_dbl);
+    int64_t end_frame = std::min(frame_count + start_frame, int64_t(std::floor(length_.toDouble() * rate_dbl)));
+
+    if (start_frame >= 0 && end_frame > start_frame) {
+      // Load whatever isn't in memory without holding the lock, so drawing isn't held up by disk
+      std::vector<TileKey> missing;
+      GetMissingTiles(level, start_frame, end_frame - start_frame, &missing);
+
+      if (!missing.empty()) {
+        locker.unlock();
+        LoadTiles(missing);
+        locker.relock();
+      }
+
+      AudioVisualWaveform::Sample frames((end_frame - start_frame) * channels_);
+      ReadFrames(level, start_frame, end_frame - start_frame, frames.data());
+      EvictTiles();
+
+      return AudioVisualWaveform::ReSumSamples(frames.data(), frames.size(), channels_);
+    }
+  }
+
+  // Return null samples
+  return AudioVisualWaveform::Sample(channels_, {0, 0});
+}
+
+void AudioWaveformTileStore::Draw(QPainter *painter, const QRect &rect, double scale, const rational &start_time, std::vector<TileKey> *missing)
+{
+  QMutexLocker locker(&lock_);
+
+  if (!channels_) {
+    return;
+  }
+
+  int level = GetLevelForScale(scale);
+  double rate_dbl = GetLevelRate(level).toDouble();
+
+  const QRect& viewport = painter->viewport();
+  QPoint top_left = painter->transform().map(viewport.topLeft());
+
+  int start = qMax(rect.x(), -top_left.x());
+  int end = qMin(rect.right(), -top_left.x() + viewport.width());
+
+  int64_t first_frame = std::floor(start_time.toDouble() * rate_dbl);
+  int64_t length_frames = std::floor(length_.toDouble() * rate_dbl);
+
+  auto frame_at_x = [&](int x) {
+    return first_frame + int64_t(std::floor(rate_dbl * static_cast<double>(x - rect.x()) / scale));
+  };
+
+  int64_t fetch_start = std::max(int64_t(0), frame_at_x(start));
+  int64_t fetch_end = std::min(length_frames, std::max(frame_at_x(end), fetch_start + 1));
+
+  if (start >= end || fetch_start >= fetch_end) {
+    return;
+  }
+
+  // Anything that isn't in memory is loaded in the background and drawn once it's ready
+  size_t first_missing = missing->size();
+  GetMissingTiles(level, fetch_start, fetch_end - fetch_start, missing);
+
+  for (size_t i=first_missing; i<missing->size(); i++) {
+    loading_.insert(missing->at(i));
+  }
+
+  auto is_resident = [&](int64_t frame) {
+    return tiles_.find(MakeKey(level, frame / kTileFrames)) != tiles_.end();
+  };
+
+  AudioVisualWaveform::Sample frames((fetch_end - fetch_start) * channels_);
+  ReadFrames(level, fetch_start, fetch_end - fetch_start, frames.data(), false);
+
+  bool rectified = OLIVE_CONFIG("RectifiedWaveforms").toBool();
+
+  AudioVisualWaveform::Sample summary;
+  int64_t summary_frame = -1;
+
+  for (int x=start; x<end; x++) {
+    int64_t frame = std::max(fetch_start, frame_at_x(x));
+    if (frame >= fetch_end) {
+      break;
+    }
+
+    int64_t next_frame = std::min(fetch_end, std::max(frame + 1, frame_at_x(x + 1)));
+
+    if (!is_resident(frame) || !is_resident(next_frame - 1)) {
+      continue;
+    }
+
+    if (summary_frame != frame) {
+      summary = AudioVisualWaveform::ReSumSamples(&frames.at((frame - fetch_start) * channels_),
+                                                  (next_frame - frame) * channels_,
+                                                  channels_);
+      summary_frame = frame;
+    }
+
+    AudioVisualWaveform::DrawSample(painter, summary, x, rect.y(), rect.height(), rectified);
+  }
+
+  EvictTiles();
+}
+
+int AudioWaveformTileStore::GetLevelCount()
+{
+  static int count = 0;
+  if (!count) {
+    for (rational i=AudioVisualWaveform::kMinimumSampleRate; i<=AudioVisualWaveform::kMaximumSampleRate; i*=2) {
+      count++;
+    }
+  }
+  return count;
+}
+
+rational AudioWaveformTileStore::GetLevelRate(int level)
+{
+  rational r = AudioVisualWaveform::kMinimumSampleRate;
+  for (int i=0; i<level; i++) {
+    r *= 2;
+  }
+  return r;
+}
+
+int AudioWaveformTileStore::GetLevelForScale(double scale)
+{
+  // Find smallest level that has at least one sample per pixel (or the largest if there isn't one)
+  for (int i=0; i<GetLevelCount(); i++) {
+    if (GetLevelRate(i).toDouble() >= scale) {
+      return i;
+    }
+  }
+
+  return GetLevelCount() - 1;
+}
+
+qint16 AudioWaveformTileStore::Quantize(float f)
+{
+  return qBound(-32767, qRound(f * kQuantizeScale), 32767);
+}
+
+float AudioWaveformTileStore::Dequantize(qint16 i)
+{
+  return float(i) / kQuantizeScale;
+}
+
+QString AudioWaveformTileStore::GetTileFilename(const QString &dir, TileKey key)
+{
+  return QDir(dir).filePath(QStringLiteral("wave.%1").arg(key, 16, 16, QLatin1Char('0')));
+}
+
+AudioWaveformTileStore::Tile *AudioWaveformTileStore::GetTile(int level, int64_t index)
+{
+  TileKey key = MakeKey(level, index);
+
+  auto it = tiles_.find(key);
+  if (it != tiles_.end()) {
+    // Mark as most recently used
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return &it->second;
+  }
+
+  return InsertTile(key, ReadTileFile(directory_.isEmpty() ? QString() : GetTileFilename(directory_, key), cache_path_, channels_));
+}
+
+AudioWaveformTileStore::Tile *AudioWaveformTileStore::InsertTile(TileKey key, std::vector<qint16> &&data)
+{
+  Tile &t = tiles_[key];
+  t.data = std::move(data);
+  t.dirty = false;
+  t.revision = 0;
+
+  lru_.push_front({this, key});
+  t.lru = lru_.begin();
+  resident_bytes_ += tile_size_in_bytes();
+
+  return &t;
+}
+
+std::vector<qint16> AudioWaveformTileStore::ReadTileFile(const QString &filename, const QString &cache_path, int channels)
+{
+  size_t sz = GetTileSizeInBytes(channels);
+  std::vector<qint16> data(sz / sizeof(qint16), 0);
+
+  if (!filename.isEmpty()) {
+    // Tiles that don't exist on disk (or were written with another channel count) are silence
+    QFile f(filename);
+    if (f.size() == qint64(sz) && f.open(QFile::ReadOnly)) {
+      f.read(reinterpret_cast<char*>(data.data()), sz);
+      f.close();
+
+      if (DiskManager::instance()) {
+        QMetaObject::invokeMethod(DiskManager::instance(), "Accessed", Q_ARG(QString, cache_path), Q_ARG(QString, filename));
+      }
+    }
+  }
+
+  return data;
+}
+
+bool AudioWaveformTileStore::WriteTileFile(const QString &filename, const QString &cache_path, const std::vector<qint16> &data)
+{
+  QFile f(filename);
+  if (!f.open(QFile::WriteOnly)) {
+    return false;
+  }
+
+  f.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(qint16));
+  f.close();
+
+  RegisterFile(cache_path, filename);
+
+  return true;
+}
+
+void AudioWaveformTileStore::LoadTiles(const std::vector<TileKey> &keys)
+{
+  QMutexLocker locker(&lock_);
+
+  for (TileKey key : keys) {
+    if (tiles_.find(key) != tiles_.end()) {
+      loading_.erase(key);
+      continue;
+    }
+
+    QString dir = directory_;
+    QString cache_path = cache_path_;
+    int channels = channels_;
+    QString filename = dir.isEmpty() ? QString() : GetTileFilename(dir, key);
+
+    // Read without the lock, it's shared by every store and drawing shouldn't wait on disk
+    locker.unlock();
+    std::vector<qint16> data = ReadTileFile(filename, cache_path, channels);
+    locker.relock();
+
+    loading_.erase(key);
+
+    // Discard if the store changed or the tile was created while we were reading
+    if (directory_ == dir && channels_ == channels && tiles_.find(key) == tiles_.end()) {
+      InsertTile(key, std::move(data));
+    }
+  }
+
+  EvictTiles();
+}
+
+bool AudioWaveformTileStore::GetFileTimeRange(const QString &filename, TimeRange *range)
+{
+  QString name = QFileInfo(filename).fileName();
+
+  if (name == QStringLiteral("wave.index")) {
+    *range = TimeRange(0, RATIONAL_MAX);
+    return true;
+  }
+
+  if (!name.startsWith(QStringLiteral("wave."))) {
+    return false;
+  }
+
+  bool ok;
+  TileKey key = name.mid(5).toULongLong(&ok, 16);
+  if (!ok) {
+    return false;
+  }
+
+  rational rate = GetLevelRate(GetKeyLevel(key));
+  int64_t index = GetKeyIndex(key);
+  *range = TimeRange(rational(index * kTileFrames) / rate, rational((index + 1) * kTileFrames) / rate);
+
+  return true;
+}
+
+void AudioWaveformTileStore::ReadFrames(int level, int64_t start, int64_t count, AudioVisualWaveform::SamplePerChannel *out, bool load)
+{
+  int64_t read = 0;
+
+  while (read < count) {
+    int64_t frame = start + read;
+    int64_t tile_index = frame / kTileFrames;
+    int64_t offset_in_tile = frame % kTileFrames;
+    int64_t this_count = std::min(count - read, kTileFrames - offset_in_tile);
+
+    if (!load && tiles_.find(MakeKey(level, tile_index)) == tiles_.end()) {
+      read += this_count;
+      continue;
+    }
+
+    const qint16 *src = &GetTile(level, tile_index)->data[offset_in_tile * channels_ * 2];
+    AudioVisualWaveform::SamplePerChannel *dst = out + read * channels_;
+
+    for (int64_t i=0; i<this_count*channels_; i++) {
+      dst[i].min = Dequantize(src[i*2]);
+      dst[i].max = Dequantize(src[i*2+1]);
+    }
+
+    read += this_count;
+  }
+}
+
+void AudioWaveformTileStore::GetMissingTiles(int level, int64_t start, int64_t count, std::vector<TileKey> *missing) const
+{
+  for (int64_t i=start/kTileFrames; i<=(start+count-1)/kTileFrames; i++) {
+    TileKey key = MakeKey(level, i);
+
+    if (tiles_.find(key) == tiles_.end() && loading_.find(key) == loading_.end()) {
+      missing->push_back(key);
+    }
+  }
+}
+
+void AudioWaveformTileStore::RegisterFile(const QString &cache_path, const QString &filename)
+{
+  if (DiskManager::instance() && !cache_path.isEmpty()) {
+    QMetaObject::invokeMethod(DiskManager::instance(), "CreatedFile", Q_ARG(QString, cache_path), Q_ARG(QString, filename));
+  }
+}
+
+void AudioWaveformTileStore::FlushDirtyTiles()
+{
+  if (!IsDirectoryWritable()) {
+    return;
+  }
+
+  for (auto it=tiles_.begin(); it!=tiles_.end(); it++) {
+    Tile &t = it->second;
+
+    if (t.dirty && WriteTileFile(GetTileFilename(directory_, it->first), cache_path_, t.data)) {
+      t.dirty = false;
+    }
+  }
+}
+
+void AudioWaveformTileStore::DropAllTiles()
+{
+  for (auto it=tiles_.begin(); it!=tiles_.end(); it++) {
+    lru_.erase(it->second.lru);
+    resident_bytes_ -= tile_size_in_bytes();
+  }
+
+  tiles_.clear();
+}
+
+bool AudioWaveformTileStore::LoadIndex()
+{
+  if (directory_.isEmpty()) {
+    return false;
+  }
+
+  bool loaded = false;
+
+  QFile f(QDir(directory_).filePath(QStringLiteral("wave.index")));
+  if (f.open(QFile::ReadOnly)) {
+    QDataStream s(&f);
+
+    uint32_t version;
+    s >> version;
+
+    switch (version) {
+    case 1:
+    {
+      int channels, len_num, len_den;
+
+      s >> channels;
+      s >> len_num;
+      s >> len_den;
+
+      channels_ = channels;
+      length_ = rational(len_num, len_den);
+      loaded = true;
+      break;
+    }
+    }
+
+    f.close();
+  }
+
+  return loaded;
+}
+
+void AudioWaveformTileStore::SaveIndex()
+{
+  if (!IsDirectoryWritable()) {
+    return;
+  }
+
+  if (WriteIndexFile(directory_, cache_path_, channels_, length_)) {
+    index_dirty_ = false;
+  }
+}
+
+bool AudioWaveformTileStore::WriteIndexFile(const QString &dir, const QString &cache_path, int channels, const rational &length)
+{
+  QString filename = QDir(dir).filePath(QStringLiteral("wave.index"));
+  QFile f(filename);
+  if (!f.open(QFile::WriteOnly)) {
+    return false;
+  }
+
+  QDataStream s(&f);
+
+  uint32_t version = 1;
+  s << version;
+
+  s << channels;
+  s << length.numerator();
+  s << length.denominator();
+
+  f.close();
+
+  RegisterFile(cache_path, filename);
+
+  return true;
+}
+
+bool AudioWaveformTileStore::IsDirectoryWritable() const
+{
+  // Directory is only created once there's actually something to write into it
+  return !directory_.isEmpty() && FileFunctions::DirectoryIsValid(QDir(directory_));
+}
+
+void AudioWaveformTileStore::EvictTiles()
+{
+  // Drop least recently used tiles until we're back under budget. Dirty tiles only exist when
+  // they couldn't be written to disk, so those are kept.
+  for (auto it=lru_.end(); resident_bytes_ > kMemoryBudget && it!=lru_.begin(); ) {
+    it--;
+
+    AudioWaveformTileStore *store = it->store;
+    auto tile = store->tiles_.find(it->key);
+
+    if (tile->second.dirty) {
+      continue;
+    }
+
+    resident_bytes_ -= store->tile_size_in_bytes();
+    store->tiles_.erase(tile);
+    it = lru_.erase(it);
+  }
+}
+
+}
@@ -0,0 +1,243 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef AUDIOWAVEFORMTILESTORE_H
+#define AUDIOWAVEFORMTILESTORE_H
+
+#include <list>
+#include <QMutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "audio/audiovisualwaveform.h"
+#include "common/define.h"
+
+namespace olive {
+
+/**
+ * @brief Disk-backed, quantized storage for the mipmaps of an AudioWaveformCache
+ *
+ * Rather than holding every mipmap of every waveform in memory as floats, each mipmap is split
+ * into fixed-size tiles of 16-bit min/max pairs that are written to the cache directory in the
+ * background after they change. Only tiles that have recently been drawn or summarized are kept in memory, and
+ * the total size of those is bounded across all stores by kMemoryBudget, so memory usage stays
+ * flat regardless of how much audio a project contains.
+ *
+ * Tile files are registered with the DiskManager like any other cache file, so they count towards
+ * the cache size limit and can be deleted by it at any time. A deleted tile simply reads as
+ * silence, AudioWaveformCache invalidates the range it covered so it gets rendered again.
+ *
+ * If no valid directory has been set, tiles cannot be evicted and simply stay in memory.
+ */
+class AudioWaveformTileStore
+{
+public:
+  AudioWaveformTileStore();
+
+  ~AudioWaveformTileStore();
+
+  DISABLE_COPY_MOVE(AudioWaveformTileStore)
+
+  using TileKey = uint64_t;
+
+  /**
+   * @brief Set the directory tiles are stored in
+   *
+   * `cache_path` is the disk cache folder `dir` is inside of, which tiles are registered with.
+   *
+   * Tiles that were only ever held in memory are written into the new directory. Returns true if
+   * the store previously held data in another directory that isn't available in the new one, in
+   * which case the store is now empty.
+   */
+  bool SetDirectory(const QString &cache_path, const QString &dir);
+
+  int channel_count() const { return channels_; }
+  void set_channel_count(int channels);
+
+  const rational &length() const { return length_; }
+
+  /**
+   * @brief Equivalent to AudioVisualWaveform::OverwriteSums()
+   *
+   * Only changes the tiles in memory, call WriteDirtyTiles() to persist them.
+   */
+  void OverwriteSums(const AudioVisualWaveform &sums, const rational &dest, const rational &offset, const rational &length);
+
+  /**
+   * @brief Write tiles and the index changed by OverwriteSums() to disk
+   *
+   * Intended to be called from a background thread. Changed tiles stay in memory until they've
+   * been written.
+   */
+  void WriteDirtyTiles();
+
+  /**
+   * @brief Equivalent to AudioVisualWaveform::GetSummaryFromTime()
+   */
+  AudioVisualWaveform::Sample GetSummaryFromTime(const rational &start, const rational &length);
+
+  /**
+   * @brief Equivalent to AudioVisualWaveform::DrawWaveform()
+   *
+   * Only the tiles covering the part of `rect` that is inside the painter's viewport are used.
+   * This never touches the disk: anything covered by tiles that aren't in memory is skipped and
+   * those tiles are appended to `missing` so they can be loaded with LoadTiles().
+   */
+  void Draw(QPainter *painter, const QRect &rect, double scale, const rational &start_time, std::vector<TileKey> *missing);
+
+  /**
+   * @brief Read tiles from disk into memory
+   *
+   * Intended to be called from a background thread with the tiles Draw() reported as missing.
+   */
+  void LoadTiles(const std::vector<TileKey> &keys);
+
+  /**
+   * @brief Get the time range covered by a file written by a store
+   *
+   * Returns false if `filename` isn't a tile store file. The index covers the whole waveform.
+   */
+  static bool GetFileTimeRange(const QString &filename, TimeRange *range);
+
+  /**
+   * @brief Number of frames (one min/max pair per channel) in each tile
+   */
+  static const int64_t kTileFrames = 4096;
+
+  /**
+   * @brief Maximum size in bytes of all tiles held in memory across every store
+   */
+  static const size_t kMemoryBudget = 64 * 1024 * 1024;
+
+private:
+  struct Tile;
+
+  struct LRUEntry
+  {
+    AudioWaveformTileStore *store;
+    TileKey key;
+  };
+
+  struct Tile
+  {
+    std::vector<qint16> data;
+    bool dirty;
+    uint64_t revision;
+    std::list<LRUEntry>::iterator lru;
+  };
+
+  static TileKey MakeKey(int level, int64_t index)
+  {
+    return (TileKey(level) << 48) | TileKey(index);
+  }
+
+  static int GetKeyLevel(TileKey key)
+  {
+    return int(key >> 48);
+  }
+
+  static int64_t GetKeyIndex(TileKey key)
+  {
+    return int64_t(key & ((TileKey(1) << 48) - 1));
+  }
+
+  static int GetLevelCount();
+  static rational GetLevelRate(int level);
+  static int GetLevelForScale(double scale);
+
+  static qint16 Quantize(float f);
+  static float Dequantize(qint16 i);
+
+  static QString GetTileFilename(const QString &dir, TileKey key);
+
+  Tile *GetTile(int level, int64_t index);
+
+  Tile *InsertTile(TileKey key, std::vector<qint16> &&data);
+
+  /**
+   * @brief Static so it can run without the lock, on values copied while holding it
+   */
+  static std::vector<qint16> ReadTileFile(const QString &filename, const QString &cache_path, int channels);
+
+  static bool WriteTileFile(const QString &filename, const QString &cache_path, const std::vector<qint16> &data);
+
+  /**
+   * @brief Copy frames out of the tiles
+   *
+   * If `load` is false, tiles that aren't in memory are skipped rather than read from disk.
+   */
+  void ReadFrames(int level, int64_t start, int64_t count, AudioVisualWaveform::SamplePerChannel *out, bool load = true);
+
+  void GetMissingTiles(int level, int64_t start, int64_t count, std::vector<TileKey> *missing) const;
+
+  static void RegisterFile(const QString &cache_path, const QString &filename);
+
+  void FlushDirtyTiles();
+
+  void DropAllTiles();
+
+  bool LoadIndex();
+  void SaveIndex();
+  static bool WriteIndexFile(const QString &dir, const QString &cache_path, int channels, const rational &length);
+
+  bool IsDirectoryWritable() const;
+
+  static void EvictTiles();
+
+  static size_t GetTileSizeInBytes(int channels)
+  {
+    return kTileFrames * channels * 2 * sizeof(qint16);
+  }
+
+  size_t tile_size_in_bytes() const
+  {
+    return GetTileSizeInBytes(channels_);
+  }
+
+  QString cache_path_;
+
+  QString directory_;
+
+  int channels_;
+
+  rational length_;
+
+  std::unordered_map<TileKey, Tile> tiles_;
+
+  std::unordered_set<TileKey> loading_;
+
+  bool index_dirty_;
+
+  /**
+   * @brief Held (before lock_) for as long as anything is writing this store's files
+   *
+   * Keeps a background write from landing after, and overwriting, a newer synchronous one.
+   */
+  QMutex write_lock_;
+
+  static QMutex lock_;
+  static std::list<LRUEntry> lru_;
+  static size_t resident_bytes_;
+
+};
+
+}
+
+#endif // AUDIOWAVEFORMTILESTORE_H
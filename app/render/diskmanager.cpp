@@ -242,6 +242,12 @@ void DiskCacheFolder::CreatedFile(const QString &filename)
 {
   qint64 file_size = QFile(filename).size();
 
+  // Some caches rewrite the same file, only count the difference
+  auto existing = disk_data_.find(filename);
+  if (existing != disk_data_.end()) {
+    consumption_ -= existing->file_size;
+  }
+
   disk_data_.insert(filename, {file_size, QDateTime::currentMSecsSinceEpoch()});
 
   consumption_ += file_size;
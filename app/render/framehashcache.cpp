@@ -40,7 +40,8 @@ namespace olive {
 #define super PlaybackCache
 
 FrameHashCache::FrameHashCache(QObject *parent) :
-  super(parent)
+  super(parent),
+  generation_(0)
 {
   if (DiskManager::instance()) {
     connect(DiskManager::instance(), &DiskManager::DeletedFrame, this, &FrameHashCache::HashDeleted);
@@ -64,14 +65,14 @@ void FrameHashCache::ValidateTime(const rational &time)
   Validate(TimeRange(time, time + timebase_));
 }
 
-QString FrameHashCache::GetValidCacheFilename(const rational &time) const
+QString FrameHashCache::GetValidCacheFilename(const rational &time, bool mark_accessed) const
 {
   if (IsFrameCached(time)) {
-    return CachePathName(time);
+    return CachePathName(time, mark_accessed);
   } else if (!GetPassthroughs().empty()) {
     for (const Passthrough &p : GetPassthroughs()) {
       if (p.Contains(time)) {
-        return CachePathName(GetCacheDirectory(), p.cache, time, timebase_);
+        return CachePathName(GetCacheDirectory(), p.cache, time, timebase_, mark_accessed);
       }
     }
   }
@@ -242,6 +243,13 @@ FramePtr FrameHashCache::LoadCacheFrame(const QString &fn)
   return frame;
 }
 
+void FrameHashCache::InvalidateEvent(const TimeRange &range)
+{
+  generation_++;
+
+  super::InvalidateEvent(range);
+}
+
 void FrameHashCache::SetPassthrough(PlaybackCache *cache)
 {
   super::SetPassthrough(cache);
@@ -312,26 +320,26 @@ QString FrameHashCache::CachePathName(const int64_t &time) const
   return CachePathName(GetCacheDirectory(), GetUuid(), time);
 }
 
-QString FrameHashCache::CachePathName(const rational &time) const
+QString FrameHashCache::CachePathName(const rational &time, bool mark_accessed) const
 {
-  return CachePathName(GetCacheDirectory(), GetUuid(), time, timebase_);
+  return CachePathName(GetCacheDirectory(), GetUuid(), time, timebase_, mark_accessed);
 }
 
-QString FrameHashCache::CachePathName(const QString &cache_path, const QUuid &cache_id, const int64_t &time)
+QString FrameHashCache::CachePathName(const QString &cache_path, const QUuid &cache_id, const int64_t &time, bool mark_accessed)
 {
   QString filename = GetThisCacheDirectory(cache_path, cache_id).filePath(QString::number(time));
 
   // Register that in some way this hash has been accessed
-  if (DiskManager::instance()) {
+  if (mark_accessed && DiskManager::instance()) {
     QMetaObject::invokeMethod(DiskManager::instance(), "Accessed", Q_ARG(QString, cache_path), Q_ARG(QString, filename));
   }
 
   return filename;
 }
 
-QString FrameHashCache::CachePathName(const QString &cache_path, const QUuid &cache_id, const rational &time, const rational &tb)
+QString FrameHashCache::CachePathName(const QString &cache_path, const QUuid &cache_id, const rational &time, const rational &tb, bool mark_accessed)
 {
-  return CachePathName(cache_path, cache_id, Timecode::time_to_timestamp(time, tb, Timecode::kRound));
+  return CachePathName(cache_path, cache_id, Timecode::time_to_timestamp(time, tb, Timecode::kRound), mark_accessed);
 }
 
 bool FrameHashCache::SaveCacheFrame(const QString &filename, const FramePtr frame)
@@ -45,7 +45,14 @@ public:
     return GetValidatedRanges().contains(time);
   }
 
-  QString GetValidCacheFilename(const rational &time) const;
+  /**
+   * @brief Return the filename of the cached frame at this time, or an empty string if none
+   *
+   * By default this registers an access with the DiskManager so the frame isn't evicted. Callers
+   * that keep their own in-memory copy (e.g. timeline thumbnails) can skip that on every query and
+   * report accesses only when they actually read the file.
+   */
+  QString GetValidCacheFilename(const rational &time, bool mark_accessed = true) const;
 
   static bool SaveCacheFrame(const QString& filename, FramePtr frame);
   bool SaveCacheFrame(const int64_t &time, FramePtr frame) const;
@@ -57,7 +64,17 @@ public:
 
   virtual void SetPassthrough(PlaybackCache *cache) override;
 
+  /**
+   * @brief Incremented whenever any range of this cache is invalidated
+   *
+   * Re-rendered frames are written to the same filenames, so in-memory copies keyed by filename
+   * should include this in their key to notice that the file has changed.
+   */
+  quint64 GetGeneration() const { return generation_; }
+
 protected:
+  virtual void InvalidateEvent(const TimeRange &range) override;
+
   virtual void LoadStateEvent(QDataStream &stream) override;
   virtual void SaveStateEvent(QDataStream &stream) override;
 
@@ -69,13 +86,15 @@ private:
    * @brief Return the path of the cached image at this time
    */
   QString CachePathName(const int64_t &time) const;
-  QString CachePathName(const rational &time) const;
+  QString CachePathName(const rational &time, bool mark_accessed = true) const;
 
-  static QString CachePathName(const QString& cache_path, const QUuid &cache_id, const int64_t &time);
-  static QString CachePathName(const QString& cache_path, const QUuid &cache_id, const rational &time, const rational &tb);
+  static QString CachePathName(const QString& cache_path, const QUuid &cache_id, const int64_t &time, bool mark_accessed = true);
+  static QString CachePathName(const QString& cache_path, const QUuid &cache_id, const rational &time, const rational &tb, bool mark_accessed = true);
 
   rational timebase_;
 
+  quint64 generation_;
+
 private slots:
   void HashDeleted(const QString &path, const QString &filename);
 
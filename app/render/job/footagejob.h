@@ -29,7 +29,8 @@ class FootageJob : public AcceleratedJob
 {
 public:
   FootageJob() :
-    type_(Track::kNone)
+    type_(Track::kNone),
+    proxy_divider_(1)
   {
   }
 
@@ -39,7 +40,8 @@ public:
     filename_(filename),
     type_(type),
     length_(length),
-    loop_mode_(loop_mode)
+    loop_mode_(loop_mode),
+    proxy_divider_(1)
   {
   }
 
@@ -98,6 +100,28 @@ public:
     length_ = length;
   }
 
+  /**
+   * @brief Reduced resolution file that may be decoded instead of filename() for previews
+   */
+  const QString& proxy_filename() const
+  {
+    return proxy_filename_;
+  }
+
+  /**
+   * @brief Divider the proxy was made at relative to the original
+   */
+  int proxy_divider() const
+  {
+    return proxy_divider_;
+  }
+
+  void set_proxy(const QString& filename, int divider)
+  {
+    proxy_filename_ = filename;
+    proxy_divider_ = divider;
+  }
+
   const TimeRange &time() const { return time_; }
 
   LoopMode loop_mode() const { return loop_mode_; }
@@ -122,6 +146,10 @@ private:
 
   LoopMode loop_mode_;
 
+  QString proxy_filename_;
+
+  int proxy_divider_;
+
 };
 
 }
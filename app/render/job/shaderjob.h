@@ -29,9 +29,21 @@
 
 namespace olive {
 
+class Node;
+
 class ShaderJob : public AcceleratedJob
 {
 public:
+  /**
+   * @brief One of the original jobs that was merged into a fused job, innermost first
+   */
+  struct FusedStage
+  {
+    const Node *node;
+    QString shader_id;
+    QString fusable_input;
+  };
+
   ShaderJob()
   {
     iterations_ = 1;
@@ -105,6 +117,43 @@ public:
     return vertex_overrides_;
   }
 
+  /**
+   * @brief Declare this shader as per-pixel with respect to a texture input
+   *
+   * A fusable shader uses the default vertex shader, only samples `input` through texture() once per
+   * output pixel (at ove_texcoord or a coordinate derived from it), and outputs at the same size as
+   * that input. The traverser may then merge it with the shader job feeding `input` into one pass.
+   */
+  void SetFusableInput(const NodeInput& input)
+  {
+    SetFusableInput(input.input());
+  }
+
+  void SetFusableInput(const QString& input)
+  {
+    fusable_input_ = input;
+  }
+
+  const QString& GetFusableInput() const
+  {
+    return fusable_input_;
+  }
+
+  bool IsFused() const
+  {
+    return !fused_stages_.isEmpty();
+  }
+
+  const QVector<FusedStage>& GetFusedStages() const
+  {
+    return fused_stages_;
+  }
+
+  void SetFusedStages(const QVector<FusedStage>& stages)
+  {
+    fused_stages_ = stages;
+  }
+
 private:
   QString shader_id_;
 
@@ -116,6 +165,10 @@ private:
 
   QVector<float> vertex_overrides_;
 
+  QString fusable_input_;
+
+  QVector<FusedStage> fused_stages_;
+
 };
 
 }
@@ -92,8 +92,17 @@ RenderTicketPtr PreviewAutoCacher::GetSingleFrame(Node *n, ViewerOutput *viewer,
 
 RenderTicketPtr PreviewAutoCacher::GetRangeOfAudio(ViewerOutput *viewer, TimeRange range)
 {
+  bool realtime = OLIVE_CONFIG("RealtimeAudioPlayback").toBool();
+
+  if (realtime && copier_->HasUpdatesInQueue()
+      && running_audio_tasks_.isEmpty() && running_video_tasks_.isEmpty()) {
+    // Bring the copied graph up to date now so that recent edits are heard in this buffer rather
+    // than whenever the cacher next gets around to it
+    copier_->ProcessUpdateQueue();
+  }
+
   Node *copy = copier_->GetCopy(viewer->GetConnectedSampleOutput());
-  return RenderAudio(copy, viewer, range, nullptr);
+  return RenderAudio(copy, viewer, range, nullptr, realtime);
 }
 
 void PreviewAutoCacher::ClearSingleFrameRenders()
@@ -627,7 +636,7 @@ RenderTicketWatcher* PreviewAutoCacher::RenderFrame(Node *node, ViewerOutput *co
   return watcher;
 }
 
-RenderTicketPtr PreviewAutoCacher::RenderAudio(Node *node, ViewerOutput *context, const TimeRange &r, PlaybackCache *cache)
+RenderTicketPtr PreviewAutoCacher::RenderAudio(Node *node, ViewerOutput *context, const TimeRange &r, PlaybackCache *cache, bool realtime)
 {
   RenderTicketWatcher* watcher = new RenderTicketWatcher();
   watcher->setProperty("job", QVariant::fromValue(copier_->GetLastUpdateTime()));
@@ -647,6 +656,7 @@ RenderTicketPtr PreviewAutoCacher::RenderAudio(Node *node, ViewerOutput *context
 
   rap.generate_waveforms = dynamic_cast<AudioWaveformCache*>(cache);
   rap.clamp = false;
+  rap.realtime = realtime;
 
   RenderTicketPtr ticket = RenderManager::instance()->RenderAudio(rap);
   watcher->SetTicket(ticket);
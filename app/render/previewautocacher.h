@@ -51,6 +51,13 @@ public:
   RenderTicketPtr GetSingleFrame(ViewerOutput *viewer, const rational& t, bool dry = false);
   RenderTicketPtr GetSingleFrame(Node *n, ViewerOutput *viewer, const rational& t, bool dry = false);
 
+  /**
+   * @brief Render a range of audio for immediate playback
+   *
+   * If realtime audio playback is enabled, this audio is mixed directly from the graph on a
+   * dedicated high priority thread rather than waiting behind the jobs that fill the
+   * AudioPlaybackCache.
+   */
   RenderTicketPtr GetRangeOfAudio(ViewerOutput *viewer, TimeRange range);
 
   void ClearSingleFrameRenders();
@@ -111,7 +118,7 @@ private:
 
   RenderTicketWatcher *RenderFrame(Node *node, ViewerOutput *context, const rational &time, PlaybackCache *cache, bool dry);
 
-  RenderTicketPtr RenderAudio(Node *node, ViewerOutput *context, const TimeRange &range, PlaybackCache *cache);
+  RenderTicketPtr RenderAudio(Node *node, ViewerOutput *context, const TimeRange &range, PlaybackCache *cache, bool realtime = false);
 
   void ConnectToNodeCache(Node *node);
   void DisconnectFromNodeCache(Node *node);
@@ -40,6 +40,9 @@ void ProjectCopier::SetProject(Project *project)
     created_nodes_.clear();
     copy_map_.clear();
     graph_update_queue_.clear();
+    queued_value_changes_.clear();
+    queued_value_hint_changes_.clear();
+    queued_setting_changes_.clear();
 
     disconnect(original_, &Project::NodeAdded, this, &ProjectCopier::QueueNodeAdd);
     disconnect(original_, &Project::NodeRemoved, this, &ProjectCopier::QueueNodeRemove);
@@ -89,6 +92,11 @@ void ProjectCopier::SetProject(Project *project)
 
 void ProjectCopier::ProcessUpdateQueue()
 {
+  // The whole queue is drained below, so nothing can be coalesced into it anymore
+  queued_value_changes_.clear();
+  queued_value_hint_changes_.clear();
+  queued_setting_changes_.clear();
+
   // Iterate everything that happened to the graph and do the same thing on our end
   while (!graph_update_queue_.empty()) {
     QueuedJob job = graph_update_queue_.front();
@@ -147,7 +155,7 @@ void ProjectCopier::DoNodeAdd(Node *node)
   InsertIntoCopyMap(node, copy);
 
   // Keep track of our nodes
-  created_nodes_.append(copy);
+  created_nodes_.insert(copy);
 }
 
 void ProjectCopier::DoNodeRemove(Node *node)
@@ -159,7 +167,7 @@ void ProjectCopier::DoNodeRemove(Node *node)
   emit RemovedNode(node);
 
   // Remove from created list
-  created_nodes_.removeOne(copy);
+  created_nodes_.remove(copy);
 
   // Delete it
   delete copy;
@@ -249,29 +257,39 @@ void ProjectCopier::QueueEdgeRemove(Node *output, const NodeInput &input)
   UpdateGraphChangeValue();
 }
 
-void ProjectCopier::QueueValueChange(const NodeInput &input)
+void ProjectCopier::QueueValueChange(const NodeInput& input)
 {
-  /*for (auto it = graph_update_queue_.begin(); it != graph_update_queue_.end(); ) {
-    if (it->type == QueuedJob::kValueChanged && it->input == input) {
-      it = graph_update_queue_.erase(it);
-    } else {
-      it++;
-    }
-  }*/
+  // DoValueChange copies whatever the value is at the time it runs, so an already queued job for
+  // this input will pick up this change too
+  if (!queued_value_changes_.contains(input)) {
+    graph_update_queue_.push_back({QueuedJob::kValueChanged, nullptr, input, nullptr, QString(), QString()});
+    queued_value_changes_.insert(input, std::prev(graph_update_queue_.end()));
+  }
 
-  graph_update_queue_.push_back({QueuedJob::kValueChanged, nullptr, input, nullptr, QString(), QString()});
   UpdateGraphChangeValue();
 }
 
 void ProjectCopier::QueueValueHintChange(const NodeInput &input)
 {
-  graph_update_queue_.push_back({QueuedJob::kValueHintChanged, nullptr, input, nullptr, QString(), QString()});
+  if (!queued_value_hint_changes_.contains(input)) {
+    graph_update_queue_.push_back({QueuedJob::kValueHintChanged, nullptr, input, nullptr, QString(), QString()});
+    queued_value_hint_changes_.insert(input, std::prev(graph_update_queue_.end()));
+  }
+
   UpdateGraphChangeValue();
 }
 
 void ProjectCopier::QueueProjectSettingChange(const QString &key, const QString &value)
 {
-  graph_update_queue_.push_back({QueuedJob::kProjectSettingChanged, nullptr, NodeInput(), nullptr, key, value});
+  auto queued = queued_setting_changes_.find(key);
+  if (queued == queued_setting_changes_.end()) {
+    graph_update_queue_.push_back({QueuedJob::kProjectSettingChanged, nullptr, NodeInput(), nullptr, key, value});
+    queued_setting_changes_.insert(key, std::prev(graph_update_queue_.end()));
+  } else {
+    // Setting jobs carry their value, so update the queued one instead
+    queued.value()->value = value;
+  }
+
   UpdateGraphChangeValue();
 }
 
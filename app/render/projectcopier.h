@@ -107,7 +107,19 @@ private:
   std::list<QueuedJob> graph_update_queue_;
   QHash<Node*, Node*> copy_map_;
   QHash<Project*, Project*> graph_map_;
-  QVector<Node*> created_nodes_;
+  QSet<Node*> created_nodes_;
+
+  /**
+   * @brief Jobs already in the queue that can absorb later changes to the same target
+   *
+   * Value changes are applied by copying the original's current value, so a second change to an
+   * input that's still queued doesn't need its own job. This keeps the replay proportional to the
+   * number of things that changed rather than the number of edits (e.g. every step of a slider
+   * drag).
+   */
+  QHash<NodeInput, std::list<QueuedJob>::iterator> queued_value_changes_;
+  QHash<NodeInput, std::list<QueuedJob>::iterator> queued_value_hint_changes_;
+  QHash<QString, std::list<QueuedJob>::iterator> queued_setting_changes_;
 
   JobTime graph_changed_time_;
   JobTime last_update_time_;
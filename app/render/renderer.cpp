@@ -25,10 +25,17 @@
 #include <QTimer>
 #include <QVector2D>
 
+#include "config/config.h"
+
 namespace olive {
 
 Renderer::Renderer(QObject *parent) :
-  QObject(parent)
+  QObject(parent),
+  texture_pooled_bytes_(0),
+  texture_allocated_bytes_(0),
+  texture_pool_hits_(0),
+  texture_pool_misses_(0),
+  texture_pool_evictions_(0)
 {
 }
 
@@ -37,16 +44,30 @@ TexturePtr Renderer::CreateTexture(const VideoParams &params, const void *data,
   QVariant v;
 
   if (USE_TEXTURE_CACHE) {
+    TextureDescriptor desc = TextureDescriptor::FromParams(params);
+
     QMutexLocker locker(&texture_cache_lock_);
-    for (auto it=texture_cache_.begin(); it!=texture_cache_.end(); it++) {
-      if (it->width == params.effective_width()
-          && it->height == params.effective_height()
-          && it->depth == params.effective_depth()
-          && it->format == params.format()
-          && it->channel_count == params.channel_count()) {
-        v = it->handle;
-        texture_cache_.erase(it);
-        break;
+
+    auto bucket = texture_buckets_.find(desc);
+    if (bucket != texture_buckets_.end()) {
+      // Take the most recently released texture, it's the most likely to still be resident
+      TextureLRU::iterator it = bucket->back();
+      bucket->pop_back();
+      if (bucket->empty()) {
+        texture_buckets_.erase(bucket);
+      }
+
+      v = it->handle;
+      texture_pooled_bytes_ -= desc.GetByteCount();
+      texture_cache_.erase(it);
+      texture_pool_hits_++;
+    } else {
+      // A new texture will be allocated, make room for it within the budget first
+      texture_pool_misses_++;
+      texture_allocated_bytes_ += desc.GetByteCount();
+
+      if (QThread::currentThread() == this->thread()) {
+        EvictTexturesOverBudget();
       }
     }
   }
@@ -81,14 +102,12 @@ void Renderer::DestroyTexture(Texture *texture)
     //
     //       Presumably Vulkan would not have this issue because it allows for application-wide
     //       instances and multithreading.
+    TextureDescriptor desc = TextureDescriptor::FromParams(texture->params());
+
     texture_cache_lock_.lock();
-    texture_cache_.push_back({texture->params().effective_width(),
-                              texture->params().effective_height(),
-                              texture->params().effective_depth(),
-                              texture->params().format(),
-                              texture->params().channel_count(),
-                              texture->id(),
-                              QDateTime::currentMSecsSinceEpoch()});
+    texture_cache_.push_back({desc, texture->id(), QDateTime::currentMSecsSinceEpoch()});
+    texture_buckets_[desc].push_back(std::prev(texture_cache_.end()));
+    texture_pooled_bytes_ += desc.GetByteCount();
     texture_cache_lock_.unlock();
 
     if (QThread::currentThread() == this->thread()) {
@@ -148,6 +167,9 @@ void Renderer::Destroy()
     DestroyNativeTexture(it->handle);
   }
   texture_cache_.clear();
+  texture_buckets_.clear();
+  texture_allocated_bytes_ -= texture_pooled_bytes_;
+  texture_pooled_bytes_ = 0;
 
   DestroyInternal();
 }
@@ -274,14 +296,58 @@ void Renderer::ClearOldTextures()
 {
   QMutexLocker locker(&texture_cache_lock_);
 
-  for (auto it=texture_cache_.begin(); it!=texture_cache_.end(); ) {
-    if (it->accessed < QDateTime::currentMSecsSinceEpoch() - MAX_TEXTURE_LIFE) {
-      DestroyNativeTexture(it->handle);
-      it = texture_cache_.erase(it);
-    } else {
-      it++;
-    }
+  // The LRU list is in release order, so everything old enough to destroy is at the front
+  qint64 threshold = QDateTime::currentMSecsSinceEpoch() - MAX_TEXTURE_LIFE;
+  while (!texture_cache_.empty() && texture_cache_.front().accessed < threshold) {
+    DestroyPooledTexture(texture_cache_.begin());
+  }
+
+  EvictTexturesOverBudget();
+}
+
+void Renderer::DestroyPooledTexture(TextureLRU::iterator it)
+{
+  // Being the oldest in the pool, this texture is also the oldest in its bucket
+  auto bucket = texture_buckets_.find(it->desc);
+  bucket->pop_front();
+  if (bucket->empty()) {
+    texture_buckets_.erase(bucket);
   }
+
+  qint64 sz = it->desc.GetByteCount();
+  texture_pooled_bytes_ -= sz;
+  texture_allocated_bytes_ -= sz;
+  texture_pool_evictions_++;
+
+  DestroyNativeTexture(it->handle);
+  texture_cache_.erase(it);
+}
+
+void Renderer::EvictTexturesOverBudget()
+{
+  // Assumes texture_cache_lock_ is held. Only idle textures can be freed, so textures in use may still
+  // push the total over budget.
+  qint64 budget = qint64(OLIVE_CONFIG("TexturePoolBudget").toInt()) * 1024 * 1024;
+
+  while (!texture_cache_.empty() && texture_allocated_bytes_ > budget) {
+    DestroyPooledTexture(texture_cache_.begin());
+  }
+}
+
+Renderer::TexturePoolStatistics Renderer::GetTexturePoolStatistics()
+{
+  QMutexLocker locker(&texture_cache_lock_);
+
+  TexturePoolStatistics s;
+
+  s.pooled_count = int(texture_cache_.size());
+  s.pooled_bytes = texture_pooled_bytes_;
+  s.allocated_bytes = texture_allocated_bytes_;
+  s.hits = texture_pool_hits_;
+  s.misses = texture_pool_misses_;
+  s.evictions = texture_pool_evictions_;
+
+  return s;
 }
 
 void Renderer::BlitColorManaged(const ColorTransformJob &color_job, Texture *destination, const VideoParams &params)
@@ -21,6 +21,8 @@
 #ifndef RENDERCONTEXT_H
 #define RENDERCONTEXT_H
 
+#include <deque>
+#include <list>
 #include <QMutex>
 #include <QObject>
 #include <QVariant>
@@ -78,6 +80,22 @@ public:
 
   QVariant GetDefaultShader();
 
+  struct TexturePoolStatistics
+  {
+    /// Idle textures waiting to be reused
+    int pooled_count;
+    qint64 pooled_bytes;
+
+    /// Every texture the pool has created and not yet destroyed, idle or in use
+    qint64 allocated_bytes;
+
+    qint64 hits;
+    qint64 misses;
+    qint64 evictions;
+  };
+
+  TexturePoolStatistics GetTexturePoolStatistics();
+
   void Destroy();
 
   virtual void PostDestroy() = 0;
@@ -133,20 +151,64 @@ private:
 
   QHash<QString, ColorContext> color_cache_;
 
-  struct CachedTexture
+  struct TextureDescriptor
   {
     int width;
     int height;
     int depth;
     PixelFormat format;
     int channel_count;
+
+    static TextureDescriptor FromParams(const VideoParams &p)
+    {
+      return {p.effective_width(), p.effective_height(), p.effective_depth(), p.format(), p.channel_count()};
+    }
+
+    qint64 GetByteCount() const
+    {
+      return qint64(width) * qint64(height) * qint64(depth) * VideoParams::GetBytesPerPixel(format, channel_count);
+    }
+
+    bool operator==(const TextureDescriptor &rhs) const
+    {
+      return width == rhs.width && height == rhs.height && depth == rhs.depth
+          && format == rhs.format && channel_count == rhs.channel_count;
+    }
+  };
+
+  friend uint qHash(const TextureDescriptor &d, uint seed = 0)
+  {
+    return ::qHash(d.width, seed) ^ ::qHash(d.height << 16, seed) ^ ::qHash(d.depth, seed)
+        ^ ::qHash(int(d.format) << 8, seed) ^ ::qHash(d.channel_count << 24, seed);
+  }
+
+  struct CachedTexture
+  {
+    TextureDescriptor desc;
     QVariant handle;
     qint64 accessed;
   };
 
+  using TextureLRU = std::list<CachedTexture>;
+
+  void DestroyPooledTexture(TextureLRU::iterator it);
+
+  void EvictTexturesOverBudget();
+
   static const int MAX_TEXTURE_LIFE = 5000;
   static const bool USE_TEXTURE_CACHE = true;
-  std::list<CachedTexture> texture_cache_;
+
+  // Idle textures, least recently released first
+  TextureLRU texture_cache_;
+
+  // The same textures bucketed by descriptor, each bucket in release order, so acquiring and releasing are O(1)
+  QHash<TextureDescriptor, std::deque<TextureLRU::iterator> > texture_buckets_;
+
+  qint64 texture_pooled_bytes_;
+  qint64 texture_allocated_bytes_;
+  qint64 texture_pool_hits_;
+  qint64 texture_pool_misses_;
+  qint64 texture_pool_evictions_;
 
   QMutex color_cache_mutex_;
 
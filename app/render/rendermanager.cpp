@@ -55,6 +55,7 @@ RenderManager::RenderManager(QObject *parent) :
     video_thread_ = CreateThread(context_);
     dry_run_thread_ = CreateThread();
     audio_thread_ = CreateThread();
+    realtime_audio_thread_ = CreateThread(nullptr, QThread::TimeCriticalPriority);
 
     waveform_threads_.resize(QThread::idealThreadCount());
     for (size_t i=0; i<waveform_threads_.size(); i++) {
@@ -86,11 +87,11 @@ RenderManager::~RenderManager()
   }
 }
 
-RenderThread *RenderManager::CreateThread(Renderer *renderer)
+RenderThread *RenderManager::CreateThread(Renderer *renderer, QThread::Priority priority)
 {
   auto t = new RenderThread(renderer, decoder_cache_, shader_cache_, this);
   render_threads_.push_back(t);
-  t->start(QThread::IdlePriority);
+  t->start(priority);
   return t;
 }
 
@@ -146,6 +147,8 @@ RenderTicketPtr RenderManager::RenderAudio(const RenderAudioParams &params)
     RenderThread *thread = waveform_threads_[thread_index];
     thread->AddTicket(ticket);
     last_waveform_thread_++;
+  } else if (params.realtime) {
+    realtime_audio_thread_->AddTicket(ticket);
   } else {
     audio_thread_->AddTicket(ticket);
   }
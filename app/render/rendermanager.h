@@ -169,6 +169,7 @@ public:
       audio_params = aparam;
       generate_waveforms = false;
       clamp = true;
+      realtime = false;
       mode = m;
     }
 
@@ -177,6 +178,15 @@ public:
     AudioParams audio_params;
     bool generate_waveforms;
     bool clamp;
+
+    /**
+     * @brief Whether this audio is needed immediately for playback
+     *
+     * Realtime audio is mixed on its own high priority thread so that it never waits behind
+     * background cache jobs.
+     */
+    bool realtime;
+
     RenderMode::Mode mode;
   };
 
@@ -221,7 +231,7 @@ private:
 
   virtual ~RenderManager() override;
 
-  RenderThread *CreateThread(Renderer *renderer = nullptr);
+  RenderThread *CreateThread(Renderer *renderer = nullptr, QThread::Priority priority = QThread::IdlePriority);
 
   static RenderManager* instance_;
 
@@ -243,6 +253,7 @@ private:
   RenderThread *video_thread_;
   RenderThread *dry_run_thread_;
   RenderThread *audio_thread_;
+  RenderThread *realtime_audio_thread_;
 
   std::vector<RenderThread *> waveform_threads_;
   size_t last_waveform_thread_;
@@ -30,6 +30,7 @@
 #include "node/block/transition/transition.h"
 #include "node/project.h"
 #include "rendermanager.h"
+#include "shaderfusion.h"
 
 namespace olive {
 
@@ -282,6 +283,13 @@ DecoderPtr RenderProcessor::ResolveDecoderFromInput(const QString& decoder_id, c
     if (!dec->Open(stream)) {
       qWarning() << "Failed to open decoder for" << stream.filename()
                  << "::" << stream.stream();
+
+      // Don't hand this closed decoder to later frames, so they try again (or fall back) themselves
+      locker.relock();
+      if (decoder_cache_->value(stream).decoder == dec) {
+        decoder_cache_->remove(stream);
+      }
+
       return nullptr;
     }
 
@@ -347,26 +355,47 @@ void RenderProcessor::ProcessVideoFootage(TexturePtr destination, const FootageJ
 
   QString decoder_id = stream->decoder();
 
+  // Proxies are only for previews, exports always decode the original
+  bool use_proxy = !stream->proxy_filename().isEmpty()
+      && static_cast<RenderMode::Mode>(ticket_->property("mode").toInt()) == RenderMode::kOffline;
+
+  if (use_proxy) {
+    // Proxies are always written by FFmpeg with the video as the only stream
+    default_codec_stream = Decoder::CodecStream(stream->proxy_filename(), 0, GetCurrentBlock());
+    decoder_id = QStringLiteral("ffmpeg");
+  }
+
   DecoderPtr decoder = nullptr;
+  int64_t sequence_index = -1;
 
   switch (stream_data.video_type()) {
   case VideoParams::kVideoTypeVideo:
   case VideoParams::kVideoTypeStill:
     decoder = ResolveDecoderFromInput(decoder_id, default_codec_stream);
+
+    if (!decoder && use_proxy) {
+      // The proxy may have been removed from the disk cache since the job was created
+      use_proxy = false;
+      default_codec_stream = Decoder::CodecStream(stream->filename(), stream_data.stream_index(), GetCurrentBlock());
+      decoder_id = stream->decoder();
+      decoder = ResolveDecoderFromInput(decoder_id, default_codec_stream);
+    }
     break;
   case VideoParams::kVideoTypeImageSequence:
   {
     if (render_ctx_) {
-      // Since image sequences involve multiple files, we don't engage the decoder cache
-      decoder = Decoder::CreateFromID(decoder_id);
-
-      QString frame_filename;
-
       int64_t frame_number = stream_data.get_time_in_timebase_units(input_time);
-      frame_filename = Decoder::TransformImageSequenceFileName(stream->filename(), frame_number);
 
-      // Decoder will close automatically since it's a stream_ptr
-      decoder->Open(Decoder::CodecStream(frame_filename, stream_data.stream_index(), GetCurrentBlock()));
+      if (Decoder::IdSupportsImageSequences(decoder_id)) {
+        // Decoder reads (and prefetches) each file itself, so it can be cached like any other
+        decoder = ResolveDecoderFromInput(decoder_id, default_codec_stream);
+        sequence_index = frame_number;
+      } else if ((decoder = Decoder::CreateFromID(decoder_id))) {
+        // Otherwise open a fresh decoder on this frame's file, it'll close automatically since it's
+        // a shared_ptr
+        QString frame_filename = Decoder::TransformImageSequenceFileName(stream->filename(), frame_number);
+        decoder->Open(Decoder::CodecStream(frame_filename, stream_data.stream_index(), GetCurrentBlock()));
+      }
     }
     break;
   }
@@ -375,6 +404,10 @@ void RenderProcessor::ProcessVideoFootage(TexturePtr destination, const FootageJ
   if (decoder && render_ctx_) {
     Decoder::RetrieveVideoParams p;
     p.divider = stream->video_params().divider();
+    if (use_proxy) {
+      // The proxy is already reduced, so only scale by whatever's left
+      p.divider = std::max(1, p.divider / stream->proxy_divider());
+    }
     p.maximum_format = destination->format();
 
     if (!IsCancelled()) {
@@ -384,10 +417,23 @@ void RenderProcessor::ProcessVideoFootage(TexturePtr destination, const FootageJ
         TexturePtr unmanaged_texture;
 
         p.renderer = render_ctx_;
-        p.time = (stream_data.video_type() == VideoParams::kVideoTypeVideo) ? input_time : Decoder::kAnyTimecode;
+        p.time = (stream_data.video_type() == VideoParams::kVideoTypeVideo || sequence_index >= 0) ? input_time : Decoder::kAnyTimecode;
+        p.sequence_index = sequence_index;
         p.cancelled = GetCancelPointer();
         p.force_range = stream_data.color_range();
-        p.src_interlacing = stream_data.interlacing();
+        p.src_interlacing = use_proxy ? VideoParams::kInterlaceNone : stream_data.interlacing();
+
+        if (sequence_index < 0) {
+          // Decoders that re-open to read at a reduced resolution get their own cache entry per level,
+          // otherwise viewer, thumbnail and auto-cache renders at different dividers keep re-opening
+          // the same shared decoder
+          if (int level = decoder->GetLevelForDivider(p.divider)) {
+            Decoder::CodecStream level_stream(default_codec_stream.filename(), default_codec_stream.stream(), default_codec_stream.block(), level);
+            if (DecoderPtr level_decoder = ResolveDecoderFromInput(decoder_id, level_stream)) {
+              decoder = level_decoder;
+            }
+          }
+        }
 
         unmanaged_texture = decoder->RetrieveVideo(p);
 
@@ -444,7 +490,12 @@ void RenderProcessor::ProcessShader(TexturePtr destination, const Node *node, co
     return;
   }
 
-  QString full_shader_id = QStringLiteral("%1:%2").arg(node->id(), job->GetShaderID());
+  QString full_shader_id;
+  if (job->IsFused()) {
+    full_shader_id = ShaderFusion::GetSignature(job->GetFusedStages());
+  } else {
+    full_shader_id = QStringLiteral("%1:%2").arg(node->id(), job->GetShaderID());
+  }
 
   QMutexLocker locker(shader_cache_->mutex());
 
@@ -452,7 +503,18 @@ void RenderProcessor::ProcessShader(TexturePtr destination, const Node *node, co
 
   if (shader.isNull()) {
     // Since we have shader code, compile it now
-    shader = render_ctx_->CreateNativeShader(node->GetShaderCode(job->GetShaderID()));
+    if (job->IsFused()) {
+      ShaderCode code;
+      if (ShaderFusion::GenerateCode(job->GetFusedStages(), &code)) {
+        shader = render_ctx_->CreateNativeShader(code);
+      }
+
+      if (shader.isNull()) {
+        qWarning() << "Failed to build fused shader" << full_shader_id;
+      }
+    } else {
+      shader = render_ctx_->CreateNativeShader(node->GetShaderCode(job->GetShaderID()));
+    }
 
     if (shader.isNull()) {
       // Couldn't find or build the shader required
@@ -0,0 +1,200 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "shaderfusion.h"
+
+#include <QDebug>
+#include <QRegularExpression>
+
+#include "node/node.h"
+
+namespace olive {
+
+QMutex ShaderFusion::code_cache_lock_;
+QHash<QString, ShaderCode> ShaderFusion::code_cache_;
+
+QString ShaderFusion::GetStagePrefix(int index)
+{
+  return QStringLiteral("s%1_").arg(index);
+}
+
+QString ShaderFusion::GetSignature(const QVector<ShaderJob::FusedStage> &stages)
+{
+  QStringList parts;
+
+  foreach (const ShaderJob::FusedStage &s, stages) {
+    parts.append(QStringLiteral("%1:%2:%3").arg(s.node->id(), s.shader_id, s.fusable_input));
+  }
+
+  return QStringLiteral("fused|%1").arg(parts.join('|'));
+}
+
+bool ShaderFusion::GenerateCode(const QVector<ShaderJob::FusedStage> &stages, ShaderCode *code)
+{
+  QString signature = GetSignature(stages);
+
+  QMutexLocker locker(&code_cache_lock_);
+
+  auto it = code_cache_.constFind(signature);
+  if (it == code_cache_.cend()) {
+    ShaderCode generated;
+    if (!GenerateCodeInternal(stages, &generated)) {
+      generated = ShaderCode();
+    }
+    it = code_cache_.insert(signature, generated);
+  }
+
+  if (it.value().frag_code().isEmpty()) {
+    return false;
+  }
+
+  *code = it.value();
+  return true;
+}
+
+bool ShaderFusion::GenerateCodeInternal(const QVector<ShaderJob::FusedStage> &stages, ShaderCode *code)
+{
+  QString frag = QStringLiteral("in vec2 ove_texcoord;\nout vec4 frag_color;\n");
+
+  for (int i=0; i<stages.size(); i++) {
+    const ShaderJob::FusedStage &stage = stages.at(i);
+
+    ShaderCode stage_code = stage.node->GetShaderCode(Node::ShaderRequest(stage.shader_id));
+
+    // Fusable shaders must use the default vertex shader
+    if (!stage_code.vert_code().isEmpty()) {
+      return false;
+    }
+
+    QString converted = ConvertStage(stage_code.frag_code(), i, stage.fusable_input);
+    if (converted.isEmpty()) {
+      qWarning() << "Failed to fuse shader" << stage.node->id() << stage.shader_id;
+      return false;
+    }
+
+    frag.append(QStringLiteral("\n// Stage %1: %2\n").arg(QString::number(i), stage.node->id()));
+    frag.append(converted);
+  }
+
+  frag.append(QStringLiteral("\nvoid main() {\n  frag_color = %1main(ove_texcoord);\n}\n").arg(GetStagePrefix(stages.size() - 1)));
+
+  code->set_frag_code(frag);
+  code->set_vert_code(QString());
+
+  return true;
+}
+
+QString ShaderFusion::ConvertStage(QString src, int index, const QString &fusable_input)
+{
+  QString prefix = GetStagePrefix(index);
+
+  // The fused shader declares the header and interface once
+  static const QRegularExpression header_regex(QStringLiteral("^\\s*(#version|precision)[^\\n]*$"),
+                                               QRegularExpression::MultilineOption);
+  static const QRegularExpression interface_regex(QStringLiteral("^\\s*(in|out)\\s+vec[24]\\s+(ove_texcoord|frag_color)\\s*;"),
+                                                  QRegularExpression::MultilineOption);
+  src.remove(header_regex);
+  src.remove(interface_regex);
+
+  // Prefix every global name (uniforms, constants, defines and functions) so stages can't collide
+  static const QRegularExpression global_regex(QStringLiteral("\\buniform\\s+\\w+\\s+(\\w+)"
+                                                              "|^\\s*const\\s+\\w+\\s+(\\w+)\\s*="
+                                                              "|^\\s*#define\\s+(\\w+)"
+                                                              "|^\\s*\\w+\\s+(\\w+)\\s*\\([^;{]*\\)\\s*\\{"),
+                                               QRegularExpression::MultilineOption);
+  static const QStringList keywords = {QStringLiteral("main"), QStringLiteral("if"), QStringLiteral("for"),
+                                       QStringLiteral("while"), QStringLiteral("switch"), QStringLiteral("return")};
+
+  QStringList globals;
+  QRegularExpressionMatchIterator it = global_regex.globalMatch(src);
+  while (it.hasNext()) {
+    QRegularExpressionMatch m = it.next();
+    for (int i=1; i<=4; i++) {
+      QString name = m.captured(i);
+      if (!name.isEmpty() && !keywords.contains(name) && !globals.contains(name)) {
+        globals.append(name);
+      }
+    }
+  }
+
+  foreach (const QString &name, globals) {
+    src.replace(QRegularExpression(QStringLiteral("\\b%1\\b").arg(name)), prefix + name);
+  }
+
+  if (index > 0) {
+    // The fusable input is no longer a texture, reading it evaluates the previous stage instead
+    QString input = prefix + fusable_input;
+
+    QRegularExpression declaration(QStringLiteral("\\buniform\\s+sampler2D\\s+%1\\s*;").arg(input));
+    if (!src.contains(declaration)) {
+      return QString();
+    }
+    src.remove(declaration);
+
+    // The renderer only sets the enable flag for real textures, the previous stage always exists
+    src.replace(QRegularExpression(QStringLiteral("\\buniform\\s+bool\\s+%1_enabled\\s*;").arg(input)),
+                QStringLiteral("const bool %1_enabled = true;").arg(input));
+
+    src.replace(QRegularExpression(QStringLiteral("\\btexture\\s*\\(\\s*%1\\s*,").arg(input)),
+                QStringLiteral("%1main(").arg(GetStagePrefix(index - 1)));
+
+    // Any other use (e.g. textureSize()) can't be fused
+    if (src.contains(QRegularExpression(QStringLiteral("\\b%1\\b").arg(input)))) {
+      return QString();
+    }
+  }
+
+  // Turn main() into a function of the texture coordinate that returns its color
+  static const QRegularExpression main_regex(QStringLiteral("\\bvoid\\s+main\\s*\\(\\s*(void)?\\s*\\)\\s*\\{"));
+  QRegularExpressionMatch main_match = main_regex.match(src);
+  if (!main_match.hasMatch()) {
+    return QString();
+  }
+
+  int body_start = main_match.capturedEnd();
+  int body_end = -1;
+  int depth = 1;
+  for (int i=body_start; i<src.size(); i++) {
+    if (src.at(i) == '{') {
+      depth++;
+    } else if (src.at(i) == '}') {
+      depth--;
+      if (depth == 0) {
+        body_end = i;
+        break;
+      }
+    }
+  }
+
+  if (body_end == -1) {
+    return QString();
+  }
+
+  static const QRegularExpression return_regex(QStringLiteral("\\breturn\\s*;"));
+  QString body = src.mid(body_start, body_end - body_start);
+  body.replace(return_regex, QStringLiteral("return frag_color;"));
+
+  QString function = QStringLiteral("vec4 %1main(vec2 ove_texcoord)\n{\n  vec4 frag_color = vec4(0.0);\n%2\n  return frag_color;\n}")
+      .arg(prefix, body);
+
+  return src.left(main_match.capturedStart()) + function + src.mid(body_end + 1);
+}
+
+}
@@ -0,0 +1,71 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef SHADERFUSION_H
+#define SHADERFUSION_H
+
+#include <QHash>
+#include <QMutex>
+
+#include "render/job/shaderjob.h"
+#include "render/shadercode.h"
+
+namespace olive {
+
+/**
+ * @brief Generates one fragment shader from a chain of fusable ShaderJobs
+ *
+ * Each stage's source is rewritten into a function `vec4 s<N>_main(vec2 ove_texcoord)` with its
+ * globals prefixed by `s<N>_`, and every texture() read of its fusable input becomes a call to the
+ * previous stage's function. The fused job's values use the same prefixes.
+ */
+class ShaderFusion
+{
+public:
+  static QString GetStagePrefix(int index);
+
+  /**
+   * @brief Unique key for a chain, suitable for caching the compiled program
+   */
+  static QString GetSignature(const QVector<ShaderJob::FusedStage> &stages);
+
+  /**
+   * @brief Generate the fused shader, returns false if any stage's source couldn't be converted
+   *
+   * Results (including failures) are cached by signature, so this is cheap enough to call for
+   * every frame. Thread-safe.
+   */
+  static bool GenerateCode(const QVector<ShaderJob::FusedStage> &stages, ShaderCode *code);
+
+private:
+  static bool GenerateCodeInternal(const QVector<ShaderJob::FusedStage> &stages, ShaderCode *code);
+
+  static QString ConvertStage(QString src, int index, const QString &fusable_input);
+
+  static QMutex code_cache_lock_;
+
+  /// Generated code by signature, failed chains are stored with no fragment code
+  static QHash<QString, ShaderCode> code_cache_;
+
+};
+
+}
+
+#endif // SHADERFUSION_H
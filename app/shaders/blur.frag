@@ -114,11 +114,9 @@ void main(void) {
         sigma = real_radius;
         real_radius *= 3.0;
 
-        // Use gaussian formula to calculate the weight of all pixels
+        // Sum of all gaussian weights, accumulated in the sampling loop below and used to normalize
+        // the result afterwards so each weight only needs to be calculated once
         divider = 0.0;
-        for (float i = -real_radius + 0.5; i <= real_radius; i += 2.0) {
-            divider += gaussian2(i, 0.0, sigma);
-        }
 
     }
 
@@ -129,7 +127,8 @@ void main(void) {
             if (method_in == METHOD_BOX_BLUR) {
                 weight = divider;
             } else if (method_in == METHOD_GAUSSIAN_BLUR) {
-                weight = gaussian2(i, 0.0, sigma) / divider;
+                weight = gaussian2(i, 0.0, sigma);
+                divider += weight;
             }
 
             vec2 pixel_coord = ove_texcoord;
@@ -141,6 +140,10 @@ void main(void) {
 
             composite = add_to_composite(composite, pixel_coord, weight);
         }
+
+        if (method_in == METHOD_GAUSSIAN_BLUR) {
+            composite /= divider;
+        }
     } else if (method_in == METHOD_DIRECTIONAL_BLUR || method_in == METHOD_RADIAL_BLUR) {
         float angle;
 
@@ -29,6 +29,9 @@ ConformTask::ConformTask(const QString &decoder_id, const Decoder::CodecStream &
   output_filenames_(output_filenames)
 {
   SetTitle(tr("Conforming Audio %1:%2").arg(stream.filename(), QString::number(stream.stream())));
+
+  // Playback of this footage is waiting on the conform
+  SetScheduling(kResourceLatencyCritical);
 }
 
 bool ConformTask::Run()
@@ -26,6 +26,10 @@ CustomCacheTask::CustomCacheTask(const QString &sequence_name) :
   cancelled_through_finish_(false)
 {
   SetTitle(tr("Caching custom range for \"%1\"").arg(sequence_name));
+
+  // Only represents the progress of the PreviewAutoCacher and doesn't use any resources itself, so
+  // there's no reason for it to wait in the queue
+  SetScheduling(kResourceLatencyCritical);
 }
 
 void CustomCacheTask::Finish()
@@ -51,6 +51,9 @@ PreCacheTask::PreCacheTask(Footage *footage, int index, Sequence* sequence)
   viewer()->SetValueHintForInput(ViewerOutput::kTextureInput, Node::ValueHint({NodeValue::kTexture}, Track::Reference(Track::kVideo, index).ToString()));
 
   SetTitle(tr("Pre-caching %1:%2").arg(footage_->filename(), QString::number(index)));
+
+  // Purely background work, anything the user explicitly asked for should go first
+  SetScheduling(kResourceGPU, -1);
 }
 
 PreCacheTask::~PreCacheTask()
@@ -0,0 +1,98 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "proxy.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "common/filefunctions.h"
+#include "node/project.h"
+#include "render/diskmanager.h"
+
+namespace olive {
+
+ProxyTask::ProxyTask(Footage *footage, int index, int divider) :
+  decoder_id_(footage->decoder()),
+  stream_(footage->filename(), footage->GetVideoParams(index).stream_index(), nullptr),
+  divider_(divider),
+  cache_path_(footage->project()->cache_path())
+{
+  output_filename_ = GetProxyFilename(cache_path_, stream_, divider_);
+
+  SetTitle(tr("Creating proxy for %1:%2").arg(stream_.filename(), QString::number(stream_.stream())));
+
+  // Purely background work, anything the user explicitly asked for should go first
+  SetScheduling(kResourceCPU, -1);
+}
+
+QString ProxyTask::GetProxyFilename(const QString &cache_path, const Decoder::CodecStream &stream, int divider)
+{
+  QString fn = QStringLiteral("%1-%2.proxy%3.mov").arg(FileFunctions::GetUniqueFileIdentifier(stream.filename()),
+                                                       QString::number(stream.stream()),
+                                                       QString::number(divider));
+
+  return QDir(cache_path).filePath(fn);
+}
+
+bool ProxyTask::Run()
+{
+  DecoderPtr decoder = Decoder::CreateFromID(decoder_id_);
+
+  if (!decoder || !decoder->Open(stream_)) {
+    SetError(tr("Failed to open decoder for proxy"));
+    return false;
+  }
+
+  connect(decoder.get(), &Decoder::IndexProgress, this, &ProxyTask::ProgressChanged);
+
+  QDir().mkpath(QFileInfo(output_filename_).absolutePath());
+
+  // Write to a different filename until it's done so an unfinished proxy is never used
+  QString working_filename = output_filename_;
+  working_filename.append(QStringLiteral(".working.mov"));
+
+  bool ret = decoder->GenerateProxy(working_filename, divider_, GetCancelAtom());
+
+  decoder->Close();
+
+  if (ret) {
+    QFile::remove(output_filename_);
+    ret = QFile::rename(working_filename, output_filename_);
+
+    if (ret) {
+      // Proxies count towards the disk cache limit like any other cached file
+      QMetaObject::invokeMethod(DiskManager::instance(), "CreatedFile", Q_ARG(QString, cache_path_), Q_ARG(QString, output_filename_));
+    }
+  } else {
+    QFile::remove(working_filename);
+
+    if (IsCancelled()) {
+      SetError(tr("Proxy creation for %1 was cancelled").arg(stream_.filename()));
+    } else {
+      SetError(tr("Failed to create proxy for %1").arg(stream_.filename()));
+    }
+  }
+
+  return ret;
+}
+
+}
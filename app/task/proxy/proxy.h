@@ -0,0 +1,72 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef PROXYTASK_H
+#define PROXYTASK_H
+
+#include "codec/decoder.h"
+#include "node/project/footage/footage.h"
+#include "task/task.h"
+
+namespace olive {
+
+/**
+ * @brief Transcodes a footage video stream into a reduced resolution proxy file
+ *
+ * The proxy is written to a working filename and only moved to GetOutputFilename() once complete,
+ * so a proxy that exists on disk is always usable.
+ */
+class ProxyTask : public Task
+{
+  Q_OBJECT
+public:
+  ProxyTask(Footage *footage, int index, int divider);
+
+  const QString &GetOutputFilename() const
+  {
+    return output_filename_;
+  }
+
+  int GetDivider() const
+  {
+    return divider_;
+  }
+
+  static QString GetProxyFilename(const QString &cache_path, const Decoder::CodecStream &stream, int divider);
+
+protected:
+  virtual bool Run() override;
+
+private:
+  QString decoder_id_;
+
+  Decoder::CodecStream stream_;
+
+  int divider_;
+
+  QString cache_path_;
+
+  QString output_filename_;
+
+};
+
+}
+
+#endif // PROXYTASK_H
@@ -29,6 +29,8 @@ RenderTask::RenderTask() :
   running_tickets_(0),
   native_progress_signalling_(true)
 {
+  SetScheduling(kResourceGPU);
+  SetProcessedUnit(tr("frames"));
 }
 
 RenderTask::~RenderTask()
@@ -184,6 +186,8 @@ bool RenderTask::Render(ColorManager* manager,
           result = false;
         }
 
+        IncrementProcessedCount();
+
         if (native_progress_signalling_) {
           double progress_to_add = 1.0;
           if (TwoStepFrameRendering()) {
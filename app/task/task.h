@@ -43,7 +43,7 @@ namespace olive {
  * unable to determine anything about the file.
  *
  * Tasks should be used with the TaskManager which will manage starting and deleting them. It'll also only start as
- * many Tasks as there are threads on the system as to not overload them.
+ * many Tasks of each ResourceClass as that resource can handle as to not overload it.
  *
  * Tasks support "dependency tasks", i.e. a Task that should be complete before another Task begins.
  */
@@ -51,13 +51,38 @@ class Task : public QObject, public CancelableObject
 {
   Q_OBJECT
 public:
+  /**
+   * @brief The system resource a Task mostly depends on
+   *
+   * TaskManager limits how many Tasks of each class run at once, so for example a long GPU-bound
+   * export never holds up a short I/O-bound conform.
+   */
+  enum ResourceClass {
+    /// Mostly waits on disk or network access
+    kResourceIO,
+
+    /// Mostly processing on the CPU
+    kResourceCPU,
+
+    /// Mostly rendering through the RenderManager
+    kResourceGPU,
+
+    /// Something the user is actively waiting on (e.g. playback), always started immediately
+    kResourceLatencyCritical,
+
+    kResourceClassCount
+  };
+
   /**
    * @brief Task Constructor
    */
   Task() :
     title_(tr("Task")),
     error_(tr("Unknown error")),
-    start_time_(0)
+    start_time_(0),
+    resource_class_(kResourceCPU),
+    priority_(0),
+    processed_count_(0)
   {
   }
 
@@ -82,6 +107,29 @@ public:
     return start_time_;
   }
 
+  ResourceClass GetResourceClass() const
+  {
+    return resource_class_;
+  }
+
+  /**
+   * @brief Tasks with a higher priority are started before queued Tasks of the same class
+   */
+  int GetPriority() const
+  {
+    return priority_;
+  }
+
+  /**
+   * @brief Name of the unit counted by ProcessedCountChanged(), e.g. "frames"
+   *
+   * Empty if this Task doesn't report throughput.
+   */
+  const QString &GetProcessedUnit() const
+  {
+    return processed_unit_;
+  }
+
 public slots:
   /**
    * @brief Run this task
@@ -150,6 +198,33 @@ protected:
     title_ = s;
   }
 
+  /**
+   * @brief Set the resource class and priority used by TaskManager to schedule this Task
+   *
+   * Must be called before the Task is added to the TaskManager, so generally in the constructor.
+   */
+  void SetScheduling(ResourceClass c, int priority = 0)
+  {
+    resource_class_ = c;
+    priority_ = priority;
+  }
+
+  void SetProcessedUnit(const QString &unit)
+  {
+    processed_unit_ = unit;
+  }
+
+  /**
+   * @brief Report that another unit (see SetProcessedUnit()) has been processed
+   *
+   * Used by the UI to show this Task's throughput.
+   */
+  void IncrementProcessedCount()
+  {
+    processed_count_++;
+    emit ProcessedCountChanged(processed_count_);
+  }
+
 signals:
   void Started(qint64 start_time);
 
@@ -164,6 +239,8 @@ signals:
    */
   void ProgressChanged(double d);
 
+  void ProcessedCountChanged(qint64 count);
+
   /**
    * @brief Emitted when task is finished
    *
@@ -178,6 +255,14 @@ private:
 
   qint64 start_time_;
 
+  ResourceClass resource_class_;
+
+  int priority_;
+
+  QString processed_unit_;
+
+  qint64 processed_count_;
+
 };
 
 }
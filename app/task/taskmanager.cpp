@@ -29,13 +29,30 @@ TaskManager* TaskManager::instance_ = nullptr;
 
 TaskManager::TaskManager()
 {
-  thread_pool_.setMaxThreadCount(1);
+  max_running_[Task::kResourceIO] = 4;
+  max_running_[Task::kResourceCPU] = qMax(1, QThread::idealThreadCount() / 2);
+  max_running_[Task::kResourceGPU] = 2;
+  max_running_[Task::kResourceLatencyCritical] = QThread::idealThreadCount();
+
+  int total_threads = 0;
+  for (int i=0; i<Task::kResourceClassCount; i++) {
+    running_count_[i] = 0;
+    total_threads += max_running_[i];
+  }
+
+  // Per-class limits are enforced by us, the pool just needs enough threads to satisfy all of them
+  thread_pool_.setMaxThreadCount(total_threads);
 }
 
 TaskManager::~TaskManager()
 {
   thread_pool_.clear();
 
+  foreach (Task* t, queued_tasks_) {
+    t->deleteLater();
+  }
+  queued_tasks_.clear();
+
   foreach (Task* t, tasks_) {
     t->Cancel();
   }
@@ -65,7 +82,7 @@ TaskManager *TaskManager::instance()
 
 int TaskManager::GetTaskCount() const
 {
-  return tasks_.size();
+  return tasks_.size() + int(queued_tasks_.size());
 }
 
 Task *TaskManager::GetFirstTask() const
@@ -75,6 +92,12 @@ Task *TaskManager::GetFirstTask() const
 
 void TaskManager::CancelTaskAndWait(Task* t)
 {
+  if (IsQueued(t)) {
+    // Never started, nothing to wait for
+    CancelTask(t);
+    return;
+  }
+
   t->Cancel();
 
   QFutureWatcher<bool>* w = tasks_.key(t);
@@ -85,13 +108,56 @@ void TaskManager::CancelTaskAndWait(Task* t)
 }
 
 void TaskManager::AddTask(Task* t)
+{
+  // Add the Task to the queue after any Tasks of the same or higher priority
+  auto it = std::find_if(queued_tasks_.begin(), queued_tasks_.end(), [t](Task *q){
+    return q->GetPriority() < t->GetPriority();
+  });
+  queued_tasks_.insert(it, t);
+
+  // Emit signal that a Task was added
+  emit TaskAdded(t);
+
+  StartQueuedTasks();
+
+  emit TaskListChanged();
+}
+
+void TaskManager::SetMaximumConcurrency(Task::ResourceClass c, int n)
+{
+  int diff = qMax(1, n) - max_running_[c];
+
+  max_running_[c] += diff;
+  thread_pool_.setMaxThreadCount(thread_pool_.maxThreadCount() + diff);
+
+  StartQueuedTasks();
+}
+
+void TaskManager::CancelTask(Task *t)
+{
+  if (std::find(failed_tasks_.begin(), failed_tasks_.end(), t) != failed_tasks_.end()) {
+    failed_tasks_.remove(t);
+    emit TaskRemoved(t);
+    t->deleteLater();
+  } else if (IsQueued(t)) {
+    // Task hasn't started yet so it can just be removed
+    queued_tasks_.remove(t);
+    emit TaskRemoved(t);
+    t->deleteLater();
+    emit TaskListChanged();
+  } else {
+    t->Cancel();
+  }
+}
+
+void TaskManager::StartTask(Task *t)
 {
   // Create a watcher for signalling
   QFutureWatcher<bool>* watcher = new QFutureWatcher<bool>();
   connect(watcher, &QFutureWatcher<bool>::finished, this, &TaskManager::TaskFinished);
 
-  // Add the Task to the queue
   tasks_.insert(watcher, t);
+  running_count_[t->GetResourceClass()]++;
 
   // Run task concurrently
   watcher->setFuture(
@@ -102,19 +168,21 @@ void TaskManager::AddTask(Task* t)
 #endif
         );
 
-  // Emit signal that a Task was added
-  emit TaskAdded(t);
-  emit TaskListChanged();
+  emit TaskStarted(t);
 }
 
-void TaskManager::CancelTask(Task *t)
+void TaskManager::StartQueuedTasks()
 {
-  if (std::find(failed_tasks_.begin(), failed_tasks_.end(), t) != failed_tasks_.end()) {
-    failed_tasks_.remove(t);
-    emit TaskRemoved(t);
-    t->deleteLater();
-  } else {
-    t->Cancel();
+  for (auto it=queued_tasks_.begin(); it!=queued_tasks_.end(); ) {
+    Task *t = *it;
+    Task::ResourceClass c = t->GetResourceClass();
+
+    if (running_count_[c] < max_running_[c]) {
+      it = queued_tasks_.erase(it);
+      StartTask(t);
+    } else {
+      it++;
+    }
   }
 }
 
@@ -124,6 +192,7 @@ void TaskManager::TaskFinished()
   Task* t = tasks_.value(watcher);
 
   tasks_.remove(watcher);
+  running_count_[t->GetResourceClass()]--;
 
   if (watcher->result()) {
     // Task completed successfully
@@ -137,6 +206,9 @@ void TaskManager::TaskFinished()
 
   watcher->deleteLater();
 
+  // A slot has freed up, see if anything was waiting for it
+  StartQueuedTasks();
+
   emit TaskListChanged();
 }
 
@@ -34,8 +34,9 @@ namespace olive {
  *
  * TaskManager handles the life of a Task object. After a new Task is created, it should be sent to TaskManager through
  * AddTask(). TaskManager will take ownership of the task and add it to a queue until it system resources are available
- * for it to run. Currently, TaskManager will run no more Tasks than there are threads on the system (one task per
- * thread). As Tasks finished, TaskManager will start the next in the queue.
+ * for it to run. Each Task::ResourceClass has its own concurrency limit (see SetMaximumConcurrency()), so Tasks only
+ * wait behind other Tasks that compete for the same resource. Within a class, queued Tasks are started in order of
+ * Task::GetPriority(). As Tasks finished, TaskManager will start the next in the queue.
  */
 class TaskManager : public QObject
 {
@@ -59,12 +60,40 @@ public:
 
   static TaskManager* instance();
 
+  /**
+   * @brief Number of running and queued Tasks
+   */
   int GetTaskCount() const;
 
+  int GetRunningTaskCount() const
+  {
+    return tasks_.size();
+  }
+
+  int GetQueuedTaskCount() const
+  {
+    return int(queued_tasks_.size());
+  }
+
+  bool IsQueued(Task *t) const
+  {
+    return std::find(queued_tasks_.cbegin(), queued_tasks_.cend(), t) != queued_tasks_.cend();
+  }
+
+  /**
+   * @brief Returns the first running Task
+   */
   Task* GetFirstTask() const;
 
   void CancelTaskAndWait(Task* t);
 
+  int GetMaximumConcurrency(Task::ResourceClass c) const
+  {
+    return max_running_[c];
+  }
+
+  void SetMaximumConcurrency(Task::ResourceClass c, int n);
+
 public slots:
   /**
    * @brief Add a new Task
@@ -95,6 +124,11 @@ signals:
    */
   void TaskAdded(Task* t);
 
+  /**
+   * @brief Signal emitted when a queued Task is given a thread to run on
+   */
+  void TaskStarted(Task* t);
+
   /**
    * @brief Signal emitted when any change to the running task list has been made
    */
@@ -111,11 +145,26 @@ signals:
   void TaskFailed(Task* t);
 
 private:
+  void StartTask(Task *t);
+
+  /**
+   * @brief Start as many queued Tasks as their class's concurrency limits allow
+   */
+  void StartQueuedTasks();
+
   /**
-   * @brief Internal task array
+   * @brief Internal running task array
    */
   QHash<QFutureWatcher<bool>*, Task*> tasks_;
 
+  /**
+   * @brief Tasks waiting for their resource class to free up, sorted by priority
+   */
+  std::list<Task*> queued_tasks_;
+
+  int running_count_[Task::kResourceClassCount];
+  int max_running_[Task::kResourceClassCount];
+
   /**
    * @brief Internal list of failed tasks
    */
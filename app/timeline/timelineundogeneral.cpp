@@ -293,7 +293,9 @@ void TrackListInsertGaps::prepare()
   QVector<Track*> tracks_to_append_gap_to;
 
   for (Track* track : qAsConst(working_tracks_)) {
-    for (Block* b : track->Blocks()) {
+    // Every block before this one ends before the point so can't match either case below
+    for (int i=track->GetFirstBlockIndexEndingAfter(point_, true); i<track->Blocks().size(); i++) {
+      Block *b = track->Blocks().at(i);
       if (dynamic_cast<GapBlock*>(b) && b->in() <= point_ && b->out() >= point_) {
         // Found a gap at the location
         gaps_to_extend_.append(b);
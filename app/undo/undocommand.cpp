@@ -21,9 +21,55 @@
 #include "undocommand.h"
 
 #include "core.h"
+#include "node/node.h"
 
 namespace olive {
 
+const size_t UndoCommand::kBaseMemoryCost = 128;
+
+// Rough per-object and per-input costs used when estimating retained nodes. These don't need to
+// be exact, they just need to scale with what the command is actually holding on to.
+const size_t kRetainedObjectCost = 512;
+const size_t kRetainedInputCost = 256;
+
+size_t MultiUndoCommand::memory_cost() const
+{
+  size_t cost = kBaseMemoryCost;
+
+  for (auto it=children_.cbegin(); it!=children_.cend(); it++) {
+    cost += (*it)->memory_cost();
+  }
+
+  return cost;
+}
+
+bool MultiUndoCommand::can_merge_with(const UndoCommand *command) const
+{
+  // Merge only if every child can merge with its counterpart, e.g. a slider drag that set the
+  // same inputs again
+  const MultiUndoCommand *other = dynamic_cast<const MultiUndoCommand*>(command);
+  if (!other || other->children_.size() != children_.size() || children_.empty()) {
+    return false;
+  }
+
+  for (size_t i=0; i<children_.size(); i++) {
+    if (!children_.at(i)->can_merge_with(other->children_.at(i))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void MultiUndoCommand::merge_with(const UndoCommand *command)
+{
+  const MultiUndoCommand *other = static_cast<const MultiUndoCommand*>(command);
+
+  for (size_t i=0; i<children_.size(); i++) {
+    children_.at(i)->merge_with(other->children_.at(i));
+  }
+}
+
 void MultiUndoCommand::redo()
 {
   for (auto it=children_.cbegin(); it!=children_.cend(); it++) {
@@ -48,7 +94,10 @@ void UndoCommand::redo_and_set_modified()
 {
   project_ = GetRelevantProject();
 
+  // Coalesce cache invalidations so each node is invalidated once per command
+  Node::BeginInvalidationBatch();
   redo_now();
+  Node::EndInvalidationBatch();
 
   if (project_) {
     modified_ = project_->is_modified();
@@ -58,7 +107,9 @@ void UndoCommand::redo_and_set_modified()
 
 void UndoCommand::undo_and_set_modified()
 {
+  Node::BeginInvalidationBatch();
   undo_now();
+  Node::EndInvalidationBatch();
 
   if (project_) {
     project_->set_modified(modified_);
@@ -86,4 +137,23 @@ void UndoCommand::undo_now()
   }
 }
 
+size_t UndoCommand::GetRetainedMemoryCost(const QObject *owner)
+{
+  size_t cost = 0;
+
+  const QObjectList &children = owner->children();
+  for (QObject *child : children) {
+    cost += kRetainedObjectCost;
+
+    if (const Node *node = dynamic_cast<const Node*>(child)) {
+      cost += node->inputs().size() * kRetainedInputCost;
+    }
+
+    // Keyframes and other objects belonging to retained objects are children of them
+    cost += GetRetainedMemoryCost(child);
+  }
+
+  return cost;
+}
+
 }
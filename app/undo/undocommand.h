@@ -22,6 +22,7 @@
 #define UNDOCOMMAND_H
 
 #include <list>
+#include <QObject>
 #include <QString>
 #include <vector>
 
@@ -51,11 +52,52 @@ public:
 
   virtual Project* GetRelevantProject() const = 0;
 
+  /**
+   * @brief Approximate number of bytes this command keeps alive while it's in the undo history
+   *
+   * Commands that take ownership of removed objects (nodes, keyframes, etc.) should override this
+   * so the UndoStack can keep its history within the configured memory budget.
+   */
+  virtual size_t memory_cost() const
+  {
+    return kBaseMemoryCost;
+  }
+
+  /**
+   * @brief Returns whether `command` can be folded into this command by merge_with()
+   *
+   * Only commands of the same type that act on the same target should return true. The default
+   * implementation never merges.
+   */
+  virtual bool can_merge_with(const UndoCommand *command) const
+  {
+    Q_UNUSED(command)
+    return false;
+  }
+
+  /**
+   * @brief Fold an already done `command` into this one
+   *
+   * After merging, undoing this command must undo both. Only called if can_merge_with() returned
+   * true.
+   */
+  virtual void merge_with(const UndoCommand *command)
+  {
+    Q_UNUSED(command)
+  }
+
 protected:
   virtual void prepare(){}
   virtual void redo() = 0;
   virtual void undo() = 0;
 
+  /**
+   * @brief Estimate the memory retained by the children of an object (usually a memory manager)
+   */
+  static size_t GetRetainedMemoryCost(const QObject *owner);
+
+  static const size_t kBaseMemoryCost;
+
 private:
   bool modified_;
 
@@ -92,6 +134,12 @@ public:
     return children_[i];
   }
 
+  virtual size_t memory_cost() const override;
+
+  virtual bool can_merge_with(const UndoCommand *command) const override;
+
+  virtual void merge_with(const UndoCommand *command) override;
+
 protected:
   virtual void redo() override;
   virtual void undo() override;
@@ -21,11 +21,17 @@
 #include "undostack.h"
 
 #include <QCoreApplication>
+#include <QDateTime>
+
+#include "config/config.h"
 
 namespace olive {
 
 const int UndoStack::kMaxUndoCommands = 200;
 
+// Consecutive mergeable commands pushed within this many milliseconds of each other become one
+const qint64 UndoStack::kMergeInterval = 1000;
+
 class EmptyCommand : public UndoCommand
 {
 public:
@@ -39,7 +45,8 @@ protected:
 
 };
 
-UndoStack::UndoStack()
+UndoStack::UndoStack() :
+  total_memory_cost_(0)
 {
   undo_action_ = new QAction();
   connect(undo_action_, &QAction::triggered, this, &UndoStack::undo);
@@ -67,10 +74,17 @@ void UndoStack::push(UndoCommand *command, const QString &name)
     return;
   }
 
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+  if (TryMergeWithTop(command, name, now)) {
+    return;
+  }
+
   // Clear any redoable commands
   this->beginRemoveRows(QModelIndex(), commands_.size(), commands_.size() + undone_commands_.size());
   if (CanRedo()) {
     for (auto it=undone_commands_.cbegin(); it!=undone_commands_.cend(); it++) {
+      total_memory_cost_ -= (*it).memory_cost;
       delete (*it).command;
     }
     undone_commands_.clear();
@@ -80,16 +94,12 @@ void UndoStack::push(UndoCommand *command, const QString &name)
   // Do command and push
   this->beginInsertRows(QModelIndex(), commands_.size(), commands_.size());
   command->redo_and_set_modified();
-  commands_.push_back({command, name});
+  commands_.push_back({command, name, 0, now});
+  UpdateMemoryCost(commands_.back());
   this->endInsertRows();
 
   // Delete oldest
-  if (commands_.size() > kMaxUndoCommands) {
-    this->beginRemoveRows(QModelIndex(), 0, 0);
-    delete commands_.front().command;
-    commands_.pop_front();
-    this->endRemoveRows();
-  }
+  EnforceLimits();
 
   UpdateActions();
 }
@@ -109,6 +119,7 @@ void UndoStack::undo()
   if (CanUndo()) {
     // Undo most recently done command
     commands_.back().command->undo_and_set_modified();
+    UpdateMemoryCost(commands_.back());
 
     // Place at the front of the "undone commands" list
     undone_commands_.push_front(commands_.back());
@@ -126,6 +137,7 @@ void UndoStack::redo()
   if (CanRedo()) {
     // Redo most recently undone command
     undone_commands_.front().command->redo_and_set_modified();
+    UpdateMemoryCost(undone_commands_.front());
 
     // Place at the back of the done commands list
     commands_.push_back(undone_commands_.front());
@@ -150,6 +162,7 @@ void UndoStack::clear()
     delete (*it).command;
   }
   undone_commands_.clear();
+  total_memory_cost_ = 0;
 
   this->endResetModel();
 
@@ -172,6 +185,70 @@ void UndoStack::UpdateActions()
   emit indexChanged(commands_.size());
 }
 
+const UndoStack::CommandEntry &UndoStack::GetEntry(size_t index) const
+{
+  std::list<CommandEntry>::const_iterator it;
+  if (index < commands_.size()) {
+    it = commands_.cbegin();
+  } else {
+    index -= commands_.size();
+    it = undone_commands_.cbegin();
+  }
+  std::advance(it, index);
+  return *it;
+}
+
+bool UndoStack::TryMergeWithTop(UndoCommand *command, const QString &name, qint64 time)
+{
+  // Only merge into the most recent action, and only if nothing has been undone since
+  if (!CanUndo() || CanRedo()) {
+    return false;
+  }
+
+  CommandEntry &top = commands_.back();
+  if (top.name != name || time - top.time > kMergeInterval || !top.command->can_merge_with(command)) {
+    return false;
+  }
+
+  command->redo_and_set_modified();
+  top.command->merge_with(command);
+  delete command;
+
+  top.time = time;
+  UpdateMemoryCost(top);
+
+  QModelIndex top_index = this->index(commands_.size() - 1, 0);
+  emit dataChanged(top_index, top_index);
+
+  UpdateActions();
+
+  return true;
+}
+
+void UndoStack::UpdateMemoryCost(CommandEntry &entry)
+{
+  // Retained memory changes as commands are done and undone (e.g. a removed node is only held by
+  // its command while the removal is done)
+  total_memory_cost_ -= entry.memory_cost;
+  entry.memory_cost = entry.command->memory_cost();
+  total_memory_cost_ += entry.memory_cost;
+}
+
+void UndoStack::EnforceLimits()
+{
+  size_t budget = size_t(OLIVE_CONFIG("UndoMemoryBudget").toLongLong()) * 1024 * 1024;
+
+  // Always keep the most recent command so it can be undone regardless of its size
+  while (commands_.size() > 1
+         && (commands_.size() > size_t(kMaxUndoCommands) || (budget > 0 && total_memory_cost_ > budget))) {
+    this->beginRemoveRows(QModelIndex(), 0, 0);
+    total_memory_cost_ -= commands_.front().memory_cost;
+    delete commands_.front().command;
+    commands_.pop_front();
+    this->endRemoveRows();
+  }
+}
+
 int UndoStack::columnCount(const QModelIndex &parent) const
 {
   if (parent.isValid()) {
@@ -188,21 +265,12 @@ QVariant UndoStack::data(const QModelIndex &index, int role) const
       return index.row() + 1;
     case 1:
     {
-      std::list<CommandEntry>::const_iterator it;
-      size_t real_index = index.row();
-      if (real_index < commands_.size()) {
-        it = commands_.cbegin();
-      } else {
-        real_index -= commands_.size();
-        it = undone_commands_.cbegin();
-      }
-      for (size_t i = 0; i < real_index; i++) {
-        it++;
-      }
-      const QString &name = (*it).name;
+      const QString &name = GetEntry(index.row()).name;
       return (name.isEmpty()) ? tr("Command") : name;
     }
     }
+  } else if (role == Qt::ToolTipRole) {
+    return tr("Memory: %1 KB").arg(QString::number(double(GetEntry(index.row()).memory_cost) / 1024.0, 'f', 1));
   } else if (role == Qt::ForegroundRole) {
     if (size_t(index.row()) >= commands_.size()) {
       return QVariant(QColor(Qt::gray));
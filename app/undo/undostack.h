@@ -52,6 +52,22 @@ public:
 
   void UpdateActions();
 
+  /**
+   * @brief Approximate memory retained by the command at `index` in the history
+   */
+  size_t GetMemoryCost(size_t index) const
+  {
+    return GetEntry(index).memory_cost;
+  }
+
+  /**
+   * @brief Approximate memory retained by the whole undo history
+   */
+  size_t GetTotalMemoryCost() const
+  {
+    return total_memory_cost_;
+  }
+
   QAction* GetUndoAction()
   {
     return undo_action_;
@@ -81,12 +97,24 @@ public slots:
 private:
   static const int kMaxUndoCommands;
 
+  static const qint64 kMergeInterval;
+
   struct CommandEntry
   {
     UndoCommand *command;
     QString name;
+    size_t memory_cost;
+    qint64 time;
   };
 
+  const CommandEntry &GetEntry(size_t index) const;
+
+  bool TryMergeWithTop(UndoCommand *command, const QString &name, qint64 time);
+
+  void UpdateMemoryCost(CommandEntry &entry);
+
+  void EnforceLimits();
+
   std::list<CommandEntry> commands_;
 
   std::list<CommandEntry> undone_commands_;
@@ -95,6 +123,8 @@ private:
 
   QAction* redo_action_;
 
+  size_t total_memory_cost_;
+
 };
 
 }
@@ -168,20 +168,35 @@ void CurveView::drawBackground(QPainter *painter, const QRectF &rect)
         painter->setPen(QPen(keyframe_colors_.value(ref),
                              qMax(1, fontMetrics().height() / 4)));
 
+        const NodeKeyframeCurve& curve = node->GetKeyframeCurve(ref);
+
+        FloatSlider::DisplayType display = GetFloatDisplayTypeFromKeyframe(track.first());
+        double offset = GetOffsetFromKeyframe(track.first());
+
+        // Only walk the keyframes that surround the visible area
+        double visible_in = GetUnadjustedKeyframeTime(track.first(), SceneToTimeNoGrid(scene_bottom_left.x())).toDouble();
+        double visible_out = GetUnadjustedKeyframeTime(track.first(), SceneToTimeNoGrid(scene_top_right.x())).toDouble();
+        int first_index = qMax(0, curve.GetIndexAtTime(visible_in));
+        int last_index = qMin(track.size() - 1, curve.GetIndexAtTime(visible_out) + 1);
+
         // Create a path
         QPainterPath path;
 
-        // Draw straight line leading to first keyframe
-        QPointF first_key_pos = GetKeyframePosition(track.first());
-        path.moveTo(QPointF(scene_bottom_left.x(), first_key_pos.y()));
-        path.lineTo(first_key_pos);
+        QPointF before_pos = GetKeyframePosition(track.at(first_index));
+
+        if (first_index == 0) {
+          // Draw straight line leading to first keyframe
+          path.moveTo(QPointF(scene_bottom_left.x(), before_pos.y()));
+          path.lineTo(before_pos);
+        } else {
+          path.moveTo(before_pos);
+        }
 
         // Draw lines between each keyframe
-        for (int i=1;i<track.size();i++) {
+        for (int i=first_index+1;i<=last_index;i++) {
           NodeKeyframe* before = track.at(i-1);
           NodeKeyframe* after = track.at(i);
 
-          QPointF before_pos = GetKeyframePosition(before);
           QPointF after_pos = GetKeyframePosition(after);
 
           if (before->type() == NodeKeyframe::kHold) {
@@ -190,36 +205,38 @@ void CurveView::drawBackground(QPainter *painter, const QRectF &rect)
             path.lineTo(after_pos.x(), before_pos.y());
             path.lineTo(after_pos.x(), after_pos.y());
 
-          } else if (before->type() == NodeKeyframe::kBezier && after->type() == NodeKeyframe::kBezier) {
+          } else if (before->type() == NodeKeyframe::kBezier || after->type() == NodeKeyframe::kBezier) {
 
-            // Draw a cubic bezier
+            // Sample the bezier across the visible part of this segment, evaluating the whole
+            // segment in one pass
+            double sample_in = qMax(before_pos.x(), scene_bottom_left.x());
+            double sample_out = qMin(after_pos.x(), scene_top_right.x());
+            double segment_width = after_pos.x() - before_pos.x();
 
-            // Cubic beziers have two control points, so we can just use both
-            QPointF before_control_point = before_pos + ScalePoint(before->valid_bezier_control_out());
-            QPointF after_control_point = after_pos + ScalePoint(after->valid_bezier_control_in());
+            if (curve.CanInterpolate() && sample_out > sample_in && segment_width > 0) {
+              int count = qMax(2, qCeil((sample_out - sample_in) / kCurveSampleSpacing) + 1);
 
-            path.cubicTo(before_control_point, after_control_point, after_pos);
+              curve_sample_times_.resize(count);
+              curve_sample_values_.resize(count);
 
-          } else if (before->type() == NodeKeyframe::kBezier || after->type() == NodeKeyframe::kBezier) {
-            // Draw a quadratic bezier
-
-            // Quadratic beziers have a single control point, we just have to determine which it is
-            QPointF key_anchor;
-            QPointF control_point;
-
-            if (before->type() == NodeKeyframe::kBezier) {
-              key_anchor = before_pos;
-              control_point = before->valid_bezier_control_out();
-            } else {
-              key_anchor = after_pos;
-              control_point = after->valid_bezier_control_in();
-            }
+              double before_time = curve.times().at(i-1);
+              double time_per_px = (curve.times().at(i) - before_time) / segment_width;
+
+              for (int j=0; j<count; j++) {
+                double x = sample_in + (sample_out - sample_in) * j / (count - 1);
+                curve_sample_times_[j] = before_time + (x - before_pos.x()) * time_per_px;
+              }
 
-            // Scale control point
-            control_point = key_anchor + ScalePoint(control_point);
+              curve.Evaluate(curve_sample_times_.data(), curve_sample_values_.data(), count);
 
-            // Create the path from both keyframes
-            path.quadTo(control_point, after_pos);
+              for (int j=0; j<count; j++) {
+                double x = before_pos.x() + (curve_sample_times_[j] - before_time) / time_per_px;
+                double val = FloatSlider::TransformValueToDisplay(curve_sample_values_[j], display) + offset;
+                path.lineTo(x, -val * GetYScale());
+              }
+            }
+
+            path.lineTo(after_pos);
 
           } else {
 
@@ -227,11 +244,14 @@ void CurveView::drawBackground(QPainter *painter, const QRectF &rect)
             path.lineTo(after_pos);
 
           }
+
+          before_pos = after_pos;
         }
 
-        // Draw straight line leading from end keyframe
-        QPointF last_key_pos = GetKeyframePosition(track.last());
-        path.lineTo(QPointF(scene_top_right.x(), last_key_pos.y()));
+        if (last_index == track.size() - 1) {
+          // Draw straight line leading from end keyframe
+          path.lineTo(QPointF(scene_top_right.x(), before_pos.y()));
+        }
 
         painter->drawPath(path);
       }
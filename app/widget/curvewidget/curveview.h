@@ -21,6 +21,8 @@
 #ifndef CURVEVIEW_H
 #define CURVEVIEW_H
 
+#include <vector>
+
 #include "node/keyframe.h"
 #include "widget/keyframeview/keyframeview.h"
 #include "widget/slider/floatslider.h"
@@ -74,6 +76,9 @@ protected:
   virtual void KeyframeDragRelease(QMouseEvent *event, MultiUndoCommand *command) override;
 
 private:
+  /// Distance in pixels between samples when drawing bezier segments
+  static const int kCurveSampleSpacing = 2;
+
   void ZoomToFitInternal(bool selected_only);
 
   qreal GetItemYFromKeyframeValue(NodeKeyframe* key);
@@ -120,6 +125,9 @@ private:
 
   QVector<QVariant> drag_keyframe_values_;
 
+  std::vector<double> curve_sample_times_;
+  std::vector<double> curve_sample_values_;
+
 };
 
 }
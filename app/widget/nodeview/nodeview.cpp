@@ -26,6 +26,7 @@
 #include <QMouseEvent>
 #include <QPushButton>
 #include <QScrollBar>
+#include <QSet>
 #include <QToolTip>
 
 #include "node/audio/volume/volume.h"
@@ -45,6 +46,7 @@ namespace olive {
 
 const double NodeView::kMinimumScale = 0.1;
 const int NodeView::kMaximumContexts = 10;
+const int NodeView::kSceneBoundsUpdateInterval = 250;
 
 NodeView::NodeView(QWidget *parent) :
   HandMovableView(parent),
@@ -69,8 +71,14 @@ NodeView::NodeView(QWidget *parent) :
 
   SetFlowDirection(NodeViewCommon::kLeftToRight);
 
+  // Recomputing the items bounding rect walks every item, so only do it periodically and grow the
+  // scene rect directly in between
+  scene_bounds_timer_.setInterval(kSceneBoundsUpdateInterval);
+  scene_bounds_timer_.setSingleShot(true);
+  connect(&scene_bounds_timer_, &QTimer::timeout, this, &NodeView::UpdateSceneBoundingRect);
+
   UpdateSceneBoundingRect();
-  connect(&scene_, &QGraphicsScene::changed, this, &NodeView::UpdateSceneBoundingRect);
+  connect(&scene_, &QGraphicsScene::changed, this, &NodeView::SceneChanged);
 
   minimap_ = new NodeViewMiniMap(&scene_, this);
   minimap_->show();
@@ -720,40 +728,43 @@ void NodeView::UpdateSelectionCache()
 
   QVector<Node::ContextPair> sel_with_ctx(current_selection.size());
 
+  // Use sets for membership so this stays linear when thousands of nodes are (de)selected at once
+  QSet<Node*> previous_selection;
+  previous_selection.reserve(selected_nodes_.size());
+  foreach (Node *n, selected_nodes_) {
+    previous_selection.insert(n);
+  }
+
+  QSet<Node*> still_selected;
+  still_selected.reserve(current_selection.size());
+
   // Determine which nodes are newly selected
   for (int j=0; j<current_selection.size(); j++) {
     NodeViewItem *i = current_selection.at(j);
     Node *n = i->GetNode();
-    if (!selected_nodes_.contains(n)) {
-      selected.append(n);
-      selected_nodes_.append(n);
+    if (!still_selected.contains(n)) {
+      still_selected.insert(n);
+
+      if (!previous_selection.contains(n)) {
+        selected.append(n);
+      }
     }
 
     sel_with_ctx[j] = {n, i->GetContext()};
   }
 
-  // Determine which nodes are newly deselected
-  if (current_selection.isEmpty()) {
-    // All nodes that were selected have been deselected, so we'll just set them all to `deselected`
-    deselected = selected_nodes_;
-    selected_nodes_.clear();
-  } else {
-    foreach (Node* n, selected_nodes_) {
-      bool still_selected = false;
-
-      foreach (NodeViewItem *i, current_selection) {
-        if (i->GetNode() == n) {
-          still_selected = true;
-          break;
-        }
-      }
-
-      if (!still_selected) {
-        deselected.append(n);
-        selected_nodes_.removeOne(n);
-      }
+  // Determine which nodes are newly deselected, keeping the order of those that remain
+  QVector<Node*> new_selected_nodes;
+  new_selected_nodes.reserve(still_selected.size());
+  foreach (Node* n, selected_nodes_) {
+    if (still_selected.contains(n)) {
+      new_selected_nodes.append(n);
+    } else {
+      deselected.append(n);
     }
   }
+  new_selected_nodes.append(selected);
+  selected_nodes_ = new_selected_nodes;
 
   if (!deselected.isEmpty()) {
     emit NodesDeselected(deselected);
@@ -893,7 +904,14 @@ void NodeView::OpenSelectedNodeInViewer()
 void NodeView::UpdateSceneBoundingRect()
 {
   // Get current items bounding rect
-  QRectF r = scene_.itemsBoundingRect();
+  items_bounding_rect_ = scene_.itemsBoundingRect();
+
+  ApplySceneBoundingRect();
+}
+
+void NodeView::ApplySceneBoundingRect()
+{
+  QRectF r = items_bounding_rect_;
 
   // Adjust so that it fills the view
   r.adjust(-width(), -height(), width(), height());
@@ -902,6 +920,29 @@ void NodeView::UpdateSceneBoundingRect()
   scene_.setSceneRect(r);
 }
 
+void NodeView::SceneChanged(const QList<QRectF> &region)
+{
+  // Grow immediately if something was drawn outside the current scene rect
+  QRectF scene_rect = scene_.sceneRect();
+  bool grew = false;
+
+  foreach (const QRectF &r, region) {
+    if (!scene_rect.contains(r)) {
+      items_bounding_rect_ |= r;
+      grew = true;
+    }
+  }
+
+  if (grew) {
+    ApplySceneBoundingRect();
+  }
+
+  // The full recompute (which can also shrink the rect) only happens once per interval
+  if (!scene_bounds_timer_.isActive()) {
+    scene_bounds_timer_.start();
+  }
+}
+
 void NodeView::CenterOnItemsBoundingRect()
 {
   centerOn(scene_.itemsBoundingRect().center());
@@ -237,6 +237,14 @@ private:
 
   static const int kMaximumContexts;
 
+  static const int kSceneBoundsUpdateInterval;
+
+  QRectF items_bounding_rect_;
+
+  QTimer scene_bounds_timer_;
+
+  void ApplySceneBoundingRect();
+
 private slots:
   /**
    * @brief Receiver for when the scene's selected items change
@@ -265,6 +273,8 @@ private slots:
 
   void UpdateSceneBoundingRect();
 
+  void SceneChanged(const QList<QRectF> &region);
+
   void RepositionMiniMap();
 
   void UpdateViewportOnMiniMap();
@@ -55,6 +55,13 @@ public:
     return dir == kLeftToRight || dir == kRightToLeft;
   }
 
+  /**
+   * @brief Zoom level below which items draw simplified versions of themselves
+   *
+   * At this size text is unreadable anyway, so skipping it keeps panning around large graphs fast.
+   */
+  static constexpr double kSimplifiedLevelOfDetail = 0.35;
+
   static bool DirectionsAreOpposing(FlowDirection a, FlowDirection b) {
     return ((a == NodeViewCommon::kLeftToRight && b == NodeViewCommon::kRightToLeft)
             || (a == NodeViewCommon::kRightToLeft && b == NodeViewCommon::kLeftToRight)
@@ -22,7 +22,8 @@ namespace olive {
 
 NodeViewContext::NodeViewContext(Node *context, QGraphicsItem *item) :
   super(item),
-  context_(context)
+  context_(context),
+  rect_update_queued_(false)
 {
   Block *block = dynamic_cast<Block*>(context_);
   if (block && block->track() && block->track()->sequence()) {
@@ -41,6 +42,9 @@ NodeViewContext::NodeViewContext(Node *context, QGraphicsItem *item) :
     AddChild(it.key());
   }
 
+  // Callers place the context based on its rect, so this one can't wait
+  UpdateRect();
+
   connect(context_, &Node::NodeAddedToContext, this, &NodeViewContext::AddChild, Qt::DirectConnection);
   connect(context_, &Node::NodePositionInContextChanged, this, &NodeViewContext::SetChildPosition, Qt::DirectConnection);
   connect(context_, &Node::NodeRemovedFromContext, this, &NodeViewContext::RemoveChild, Qt::DirectConnection);
@@ -74,7 +78,7 @@ void NodeViewContext::AddChild(Node *node)
     connect(group, &NodeGroup::NodeRemovedFromContext, this, &NodeViewContext::GroupRemovedNode);
   }
 
-  UpdateRect();
+  QueueRectUpdate();
 }
 
 void NodeViewContext::SetChildPosition(Node *node, const QPointF &pos)
@@ -125,7 +129,7 @@ void NodeViewContext::RemoveChild(Node *node)
     delete item;
   }
 
-  UpdateRect();
+  QueueRectUpdate();
 }
 
 void NodeViewContext::ChildInputConnected(Node *output, const NodeInput &input)
@@ -173,6 +177,20 @@ void NodeViewContext::UpdateRect()
   last_titlebar_height_ = rect.y() + (cbr.y() - rect.y()) - pad;
 }
 
+void NodeViewContext::QueueRectUpdate()
+{
+  if (!rect_update_queued_) {
+    rect_update_queued_ = true;
+    QMetaObject::invokeMethod(this, "ProcessQueuedRectUpdate", Qt::QueuedConnection);
+  }
+}
+
+void NodeViewContext::ProcessQueuedRectUpdate()
+{
+  rect_update_queued_ = false;
+  UpdateRect();
+}
+
 void NodeViewContext::SetFlowDirection(NodeViewCommon::FlowDirection dir)
 {
   flow_dir_ = dir;
@@ -26,6 +26,14 @@ public:
 
   void UpdateRect();
 
+  /**
+   * @brief Update the rect once control returns to the event loop
+   *
+   * UpdateRect() walks every child item, so when many nodes are added, removed or moved at once
+   * this coalesces them into a single update.
+   */
+  void QueueRectUpdate();
+
   void SetFlowDirection(NodeViewCommon::FlowDirection dir);
 
   void SetCurvedEdges(bool e);
@@ -83,7 +91,11 @@ private:
 
   QVector<NodeViewEdge*> edges_;
 
+  bool rect_update_queued_;
+
 private slots:
+  void ProcessQueuedRectUpdate();
+
   void GroupAddedNode(Node *node);
 
   void GroupRemovedNode(Node *node);
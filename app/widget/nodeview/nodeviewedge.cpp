@@ -156,7 +156,13 @@ void NodeViewEdge::paint(QPainter *painter, const QStyleOptionGraphicsItem *opti
 
   painter->setPen(QPen(edge_color, edge_width_));
   painter->setBrush(Qt::NoBrush);
-  painter->drawPath(path());
+
+  if (QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()) < NodeViewCommon::kSimplifiedLevelOfDetail) {
+    // Curves aren't distinguishable at this size, a straight line is much cheaper to draw
+    painter->drawLine(cached_start_, cached_end_);
+  } else {
+    painter->drawPath(path());
+  }
 }
 
 void NodeViewEdge::Init()
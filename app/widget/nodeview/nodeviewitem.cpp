@@ -338,6 +338,16 @@ void NodeViewItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opti
   QRectF single_unit_rect = rect();
   single_unit_rect.setHeight(DefaultItemHeight());
 
+  if (QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()) < NodeViewCommon::kSimplifiedLevelOfDetail) {
+    // Zoomed too far out to read anything, just draw a block in the node's color
+    if (IsOutputItem()) {
+      painter->setPen((option->state & QStyle::State_Selected) ? QPen(app_pal.color(QPalette::Highlight), node_border_width_) : Qt::NoPen);
+      painter->setBrush(QtUtils::toQColor(node_->color()));
+      painter->drawRect(rect());
+    }
+    return;
+  }
+
   if (IsOutputItem()) {
     // Set output item colors
     painter->setPen(Qt::black);
@@ -498,7 +508,7 @@ void NodeViewItem::UpdateContextRect()
 
   while (item) {
     if (NodeViewContext *ctx = dynamic_cast<NodeViewContext*>(item)) {
-      ctx->UpdateRect();
+      ctx->QueueRectUpdate();
       break;
     }
 
@@ -52,17 +52,19 @@ void NodeViewScene::SelectAll()
 
 void NodeViewScene::DeselectAll()
 {
-  foreach (QGraphicsItem* i, items()) {
-    i->setSelected(false);
-  }
+  clearSelection();
 }
 
 QVector<NodeViewItem *> NodeViewScene::GetSelectedItems() const
 {
   QVector<NodeViewItem *> items;
 
-  foreach (NodeViewContext *ctx, context_map_) {
-    items.append(ctx->GetSelectedItems());
+  // Only walk what's actually selected rather than every item in every context
+  foreach (QGraphicsItem* i, selectedItems()) {
+    NodeViewItem *item = dynamic_cast<NodeViewItem*>(i);
+    if (item && item->IsOutputItem()) {
+      items.append(item);
+    }
   }
 
   return items;
@@ -35,6 +35,7 @@
 #include "dialog/sequence/sequence.h"
 #include "projectexplorerundo.h"
 #include "task/precache/precachetask.h"
+#include "task/proxy/proxy.h"
 #include "task/taskmanager.h"
 #include "widget/menu/menu.h"
 #include "widget/menu/menushared.h"
@@ -66,7 +67,6 @@ ProjectExplorer::ProjectExplorer(QWidget *parent) :
 
   // Set up sort filter proxy model
   sort_model_.setSourceModel(&model_);
-  sort_model_.setFilterCaseSensitivity(Qt::CaseInsensitive);
   sort_model_.setSortRole(ProjectViewModel::kInnerTextRole);
 
   // Add tree view to stacked widget
@@ -303,7 +303,7 @@ void ProjectExplorer::RenameSelectedItem()
 
 void ProjectExplorer::SetSearchFilter(const QString &s)
 {
-  sort_model_.setFilterFixedString(s);
+  sort_model_.SetSearchFilter(s);
 }
 
 void ProjectExplorer::ShowContextMenu()
@@ -399,6 +399,16 @@ void ProjectExplorer::ShowContextMenu()
 
         connect(proxy_menu, &Menu::triggered, this, &ProjectExplorer::ContextMenuStartProxy);
       }
+
+      Menu* create_proxy_menu = new Menu(tr("Create Proxy"), &menu);
+      menu.addMenu(create_proxy_menu);
+
+      for (int divider=2; divider<=8; divider*=2) {
+        QAction* a = create_proxy_menu->addAction(tr("1/%1 Resolution").arg(divider));
+        a->setData(divider);
+      }
+
+      connect(create_proxy_menu, &Menu::triggered, this, &ProjectExplorer::ContextMenuCreateProxy);
     }
 
     Q_UNUSED(all_items_are_footage_or_sequence)
@@ -523,6 +533,53 @@ void ProjectExplorer::ContextMenuStartProxy(QAction *a)
   }
 }
 
+void ProjectExplorer::ContextMenuCreateProxy(QAction *a)
+{
+  int divider = a->data().toInt();
+
+  // To get here, the `context_menu_items_` must be all kFootage
+  foreach (Node* item, context_menu_items_) {
+    Footage* f = static_cast<Footage*>(item);
+
+    int sz = f->InputArraySize(Footage::kVideoParamsInput);
+
+    for (int j=0; j<sz; j++) {
+      VideoParams vp = f->GetVideoParams(j);
+
+      if (vp.enabled() && vp.video_type() == VideoParams::kVideoTypeVideo) {
+        ProxyTask* proxy_task = new ProxyTask(f, j, divider);
+
+        // Record the proxy on the footage once it's ready. Using the footage as context means nothing happens if
+        // it's deleted in the meantime.
+        QString proxy_filename = proxy_task->GetOutputFilename();
+        connect(proxy_task, &ProxyTask::Finished, f, [f, j, proxy_filename, divider](Task *, bool succeeded){
+          if (succeeded) {
+            auto command = new MultiUndoCommand();
+
+            QString old_filename;
+            int old_divider = 0;
+
+            if (f->InputArraySize(Footage::kProxyFilenameInput) <= j) {
+              command->add_child(new NodeArrayResizeCommand(f, Footage::kProxyFilenameInput, j + 1));
+              command->add_child(new NodeArrayResizeCommand(f, Footage::kProxyDividerInput, j + 1));
+            } else {
+              old_filename = f->GetStandardValue(Footage::kProxyFilenameInput, j).toString();
+              old_divider = f->GetStandardValue(Footage::kProxyDividerInput, j).toInt();
+            }
+
+            command->add_child(new NodeParamSetStandardValueCommand(NodeKeyframeTrackReference(NodeInput(f, Footage::kProxyDividerInput, j)), divider, old_divider));
+            command->add_child(new NodeParamSetStandardValueCommand(NodeKeyframeTrackReference(NodeInput(f, Footage::kProxyFilenameInput, j)), proxy_filename, old_filename));
+
+            Core::instance()->undo_stack()->push(command, tr("Created Proxy For \"%1\"").arg(f->GetLabel()));
+          }
+        });
+
+        TaskManager::instance()->AddTask(proxy_task);
+      }
+    }
+  }
+}
+
 void ProjectExplorer::ViewSelectionChanged()
 {
   QItemSelectionModel *model = static_cast<QItemSelectionModel *>(sender());
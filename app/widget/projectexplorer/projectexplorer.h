@@ -21,12 +21,12 @@
 #ifndef PROJECTEXPLORER_H
 #define PROJECTEXPLORER_H
 
-#include <QSortFilterProxyModel>
 #include <QStackedWidget>
 #include <QTimer>
 #include <QTreeView>
 
 #include "node/project.h"
+#include "projectsortfiltermodel.h"
 #include "projectviewmodel.h"
 #include "widget/projectexplorer/projectexplorericonview.h"
 #include "widget/projectexplorer/projectexplorerlistview.h"
@@ -161,7 +161,7 @@ private:
 
   ProjectToolbar::ViewType view_type_;
 
-  QSortFilterProxyModel sort_model_;
+  ProjectSortFilterModel sort_model_;
   ProjectViewModel model_;
 
   QVector<Node*> context_menu_items_;
@@ -189,6 +189,8 @@ private slots:
 
   void ContextMenuStartProxy(QAction* a);
 
+  void ContextMenuCreateProxy(QAction* a);
+
   void ViewSelectionChanged();
 
 };
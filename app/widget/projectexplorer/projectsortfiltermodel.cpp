@@ -0,0 +1,243 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "projectsortfiltermodel.h"
+
+#include <QFileInfo>
+
+#include "node/project/footage/footage.h"
+#include "node/project/folder/folder.h"
+
+namespace olive {
+
+#define super QSortFilterProxyModel
+
+ProjectSortFilterModel::ProjectSortFilterModel(QObject *parent) :
+  super(parent)
+{
+}
+
+void ProjectSortFilterModel::setSourceModel(QAbstractItemModel *source_model)
+{
+  if (sourceModel()) {
+    disconnect(sourceModel(), &QAbstractItemModel::dataChanged, this, &ProjectSortFilterModel::SourceDataChanged);
+    disconnect(sourceModel(), &QAbstractItemModel::rowsAboutToBeRemoved, this, &ProjectSortFilterModel::SourceRowsAboutToBeRemoved);
+    disconnect(sourceModel(), &QAbstractItemModel::modelAboutToBeReset, this, &ProjectSortFilterModel::ClearCaches);
+  }
+
+  ClearCaches();
+
+  // Connect before the base class does so our caches are already invalidated when it re-sorts or re-filters
+  if (source_model) {
+    connect(source_model, &QAbstractItemModel::dataChanged, this, &ProjectSortFilterModel::SourceDataChanged);
+    connect(source_model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &ProjectSortFilterModel::SourceRowsAboutToBeRemoved);
+    connect(source_model, &QAbstractItemModel::modelAboutToBeReset, this, &ProjectSortFilterModel::ClearCaches);
+  }
+
+  super::setSourceModel(source_model);
+}
+
+void ProjectSortFilterModel::sort(int column, Qt::SortOrder order)
+{
+  // Dates come from the file system and may have changed since we last looked, so an explicit sort re-reads every
+  // key once rather than trusting the cache
+  for (int i=0; i<ProjectViewModel::kColumnCount; i++) {
+    sort_keys_[i].clear();
+  }
+
+  super::sort(column, order);
+}
+
+void ProjectSortFilterModel::SetSearchFilter(const QString &s)
+{
+  QString filter = s.toLower();
+
+  if (filter == search_filter_) {
+    return;
+  }
+
+  if (!search_filter_.isEmpty() && filter.startsWith(search_filter_)) {
+    // Appending to the search can only narrow the results, so anything that was rejected stays rejected and only the
+    // previous matches need testing again
+    for (auto it=match_cache_.begin(); it!=match_cache_.end(); ) {
+      if (it.value()) {
+        it = match_cache_.erase(it);
+      } else {
+        it++;
+      }
+    }
+  } else {
+    match_cache_.clear();
+  }
+
+  search_filter_ = filter;
+
+  search_tokens_.clear();
+  foreach (const QString &t, filter.split(' ')) {
+    if (!t.isEmpty()) {
+      search_tokens_.append(t);
+    }
+  }
+
+  invalidateFilter();
+}
+
+bool ProjectSortFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+{
+  if (search_tokens_.isEmpty()) {
+    return true;
+  }
+
+  Node *n = GetNodeFromSourceIndex(sourceModel()->index(source_row, 0, source_parent));
+  if (!n) {
+    return true;
+  }
+
+  auto cached = match_cache_.constFind(n);
+  if (cached != match_cache_.constEnd()) {
+    return cached.value();
+  }
+
+  const QString &text = GetSearchText(n);
+
+  bool matches = true;
+  foreach (const QString &t, search_tokens_) {
+    if (!text.contains(t)) {
+      matches = false;
+      break;
+    }
+  }
+
+  match_cache_.insert(n, matches);
+
+  return matches;
+}
+
+bool ProjectSortFilterModel::lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const
+{
+  const QVariant &left = GetSortKey(source_left);
+  const QVariant &right = GetSortKey(source_right);
+
+  // Match QSortFilterProxyModel's default ordering, which places empty values last
+  if (left.isNull()) {
+    return false;
+  } else if (right.isNull()) {
+    return true;
+  }
+
+  if (left.userType() == QMetaType::LongLong && right.userType() == QMetaType::LongLong) {
+    return left.toLongLong() < right.toLongLong();
+  }
+
+  if (isSortLocaleAware()) {
+    return left.toString().localeAwareCompare(right.toString()) < 0;
+  } else {
+    return left.toString().compare(right.toString(), sortCaseSensitivity()) < 0;
+  }
+}
+
+Node *ProjectSortFilterModel::GetNodeFromSourceIndex(const QModelIndex &index)
+{
+  return static_cast<Node*>(index.internalPointer());
+}
+
+const QString &ProjectSortFilterModel::GetSearchText(Node *n) const
+{
+  auto it = search_text_.find(n);
+
+  if (it == search_text_.end()) {
+    QString text = n->GetLabel();
+
+    if (Footage *f = dynamic_cast<Footage*>(n)) {
+      text.append('\n');
+      text.append(QFileInfo(f->filename()).fileName());
+    }
+
+    it = search_text_.insert(n, text.toLower());
+  }
+
+  return it.value();
+}
+
+const QVariant &ProjectSortFilterModel::GetSortKey(const QModelIndex &source_index) const
+{
+  QHash<Node*, QVariant> &keys = sort_keys_[source_index.column()];
+  Node *n = GetNodeFromSourceIndex(source_index);
+
+  auto it = keys.find(n);
+
+  if (it == keys.end()) {
+    it = keys.insert(n, sourceModel()->data(source_index, sortRole()));
+  }
+
+  return it.value();
+}
+
+void ProjectSortFilterModel::ForgetItem(Node *n)
+{
+  search_text_.remove(n);
+  match_cache_.remove(n);
+
+  for (int i=0; i<ProjectViewModel::kColumnCount; i++) {
+    sort_keys_[i].remove(n);
+  }
+
+  if (Folder *f = dynamic_cast<Folder*>(n)) {
+    foreach (Node *c, f->children()) {
+      ForgetItem(c);
+    }
+  }
+}
+
+void ProjectSortFilterModel::ClearCaches()
+{
+  search_text_.clear();
+  match_cache_.clear();
+
+  for (int i=0; i<ProjectViewModel::kColumnCount; i++) {
+    sort_keys_[i].clear();
+  }
+}
+
+void ProjectSortFilterModel::SourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right)
+{
+  for (int i=top_left.row(); i<=bottom_right.row(); i++) {
+    if (Node *n = GetNodeFromSourceIndex(sourceModel()->index(i, 0, top_left.parent()))) {
+      search_text_.remove(n);
+      match_cache_.remove(n);
+
+      for (int j=0; j<ProjectViewModel::kColumnCount; j++) {
+        sort_keys_[j].remove(n);
+      }
+    }
+  }
+}
+
+void ProjectSortFilterModel::SourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+  // Items may be deleted after removal and their addresses reused, so nothing about them can stay cached
+  for (int i=first; i<=last; i++) {
+    if (Node *n = GetNodeFromSourceIndex(sourceModel()->index(i, 0, parent))) {
+      ForgetItem(n);
+    }
+  }
+}
+
+}
@@ -0,0 +1,90 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef PROJECTSORTFILTERMODEL_H
+#define PROJECTSORTFILTERMODEL_H
+
+#include <QHash>
+#include <QSortFilterProxyModel>
+#include <QStringList>
+
+#include "projectviewmodel.h"
+
+namespace olive {
+
+/**
+ * @brief Sort/filter proxy for ProjectViewModel that caches per-item search text and sort keys
+ *
+ * A plain QSortFilterProxyModel asks the source model for data on every comparison and every filter test, which for
+ * footage means a file stat per comparison when sorting by date and a regex match per row when searching. This proxy
+ * resolves each item's lowercased search text (label and file name) and sort keys once, drops them when the source
+ * reports the item changed, and reuses previous filter results while the search text is only being extended.
+ */
+class ProjectSortFilterModel : public QSortFilterProxyModel
+{
+  Q_OBJECT
+public:
+  ProjectSortFilterModel(QObject *parent = nullptr);
+
+  virtual void setSourceModel(QAbstractItemModel *source_model) override;
+
+  virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+  /**
+   * @brief Show only items containing every whitespace-separated word of `s` (case insensitive)
+   */
+  void SetSearchFilter(const QString &s);
+
+protected:
+  virtual bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+
+  virtual bool lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const override;
+
+private:
+  static Node *GetNodeFromSourceIndex(const QModelIndex &index);
+
+  const QString &GetSearchText(Node *n) const;
+
+  const QVariant &GetSortKey(const QModelIndex &source_index) const;
+
+  void ForgetItem(Node *n);
+
+  void ClearCaches();
+
+  QString search_filter_;
+
+  QStringList search_tokens_;
+
+  mutable QHash<Node*, QString> search_text_;
+
+  mutable QHash<Node*, bool> match_cache_;
+
+  mutable QHash<Node*, QVariant> sort_keys_[ProjectViewModel::kColumnCount];
+
+private slots:
+  void SourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right);
+
+  void SourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+
+};
+
+}
+
+#endif // PROJECTSORTFILTERMODEL_H
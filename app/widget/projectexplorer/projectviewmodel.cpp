@@ -22,6 +22,7 @@
 
 #include <QDebug>
 #include <QMimeData>
+#include <QSet>
 #include <QUrl>
 
 #include "common/qtutils.h"
@@ -294,13 +295,13 @@ QMimeData *ProjectViewModel::mimeData(const QModelIndexList &indexes) const
 
   // The indexes list includes indexes for each column which we don't use. To make sure each row only gets sent *once*,
   // we keep a list of dragged items
-  QVector<void*> dragged_items;
+  QSet<void*> dragged_items;
 
   foreach (QModelIndex index, indexes) {
     if (index.isValid()) {
       // Check if we've dragged this item before
       if (!dragged_items.contains(index.internalPointer())) {
-        // If not, add it to the stream (and also keep track of it in the vector)
+        // If not, add it to the stream (and also keep track of it in the set)
         Node *item = static_cast<Node*>(index.internalPointer());
         QVector<Track::Reference> streams;
 
@@ -310,7 +311,7 @@ QMimeData *ProjectViewModel::mimeData(const QModelIndexList &indexes) const
 
         stream << streams << reinterpret_cast<quintptr>(item);
 
-        dragged_items.append(item);
+        dragged_items.insert(item);
       }
     }
   }
@@ -32,6 +32,7 @@ using namespace core;
 ElapsedCounterWidget::ElapsedCounterWidget(QWidget* parent) :
   QWidget(parent),
   last_progress_(0),
+  processed_count_(0),
   start_time_(0)
 {
   QHBoxLayout* layout = new QHBoxLayout(this);
@@ -44,6 +45,10 @@ ElapsedCounterWidget::ElapsedCounterWidget(QWidget* parent) :
   remaining_lbl_ = new QLabel();
   layout->addWidget(remaining_lbl_);
 
+  throughput_lbl_ = new QLabel();
+  throughput_lbl_->setVisible(false);
+  layout->addWidget(throughput_lbl_);
+
   elapsed_timer_.setInterval(500);
   connect(&elapsed_timer_, &QTimer::timeout, this, &ElapsedCounterWidget::UpdateTimers);
   UpdateTimers();
@@ -55,6 +60,14 @@ void ElapsedCounterWidget::SetProgress(double d)
   UpdateTimers();
 }
 
+void ElapsedCounterWidget::SetProcessedCount(qint64 count, const QString &unit)
+{
+  processed_count_ = count;
+  processed_unit_ = unit;
+  throughput_lbl_->setVisible(!unit.isEmpty());
+  UpdateTimers();
+}
+
 void ElapsedCounterWidget::Start()
 {
   Start(QDateTime::currentMSecsSinceEpoch());
@@ -90,6 +103,18 @@ void ElapsedCounterWidget::UpdateTimers()
 
   elapsed_lbl_->setText(tr("Elapsed: %1").arg(QString::fromStdString(Timecode::time_to_string(elapsed_ms))));
   remaining_lbl_->setText(tr("Remaining: %1").arg(QString::fromStdString(Timecode::time_to_string(remaining_ms))));
+
+  if (throughput_lbl_->isVisible()) {
+    double rate = 0;
+    if (start_time_ > 0) {
+      qint64 running_ms = QDateTime::currentMSecsSinceEpoch() - start_time_;
+      if (running_ms > 0) {
+        rate = double(processed_count_) / (double(running_ms) * 0.001);
+      }
+    }
+
+    throughput_lbl_->setText(tr("Throughput: %1 %2/s").arg(QString::number(rate, 'f', 1), processed_unit_));
+  }
 }
 
 }
@@ -37,6 +37,11 @@ public:
 
   void SetProgress(double d);
 
+  /**
+   * @brief Show throughput as `count` of `unit` processed since Start()
+   */
+  void SetProcessedCount(qint64 count, const QString &unit);
+
 public slots:
   void Start(qint64 start_time);
   void Start();
@@ -49,8 +54,14 @@ private:
 
   QLabel* remaining_lbl_;
 
+  QLabel* throughput_lbl_;
+
   double last_progress_;
 
+  qint64 processed_count_;
+
+  QString processed_unit_;
+
   QTimer elapsed_timer_;
 
   qint64 start_time_;
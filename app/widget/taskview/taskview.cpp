@@ -52,6 +52,11 @@ void TaskView::AddTask(Task *t)
   layout_->insertWidget(layout_->count()-1, item);
 }
 
+void TaskView::TaskStarted(Task *t)
+{
+  items_.value(t)->Started();
+}
+
 void TaskView::TaskFailed(Task *t)
 {
   items_.value(t)->Failed();
@@ -53,6 +53,8 @@ public slots:
    */
   void AddTask(Task* t);
 
+  void TaskStarted(Task* t);
+
   void TaskFailed(Task* t);
 
   void RemoveTask(Task* t);
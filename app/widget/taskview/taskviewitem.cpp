@@ -69,12 +69,17 @@ TaskViewItem::TaskViewItem(Task* task, QWidget *parent) :
   task_error_lbl_ = new QLabel(this);
   status_stack_->addWidget(task_error_lbl_);
 
-  // Set up elapsed timer
-  status_stack_->setCurrentWidget(elapsed_timer_lbl_);
+  // Create queued label
+  queued_lbl_ = new QLabel(tr("Queued"), this);
+  status_stack_->addWidget(queued_lbl_);
+
+  // Tasks are shown as queued until the TaskManager gives them a thread
+  status_stack_->setCurrentWidget(queued_lbl_);
 
   // Connect to the task
   connect(task_, &Task::Started, elapsed_timer_lbl_, qOverload<qint64>(&ElapsedCounterWidget::Start));
   connect(task_, &Task::ProgressChanged, this, &TaskViewItem::UpdateProgress);
+  connect(task_, &Task::ProcessedCountChanged, this, &TaskViewItem::UpdateProcessedCount);
   connect(cancel_btn_, &QPushButton::clicked, this, [this] { emit TaskCancelled(task_); });
 }
 
@@ -85,10 +90,22 @@ void TaskViewItem::Failed()
   task_error_lbl_->setText(tr("Error: %1").arg(task_->GetError()));
 }
 
+void TaskViewItem::Started()
+{
+  if (status_stack_->currentWidget() == queued_lbl_) {
+    status_stack_->setCurrentWidget(elapsed_timer_lbl_);
+  }
+}
+
 void TaskViewItem::UpdateProgress(double d)
 {
   progress_bar_->setValue(qRound(100.0 * d));
   elapsed_timer_lbl_->SetProgress(d);
 }
 
+void TaskViewItem::UpdateProcessedCount(qint64 count)
+{
+  elapsed_timer_lbl_->SetProcessedCount(count, task_->GetProcessedUnit());
+}
+
 }
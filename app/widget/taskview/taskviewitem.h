@@ -49,6 +49,11 @@ public:
 
   void Failed();
 
+  /**
+   * @brief Switch from showing the Task as queued to showing its elapsed/remaining time
+   */
+  void Started();
+
 signals:
   void TaskCancelled(Task* t);
 
@@ -60,12 +65,15 @@ private:
   QStackedWidget* status_stack_;
   ElapsedCounterWidget* elapsed_timer_lbl_;
   QLabel* task_error_lbl_;
+  QLabel* queued_lbl_;
 
   Task* task_;
 
 private slots:
   void UpdateProgress(double d);
 
+  void UpdateProcessedCount(qint64 count);
+
 };
 
 }
@@ -1205,12 +1205,16 @@ void TimelineWidget::RemoveTrack(Track *track)
 
 void TimelineWidget::TrackUpdated()
 {
-  UpdateViewports(static_cast<Track*>(sender())->type());
+  Track *track = static_cast<Track*>(sender());
+
+  views_.at(track->type())->view()->InvalidateBlockLayer(track);
 }
 
 void TimelineWidget::BlockUpdated()
 {
-  UpdateViewports(static_cast<Block*>(sender())->track()->type());
+  Track *track = static_cast<Block*>(sender())->track();
+
+  views_.at(track->type())->view()->InvalidateBlockLayer(track);
 }
 
 void TimelineWidget::UpdateHorizontalSplitters()
@@ -1385,13 +1389,13 @@ void TimelineWidget::AddableObjectChanged()
 void TimelineWidget::SetViewWaveformsEnabled(bool e)
 {
   OLIVE_CONFIG("TimelineWaveformMode") = e ? Timeline::kWaveformsEnabled : Timeline::kWaveformsDisabled;
-  UpdateViewports();
+  InvalidateBlockLayers();
 }
 
 void TimelineWidget::SetViewThumbnailsEnabled(QAction *action)
 {
   OLIVE_CONFIG("TimelineThumbnailMode") = action->data();
-  UpdateViewports();
+  InvalidateBlockLayers();
 }
 
 void TimelineWidget::FrameRateChanged()
@@ -1932,6 +1936,13 @@ void TimelineWidget::UpdateViewports(const Track::Type &type)
   }
 }
 
+void TimelineWidget::InvalidateBlockLayers()
+{
+  foreach (TimelineAndTrackView* tview, views_) {
+    tview->view()->InvalidateBlockLayer();
+  }
+}
+
 bool TimelineWidget::PasteInternal(bool insert)
 {
   if (!GetConnectedNode()) {
@@ -2163,15 +2174,17 @@ void TimelineWidget::SetSelections(const TimelineWidgetSelections &s, bool proce
       }
     }
 
-    // NOTE: This loop could do with some optimization
     for (auto it=s.cbegin(); it!=s.cend(); it++) {
       Track *track = GetTrackFromReference(it.key());
       if (track) {
         const TimeRangeList &ranges = it.value();
 
-        foreach (Block *b, track->Blocks()) {
-          if (!selected_blocks_.contains(b) && ranges.contains(b->range())) {
-            selected.append(b);
+        // Only blocks overlapping a selected range can be inside it
+        for (const TimeRange &r : ranges) {
+          foreach (Block *b, track->BlocksInRange(r)) {
+            if (!selected_blocks_.contains(b) && ranges.contains(b->range())) {
+              selected.append(b);
+            }
           }
         }
       }
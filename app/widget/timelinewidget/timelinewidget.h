@@ -311,6 +311,8 @@ private:
 
   void UpdateViewports(const Track::Type& type = Track::kNone);
 
+  void InvalidateBlockLayers();
+
   bool PasteInternal(bool insert);
 
   TimelineAndTrackView *AddTimelineAndTrackView(Qt::Alignment alignment);
@@ -0,0 +1,137 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "thumbnailatlas.h"
+
+#include <QRunnable>
+
+#include "render/diskmanager.h"
+
+namespace olive {
+
+// Decoded thumbnails are small, this holds several thousand of them
+const int ThumbnailAtlas::kMemoryBudget = 64 * 1024 * 1024;
+
+const int ThumbnailAtlas::kPrefetchPriority = -1;
+
+namespace {
+
+class ThumbnailLoader : public QRunnable
+{
+public:
+  ThumbnailLoader(ThumbnailAtlas *atlas, const QString &filename, const QString &key) :
+    atlas_(atlas),
+    filename_(filename),
+    key_(key)
+  {
+  }
+
+  virtual void run() override
+  {
+    QImage img;
+    img.load(filename_, "jpg");
+
+    // Queued, so the atlas is only ever touched from its own thread. The atlas waits for all
+    // loaders before it's destroyed.
+    QMetaObject::invokeMethod(atlas_, "ImageLoaded", Qt::QueuedConnection,
+                              Q_ARG(QString, key_), Q_ARG(QString, filename_), Q_ARG(QImage, img));
+  }
+
+private:
+  ThumbnailAtlas *atlas_;
+
+  QString filename_;
+
+  QString key_;
+
+};
+
+}
+
+ThumbnailAtlas::ThumbnailAtlas(QObject *parent) :
+  QObject(parent),
+  images_(kMemoryBudget)
+{
+  // Loading is mostly waiting on storage, a couple of threads is plenty and leaves the rest of the
+  // machine for rendering
+  pool_.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+}
+
+ThumbnailAtlas::~ThumbnailAtlas()
+{
+  pool_.clear();
+  pool_.waitForDone();
+}
+
+const QImage *ThumbnailAtlas::Get(const QString &cache_directory, const QString &filename, quint64 generation)
+{
+  QString key = GetKey(filename, generation);
+
+  if (const QImage *img = images_.object(key)) {
+    return img;
+  }
+
+  Queue(cache_directory, filename, key, 0);
+  return nullptr;
+}
+
+void ThumbnailAtlas::Prefetch(const QString &cache_directory, const QString &filename, quint64 generation)
+{
+  QString key = GetKey(filename, generation);
+
+  if (!images_.contains(key)) {
+    Queue(cache_directory, filename, key, kPrefetchPriority);
+  }
+}
+
+QString ThumbnailAtlas::GetKey(const QString &filename, quint64 generation)
+{
+  return QStringLiteral("%1#%2").arg(filename, QString::number(generation));
+}
+
+void ThumbnailAtlas::Queue(const QString &cache_directory, const QString &filename, const QString &key, int priority)
+{
+  if (pending_.contains(key)) {
+    return;
+  }
+
+  pending_.insert(key);
+
+  // We're about to read this file, so let the disk manager know it's still in use
+  if (DiskManager::instance()) {
+    QMetaObject::invokeMethod(DiskManager::instance(), "Accessed", Q_ARG(QString, cache_directory), Q_ARG(QString, filename));
+  }
+
+  pool_.start(new ThumbnailLoader(this, filename, key), priority);
+}
+
+void ThumbnailAtlas::ImageLoaded(const QString &key, const QString &filename, const QImage &image)
+{
+  pending_.remove(key);
+
+  // Failed loads aren't cached, the file may still be being written and will be retried the next
+  // time it's needed
+  if (!image.isNull()) {
+    images_.insert(key, new QImage(image), qMax(1, image.bytesPerLine() * image.height()));
+    emit ImageReady(filename);
+  }
+}
+
+}
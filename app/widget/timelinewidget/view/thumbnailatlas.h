@@ -0,0 +1,98 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef THUMBNAILATLAS_H
+#define THUMBNAILATLAS_H
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+#include "common/define.h"
+
+namespace olive {
+
+/**
+ * @brief In-memory store of decoded timeline thumbnails
+ *
+ * Thumbnails are cached on disk as JPEGs. Loading them in the paint path stalls every repaint on
+ * disk (or network) I/O, so TimelineView asks this atlas instead. Images that are already decoded
+ * are returned immediately, anything else is decoded on a background thread and ImageReady() is
+ * emitted once it can be drawn. Decoded images are kept in an LRU cache bounded by memory.
+ */
+class ThumbnailAtlas : public QObject
+{
+  Q_OBJECT
+public:
+  ThumbnailAtlas(QObject *parent = nullptr);
+
+  virtual ~ThumbnailAtlas() override;
+
+  DISABLE_COPY_MOVE(ThumbnailAtlas)
+
+  /**
+   * @brief Get a decoded thumbnail, or nullptr if it isn't ready yet
+   *
+   * If the thumbnail isn't decoded, this queues it for loading. The returned pointer is only
+   * valid until the next call into the atlas.
+   *
+   * Thumbnails are re-rendered into the same filenames, so `generation` should be the cache's
+   * FrameHashCache::GetGeneration(). Images decoded under an older generation are never returned.
+   */
+  const QImage *Get(const QString &cache_directory, const QString &filename, quint64 generation);
+
+  /**
+   * @brief Queue a thumbnail for loading without needing it immediately
+   *
+   * Prefetches are decoded after any thumbnails that are needed to paint.
+   */
+  void Prefetch(const QString &cache_directory, const QString &filename, quint64 generation);
+
+signals:
+  /**
+   * @brief Emitted when a thumbnail has been decoded and can be retrieved with Get()
+   */
+  void ImageReady(const QString &filename);
+
+private:
+  static QString GetKey(const QString &filename, quint64 generation);
+
+  void Queue(const QString &cache_directory, const QString &filename, const QString &key, int priority);
+
+  static const int kMemoryBudget;
+
+  static const int kPrefetchPriority;
+
+  QCache<QString, QImage> images_;
+
+  QSet<QString> pending_;
+
+  QThreadPool pool_;
+
+private slots:
+  void ImageLoaded(const QString &key, const QString &filename, const QImage &image);
+
+};
+
+}
+
+#endif // THUMBNAILATLAS_H
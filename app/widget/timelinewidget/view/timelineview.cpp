@@ -46,7 +46,15 @@ TimelineView::TimelineView(Qt::Alignment vertical_alignment, QWidget *parent) :
   show_beam_cursor_(false),
   connected_track_list_(nullptr),
   transition_overlay_out_(nullptr),
-  transition_overlay_in_(nullptr)
+  transition_overlay_in_(nullptr),
+  last_thumbnail_left_bound_(0),
+  thumbnail_scroll_direction_(1),
+  block_layer_left_(0),
+  block_layer_right_(0),
+  block_layer_scale_(0),
+  block_layer_dpr_(0),
+  draw_left_bound_(0),
+  draw_right_bound_(0)
 {
   Q_ASSERT(vertical_alignment == Qt::AlignTop || vertical_alignment == Qt::AlignBottom);
   setAlignment(Qt::AlignLeft | vertical_alignment);
@@ -57,6 +65,9 @@ TimelineView::TimelineView(Qt::Alignment vertical_alignment, QWidget *parent) :
   viewport()->setMouseTracking(true);
 
   SetIsTimelineAxes(true);
+
+  thumbnail_atlas_ = new ThumbnailAtlas(this);
+  connect(thumbnail_atlas_, &ThumbnailAtlas::ImageReady, this, &TimelineView::ThumbnailReady);
 }
 
 void TimelineView::mousePressEvent(QMouseEvent *event)
@@ -210,8 +221,9 @@ void TimelineView::drawForeground(QPainter *painter, const QRectF &rect)
     return;
   }
 
-  // Draw block backgrounds
-  DrawBlocks(painter, false);
+  // Draw block backgrounds from the cached layers, then anything that follows the scroll position
+  DrawBlockLayers(painter, rect);
+  DrawBlocks(painter, kStickyPass);
 
   // Draw selections
   if (selections_ && !selections_->isEmpty()) {
@@ -233,7 +245,7 @@ void TimelineView::drawForeground(QPainter *painter, const QRectF &rect)
   }
 
   // Draw block foregrounds
-  DrawBlocks(painter, true);
+  DrawBlocks(painter, kForegroundPass);
 
   // Draw ghosts
   if (ghosts_ && !ghosts_->isEmpty()) {
@@ -253,8 +265,9 @@ void TimelineView::drawForeground(QPainter *painter, const QRectF &rect)
           painter->setOpacity(0.5);
 
           rational in = ghost->GetAdjustedIn(), out = ghost->GetAdjustedOut(), media_in = ghost->GetAdjustedMediaIn();
-          DrawBlock(painter, false, attached, track_top, track_height, in, out, media_in);
-          DrawBlock(painter, true, attached, track_top, track_height, in, out, media_in);
+          DrawBlock(painter, kBackgroundPass, attached, track_top, track_height, in, out, media_in);
+          DrawBlock(painter, kStickyPass, attached, track_top, track_height, in, out, media_in);
+          DrawBlock(painter, kForegroundPass, attached, track_top, track_height, in, out, media_in);
 
           painter->setOpacity(old_opacity);
         }
@@ -376,10 +389,13 @@ TimelineViewMouseEvent TimelineView::CreateMouseEvent(const QPoint& pos, Qt::Mou
                                 modifiers);
 }
 
-void TimelineView::DrawBlocks(QPainter *painter, bool foreground)
+void TimelineView::DrawBlocks(QPainter *painter, BlockPass pass)
 {
-  rational start_time = SceneToTime(GetTimelineLeftBound());
-  rational end_time = SceneToTime(GetTimelineRightBound());
+  draw_left_bound_ = GetTimelineLeftBound();
+  draw_right_bound_ = GetTimelineRightBound();
+
+  rational start_time = SceneToTime(draw_left_bound_);
+  rational end_time = SceneToTime(draw_right_bound_);
 
   foreach (Track* track, connected_track_list_->GetTracks()) {
     // Get first visible block in this track
@@ -389,7 +405,7 @@ void TimelineView::DrawBlocks(QPainter *painter, bool foreground)
     qreal track_height = GetTrackHeight(track->Index());
 
     while (block) {
-      DrawBlock(painter, foreground, block, track_top, track_height);
+      DrawBlock(painter, pass, block, track_top, track_height);
 
       if (block->out() >= end_time) {
         // Rest of the clips are offscreen, can break loop now
@@ -401,14 +417,121 @@ void TimelineView::DrawBlocks(QPainter *painter, bool foreground)
   }
 }
 
-void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, qreal block_top, qreal block_height, const rational &in, const rational &out, const rational &media_in)
+void TimelineView::DrawBlockLayers(QPainter *painter, const QRectF &exposed)
+{
+  qreal left_bound = GetTimelineLeftBound();
+  qreal right_bound = GetTimelineRightBound();
+  qreal dpr = viewport()->devicePixelRatioF();
+
+  // Track which way we're scrolling so thumbnails can be prefetched ahead of the view
+  if (left_bound != last_thumbnail_left_bound_) {
+    thumbnail_scroll_direction_ = (left_bound > last_thumbnail_left_bound_) ? 1 : -1;
+    last_thumbnail_left_bound_ = left_bound;
+  }
+
+  // Layers cover the visible area plus half a viewport either side so that small scrolls (e.g.
+  // following the playhead) can be served without re-rendering. Anything else throws them out.
+  if (left_bound < block_layer_left_ || right_bound > block_layer_right_
+      || !qFuzzyCompare(GetScale(), block_layer_scale_) || dpr != block_layer_dpr_) {
+    qreal padding = viewport()->width() / 2;
+
+    // Every visible thumbnail is requested again as the layers are re-rendered
+    block_layers_.clear();
+    pending_thumbnails_.clear();
+    block_layer_left_ = left_bound - padding;
+    block_layer_right_ = right_bound + padding;
+    block_layer_scale_ = GetScale();
+    block_layer_dpr_ = dpr;
+  }
+
+  foreach (Track* track, connected_track_list_->GetTracks()) {
+    qreal track_top = GetTrackY(track->Index());
+    qreal track_height = GetTrackHeight(track->Index());
+
+    if (track_top + track_height < exposed.top() || track_top > exposed.bottom()) {
+      // Not being painted, leave whatever layer we have (if any) for later
+      continue;
+    }
+
+    BlockLayer &layer = block_layers_[track];
+    if (layer.pixmap.isNull() || layer.top != track_top || layer.height != track_height) {
+      layer.top = track_top;
+      layer.height = track_height;
+      RenderBlockLayer(track, &layer);
+    }
+
+    painter->drawPixmap(QPointF(block_layer_left_, track_top), layer.pixmap);
+  }
+}
+
+void TimelineView::RenderBlockLayer(Track *track, BlockLayer *layer)
+{
+  QSize sz(qCeil((block_layer_right_ - block_layer_left_) * block_layer_dpr_),
+           qMax(1, qCeil(layer->height * block_layer_dpr_)));
+
+  layer->pixmap = QPixmap(sz);
+  layer->pixmap.setDevicePixelRatio(block_layer_dpr_);
+  layer->pixmap.fill(Qt::transparent);
+
+  QPainter p(&layer->pixmap);
+  p.setFont(font());
+  p.translate(-block_layer_left_, -layer->top);
+
+  // Draw in scene coordinates, clamped to the layer's span rather than the visible one
+  draw_left_bound_ = block_layer_left_;
+  draw_right_bound_ = block_layer_right_;
+
+  rational end_time = SceneToTime(draw_right_bound_);
+
+  for (Block *block = track->NearestBlockBeforeOrAt(SceneToTime(draw_left_bound_)); block; block = block->next()) {
+    DrawBlock(&p, kBackgroundPass, block, layer->top, layer->height);
+
+    if (block->out() >= end_time) {
+      break;
+    }
+  }
+}
+
+void TimelineView::InvalidateBlockLayer(Track *track)
+{
+  if (track) {
+    block_layers_.remove(track);
+  } else {
+    block_layers_.clear();
+    pending_thumbnails_.clear();
+  }
+
+  viewport()->update();
+}
+
+void TimelineView::ThumbnailReady(const QString &filename)
+{
+  // Prefetched thumbnails that haven't been drawn yet don't need anything re-rendered
+  auto it = pending_thumbnails_.find(filename);
+  if (it == pending_thumbnails_.end()) {
+    return;
+  }
+
+  // nullptr means it was drawn directly rather than into a layer, so only a repaint is needed
+  for (Track *track : it.value()) {
+    if (track) {
+      block_layers_.remove(track);
+    }
+  }
+
+  pending_thumbnails_.erase(it);
+
+  viewport()->update();
+}
+
+void TimelineView::DrawBlock(QPainter *painter, BlockPass pass, Block *block, qreal block_top, qreal block_height, const rational &in, const rational &out, const rational &media_in)
 {
   if (dynamic_cast<ClipBlock*>(block) || dynamic_cast<TransitionBlock*>(block)) {
 
     qreal block_in = TimeToScene(in);
 
-    qreal block_left = qMax(GetTimelineLeftBound(), block_in);
-    qreal block_right = qMin(GetTimelineRightBound(), TimeToScene(out)) - 1;
+    qreal block_left = qMax(draw_left_bound_, block_in);
+    qreal block_right = qMin(draw_right_bound_, TimeToScene(out)) - 1;
 
     QRectF r(block_left,
              block_top,
@@ -421,7 +544,7 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
     const qreal MINIMUM_DETAIL_WIDTH = 8;
 
     if (r.width() <= MINIMUM_RECT_WIDTH) {
-      if (!foreground) {
+      if (pass == kBackgroundPass) {
         // Just draw a green background
         // Width is likely fractional, so we ceil it and add 1 to ensure the entire width of the
         // rect is painted
@@ -434,7 +557,7 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
       int text_padding = text_height/4; // This ties into the track minimum height being 1.5
       int text_total_height = text_height + text_padding + text_padding;
 
-      if (foreground) {
+      if (pass == kForegroundPass) {
         painter->setBrush(Qt::NoBrush);
 
         if (r.width() > MINIMUM_DETAIL_WIDTH) {
@@ -464,11 +587,17 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
         painter->drawLine(block_left, line_bottom, block_right, line_bottom);
         painter->drawLine(block_right, line_bottom, block_right, block_top);
       } else {
-        painter->setPen(Qt::NoPen);
-        painter->setBrush(block->is_enabled() ? block->brush(block_top, block_top + block_height) : Qt::gray);
-        painter->drawRect(r);
+        if (pass == kBackgroundPass) {
+          painter->setPen(Qt::NoPen);
+          painter->setBrush(block->is_enabled() ? block->brush(block_top, block_top + block_height) : Qt::gray);
+          painter->drawRect(r);
+        }
 
         if (r.width() > MINIMUM_DETAIL_WIDTH) {
+          // Anything drawn over a sticky thumbnail has to be drawn after it, so it moves out of the
+          // cached layer too
+          BlockPass overlay_pass = kBackgroundPass;
+
           if (ClipBlock *clip = dynamic_cast<ClipBlock*>(block)) {
             QRect preview_rect = r.toRect();
 
@@ -479,7 +608,16 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
               preview_rect.adjust(0, text_total_height, 0, 0);
 
               if (preview_rect.height() > r.height()/3) {
-                if (const FrameHashCache *thumbs = clip->thumbnails()) {
+                // A single thumbnail sticks to the visible edge so it can't be cached with the rest
+                bool sticky_thumbnail = (OLIVE_CONFIG("TimelineThumbnailMode") != Timeline::kThumbnailOn);
+                const FrameHashCache *thumbs = clip->thumbnails();
+
+                if (thumbs && sticky_thumbnail) {
+                  overlay_pass = kStickyPass;
+                }
+
+                if (thumbs && sticky_thumbnail == (pass == kStickyPass)) {
+                  Track *layer_track = (pass == kBackgroundPass) ? clip->track() : nullptr;
                   QRect thumb_rect;
                   painter->setRenderHint(QPainter::SmoothPixmapTransform);
                   painter->setClipRect(preview_rect);
@@ -498,16 +636,22 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
                       start = preview_rect.left();
                     }
 
+                    int step = thumb_rect.width()+1;
+
                     for (int i=start; i<preview_rect.right(); i+=thumb_rect.width()+1) {
                       rational time_here = SceneToTime(i - block_in, GetScale(), connected_track_list_->parent()->GetVideoParams().frame_rate_as_time_base()) + media_in;
-                      DrawThumbnail(painter, thumbs, time_here, i, preview_rect, &thumb_rect);
+                      DrawThumbnail(painter, thumbs, time_here, i, preview_rect, &thumb_rect, layer_track);
+                    }
+
+                    if (step > 1) {
+                      PrefetchThumbnails(thumbs, start, step, block_in, TimeToScene(out), preview_rect, media_in);
                     }
 
                   } else {
 
                     rational time = clip->media_range().in();
                     time = Timecode::snap_time_to_timebase(time, thumbs->GetTimebase(), Timecode::kFloor);
-                    DrawThumbnail(painter, thumbs, time, block_left, preview_rect, &thumb_rect);
+                    DrawThumbnail(painter, thumbs, time, block_left, preview_rect, &thumb_rect, layer_track);
 
                   }
 
@@ -517,6 +661,10 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
               }
             }
 
+            if (pass != overlay_pass) {
+              return;
+            }
+
             // Draw waveform
             if (clip->GetTrackType() == Track::kAudio
                 && OLIVE_CONFIG("TimelineWaveformMode").toInt() == Timeline::kWaveformsEnabled) {
@@ -539,7 +687,7 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
                   switch (clip->loop_mode()) {
                   case LoopMode::kLoopModeOff:
                     // Draw stripes for sections of clip < 0
-                    if (zebra_right > GetTimelineLeftBound()) {
+                    if (zebra_right > draw_left_bound_) {
                       DrawZebraStripes(painter, QRectF(block_left, block_top, zebra_right - block_left, block_height));
                     }
                     break;
@@ -559,7 +707,7 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
                   switch (clip->loop_mode()) {
                   case LoopMode::kLoopModeOff:
                     // Draw stripes for sections for clip > clip length
-                    if (zebra_left < GetTimelineRightBound()) {
+                    if (zebra_left < draw_right_bound_) {
                       DrawZebraStripes(painter, QRectF(zebra_left, block_top, block_right - zebra_left, block_height));
                     }
                     break;
@@ -602,6 +750,10 @@ void TimelineView::DrawBlock(QPainter *painter, bool foreground, Block *block, q
             }
           }
 
+          if (pass != overlay_pass) {
+            return;
+          }
+
           // For transitions, show lines representing a transition
           if (TransitionBlock* transition = dynamic_cast<TransitionBlock*>(block)) {
             QVector<QLineF> lines;
@@ -693,16 +845,53 @@ qreal TimelineView::GetTimelineRightBound() const
   return GetTimelineLeftBound() + viewport()->width();
 }
 
-void TimelineView::DrawThumbnail(QPainter *painter, const FrameHashCache *thumbs, const rational &time, int x, const QRect &preview_rect, QRect *thumb_rect) const
+void TimelineView::DrawThumbnail(QPainter *painter, const FrameHashCache *thumbs, const rational &time, int x, const QRect &preview_rect, QRect *thumb_rect, Track *layer_track)
 {
-  QString thumbnail = thumbs->GetValidCacheFilename(time);
+  // The atlas registers disk accesses itself when it actually reads a file
+  QString thumbnail = thumbs->GetValidCacheFilename(time, false);
 
   if (!thumbnail.isEmpty()) {
-    QImage img;
-    if (img.load(thumbnail, "jpg")) {
-      double scale = double(preview_rect.height())/double(img.height());
-      *thumb_rect = QRect(x, preview_rect.top(), img.width() * scale, preview_rect.height());
-      painter->drawImage(*thumb_rect, img);
+    // Only draw thumbnails that have already been decoded, anything else is loaded in the
+    // background and we're repainted once it's ready
+    if (const QImage *img = thumbnail_atlas_->Get(thumbs->GetCacheDirectory(), thumbnail, thumbs->GetGeneration())) {
+      double scale = double(preview_rect.height())/double(img->height());
+      *thumb_rect = QRect(x, preview_rect.top(), img->width() * scale, preview_rect.height());
+      painter->drawImage(*thumb_rect, *img);
+    } else {
+      pending_thumbnails_[thumbnail].insert(layer_track);
+
+      if (thumb_rect->width() > 0) {
+        // Placeholder while the thumbnail loads
+        painter->fillRect(QRect(x, preview_rect.top(), thumb_rect->width(), preview_rect.height()), QColor(0, 0, 0, 64));
+      }
+    }
+  }
+}
+
+void TimelineView::PrefetchThumbnails(const FrameHashCache *thumbs, int start, int step, qreal block_in, qreal block_out, const QRect &preview_rect, const rational &media_in) const
+{
+  // Queue up to one screen's worth of thumbnails past the visible area in the direction we're
+  // scrolling, so they're usually decoded by the time they scroll into view
+  int distance = viewport()->width();
+  rational timebase = connected_track_list_->parent()->GetVideoParams().frame_rate_as_time_base();
+
+  int from, to;
+  if (thumbnail_scroll_direction_ > 0) {
+    from = start + ((preview_rect.right() - start + step - 1) / step) * step;
+    to = qMin(qFloor(block_out), preview_rect.right() + distance);
+  } else {
+    from = start - ((distance / step) * step);
+    while (from < qFloor(block_in)) {
+      from += step;
+    }
+    to = start;
+  }
+
+  for (int i=from; i<to; i+=step) {
+    rational time_here = SceneToTime(i - block_in, GetScale(), timebase) + media_in;
+    QString thumbnail = thumbs->GetValidCacheFilename(time_here, false);
+    if (!thumbnail.isEmpty()) {
+      thumbnail_atlas_->Prefetch(thumbs->GetCacheDirectory(), thumbnail, thumbs->GetGeneration());
     }
   }
 }
@@ -816,7 +1005,7 @@ void TimelineView::SetTransitionOverlay(ClipBlock *out, ClipBlock *in)
       transition_overlay_in_ = nullptr;
     }
 
-    viewport()->update();
+    InvalidateBlockLayer();
   }
 }
 
@@ -856,11 +1045,7 @@ Block *TimelineView::GetItemAtScenePos(const rational &time, int track_index) co
     Track* track = connected_track_list_->GetTrackAt(track_index);
 
     if (track) {
-      foreach (Block* b, track->Blocks()) {
-        if (b->in() <= time && b->out() > time) {
-          return b;
-        }
-      }
+      return track->VisibleBlockAtTime(time);
     }
   }
 
@@ -882,11 +1067,7 @@ QVector<Block *> TimelineView::GetItemsAtSceneRect(const QRectF &rect) const
 
       if (track) {
         if (!(track_bottom < rect.top() || track_top > rect.bottom())) {
-          Block *b = track->NearestBlockBeforeOrAt(start);
-          while (b && b->in() < end) {
-            list.append(b);
-            b = b->next();
-          }
+          list.append(track->BlocksInRange(TimeRange(start, end)));
         }
       }
     }
@@ -898,7 +1079,7 @@ QVector<Block *> TimelineView::GetItemsAtSceneRect(const QRectF &rect) const
 void TimelineView::TrackListChanged()
 {
   UpdateSceneRect();
-  viewport()->update();
+  InvalidateBlockLayer();
 }
 
 }
@@ -26,8 +26,10 @@
 #include <QDragMoveEvent>
 #include <QDragLeaveEvent>
 #include <QDropEvent>
+#include <QPixmap>
 
 #include "node/block/clip/clip.h"
+#include "thumbnailatlas.h"
 #include "timelineviewmouseevent.h"
 #include "timelineviewghostitem.h"
 #include "widget/timebased/timebasedview.h"
@@ -75,6 +77,15 @@ public:
 
   QVector<Block*> GetItemsAtSceneRect(const QRectF &rect) const;
 
+  /**
+   * @brief Mark the cached block rendering of a track as stale
+   *
+   * Block backgrounds (thumbnails, waveforms, markers, cache bars, etc.) are rendered once per
+   * track into an offscreen layer and reused until this is called. Passing nullptr invalidates
+   * every track.
+   */
+  void InvalidateBlockLayer(Track *track = nullptr);
+
 signals:
   void MousePressed(TimelineViewMouseEvent* event);
   void MouseMoved(TimelineViewMouseEvent* event);
@@ -113,13 +124,35 @@ private:
   TimelineViewMouseEvent CreateMouseEvent(QMouseEvent* event);
   TimelineViewMouseEvent CreateMouseEvent(const QPoint &pos, Qt::MouseButton button, Qt::KeyboardModifiers modifiers);
 
-  void DrawBlocks(QPainter* painter, bool foreground);
+  enum BlockPass {
+    /// Everything that doesn't depend on the scroll position, rendered into the cached layer
+    kBackgroundPass,
+
+    /// Background elements that stick to the visible edge of the timeline
+    kStickyPass,
+
+    /// Labels and borders, drawn on top of selections
+    kForegroundPass
+  };
+
+  struct BlockLayer
+  {
+    QPixmap pixmap;
+    qreal top;
+    qreal height;
+  };
+
+  void DrawBlocks(QPainter* painter, BlockPass pass);
+
+  void DrawBlockLayers(QPainter *painter, const QRectF &exposed);
+
+  void RenderBlockLayer(Track *track, BlockLayer *layer);
 
-  void DrawBlock(QPainter *painter, bool foreground, Block *block, qreal top, qreal height, const rational &in, const rational &out, const rational &media_in);
-  void DrawBlock(QPainter *painter, bool foreground, Block *block, qreal top, qreal height)
+  void DrawBlock(QPainter *painter, BlockPass pass, Block *block, qreal top, qreal height, const rational &in, const rational &out, const rational &media_in);
+  void DrawBlock(QPainter *painter, BlockPass pass, Block *block, qreal top, qreal height)
   {
     ClipBlock *cb = dynamic_cast<ClipBlock*>(block);
-    return DrawBlock(painter, foreground, block, top, height, block->in(), block->out(), cb ? cb->media_in() : 0);
+    return DrawBlock(painter, pass, block, top, height, block->in(), block->out(), cb ? cb->media_in() : 0);
   }
 
   void DrawZebraStripes(QPainter *painter, const QRectF &r);
@@ -132,7 +165,15 @@ private:
 
   qreal GetTimelineRightBound() const;
 
-  void DrawThumbnail(QPainter *painter, const FrameHashCache *thumbs, const rational &time, int x, const QRect &preview_rect, QRect *thumb_rect) const;
+  /**
+   * @brief Draw a decoded thumbnail, or a placeholder while it loads
+   *
+   * `layer_track` is the track whose block layer is being rendered, or nullptr if the thumbnail is
+   * drawn directly. Once a missing thumbnail is loaded, only that layer is re-rendered.
+   */
+  void DrawThumbnail(QPainter *painter, const FrameHashCache *thumbs, const rational &time, int x, const QRect &preview_rect, QRect *thumb_rect, Track *layer_track);
+
+  void PrefetchThumbnails(const FrameHashCache *thumbs, int start, int step, qreal block_in, qreal block_out, const QRect &preview_rect, const rational &media_in) const;
 
   QHash<Track::Reference, TimeRangeList>* selections_;
 
@@ -152,9 +193,27 @@ private:
   bool recording_overlay_;
   TimelineCoordinate recording_coord_;
 
+  ThumbnailAtlas *thumbnail_atlas_;
+
+  qreal last_thumbnail_left_bound_;
+  int thumbnail_scroll_direction_;
+
+  QHash<QString, QSet<Track*> > pending_thumbnails_;
+
+  QHash<Track*, BlockLayer> block_layers_;
+  qreal block_layer_left_;
+  qreal block_layer_right_;
+  double block_layer_scale_;
+  qreal block_layer_dpr_;
+
+  qreal draw_left_bound_;
+  qreal draw_right_bound_;
+
 private slots:
   void TrackListChanged();
 
+  void ThumbnailReady(const QString &filename);
+
 };
 
 }
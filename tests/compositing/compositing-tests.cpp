@@ -20,13 +20,132 @@
 
 #include "testutil.h"
 
+#include <QElapsedTimer>
+#include <QGuiApplication>
+
+#include "codec/decoder.h"
 #include "node/distort/crop/cropdistortnode.h"
 #include "node/distort/transform/transformdistortnode.h"
+#include "node/filter/blur/blur.h"
+#include "node/generator/noise/noise.h"
 #include "node/generator/solid/solid.h"
 #include "node/math/merge/merge.h"
 #include "node/project.h"
+#include "render/opengl/openglrenderer.h"
 #include "render/rendermanager.h"
 
 namespace olive {
 
+// Rendering needs an OpenGL context, which needs a GUI application the test runner doesn't create
+#define BENCHMARK_GUI_START \
+  int argc = 1; \
+  char arg0[] = "compositing-tests"; \
+  char *argv[] = {arg0, nullptr}; \
+  QGuiApplication app(argc, argv)
+
+// Not run by default since it needs an OpenGL context and a video file. Set OLIVE_BENCHMARK_VIDEO
+// to a file to measure decoding and uploading it at reduced resolutions (use an MJPEG file to
+// include lowres decoding).
+OLIVE_ADD_DISABLED_TEST(VideoDividerDecodeBenchmark)
+{
+  QString filename = QString::fromLocal8Bit(qgetenv("OLIVE_BENCHMARK_VIDEO"));
+  if (filename.isEmpty()) {
+    std::cout << " - OLIVE_BENCHMARK_VIDEO not set, skipping";
+    OLIVE_TEST_END;
+  }
+
+  BENCHMARK_GUI_START;
+
+  OpenGLRenderer renderer;
+  OLIVE_ASSERT(renderer.Init());
+  renderer.PostInit();
+
+  FootageDescription desc = Decoder::CreateFromID(QStringLiteral("ffmpeg"))->Probe(filename, nullptr);
+  OLIVE_ASSERT(!desc.GetVideoStreams().isEmpty());
+
+  const VideoParams &vp = desc.GetVideoStreams().first();
+  const int frames = 120;
+
+  for (int divider : {1, 2, 4}) {
+    DecoderPtr decoder = Decoder::CreateFromID(QStringLiteral("ffmpeg"));
+    OLIVE_ASSERT(decoder->Open(Decoder::CodecStream(filename, vp.stream_index(), nullptr)));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i=0; i<frames; i++) {
+      Decoder::RetrieveVideoParams p;
+      p.renderer = &renderer;
+      p.time = rational(i) * vp.frame_rate_as_time_base();
+      p.divider = divider;
+      p.maximum_format = PixelFormat::F16;
+
+      OLIVE_ASSERT(decoder->RetrieveVideo(p));
+    }
+
+    renderer.Flush();
+
+    std::cout << std::endl << "  divider " << divider << ": "
+              << frames * 1000.0 / qMax(qint64(1), timer.elapsed()) << " frames per second";
+
+    decoder->Close();
+  }
+
+  renderer.PostDestroy();
+
+  OLIVE_TEST_END;
+}
+
+// Not run by default since it needs an OpenGL context, enable to measure how the cost of a UHD
+// gaussian blur grows with its radius (radii above 16 are blurred on a downscaled copy)
+OLIVE_ADD_DISABLED_TEST(BlurRadiusBenchmark)
+{
+  BENCHMARK_GUI_START;
+
+  ColorManager::SetUpDefaultConfig();
+  RenderManager::CreateInstance();
+
+  {
+    Project project;
+
+    NoiseGeneratorNode *noise = new NoiseGeneratorNode();
+    noise->setParent(&project);
+
+    BlurFilterNode *blur = new BlurFilterNode();
+    blur->setParent(&project);
+    blur->SetStandardValue(BlurFilterNode::kMethodInput, BlurFilterNode::kGaussian);
+
+    Node::ConnectEdge(noise, NodeInput(blur, BlurFilterNode::kTextureInput));
+
+    VideoParams vp(3840, 2160, rational(1, 30), PixelFormat::F16, VideoParams::kRGBAChannelCount);
+    const int iterations = 10;
+
+    for (double radius : {8.0, 16.0, 32.0, 64.0, 128.0, 256.0}) {
+      blur->SetStandardValue(BlurFilterNode::kRadiusInput, radius);
+
+      RenderManager::RenderVideoParams p(blur, vp, AudioParams(), rational(0), project.color_manager(), RenderMode::kOnline);
+
+      // The first render compiles the shaders
+      RenderTicketPtr warmup = RenderManager::instance()->RenderFrame(p);
+      warmup->WaitForFinished();
+      OLIVE_ASSERT(warmup->Get().value<FramePtr>());
+
+      QElapsedTimer timer;
+      timer.start();
+
+      for (int i=0; i<iterations; i++) {
+        RenderTicketPtr ticket = RenderManager::instance()->RenderFrame(p);
+        ticket->WaitForFinished();
+        OLIVE_ASSERT(ticket->Get().value<FramePtr>());
+      }
+
+      std::cout << std::endl << "  radius " << radius << ": " << timer.elapsed() / iterations << " ms per frame";
+    }
+  }
+
+  RenderManager::DestroyInstance();
+
+  OLIVE_TEST_END;
+}
+
 }
@@ -20,7 +20,13 @@
 
 #include "testutil.h"
 
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+#include "audio/audiovisualwaveform.h"
+#include "codec/oiio/oiiodecoder.h"
 #include "common/digit.h"
+#include "node/keyframecurve.h"
 
 namespace olive {
 
@@ -46,4 +52,162 @@ OLIVE_ADD_TEST(DigitTest)
   OLIVE_TEST_END;
 }
 
+OLIVE_ADD_TEST(WaveformReSumTest)
+{
+  // Odd lengths exercise both the vectorized path and the scalar tail
+  for (int channels=1; channels<=3; channels++) {
+    for (size_t frames : {1, 3, 8, 17}) {
+      AudioVisualWaveform::Sample data(frames * channels);
+      for (size_t i=0; i<data.size(); i++) {
+        float v = float(int(i * 37 % 23) - 11) / 11.0f;
+        data[i] = {std::min(v, -v), std::max(v, -v) * 0.5f};
+      }
+
+      AudioVisualWaveform::Sample expected(channels);
+      for (size_t i=0; i<data.size(); i++) {
+        AudioVisualWaveform::SamplePerChannel &e = expected[i % channels];
+        e.min = std::min(e.min, data[i].min);
+        e.max = std::max(e.max, data[i].max);
+      }
+
+      AudioVisualWaveform::Sample summed = AudioVisualWaveform::ReSumSamples(data.data(), data.size(), channels);
+
+      OLIVE_ASSERT(summed.size() == size_t(channels));
+      for (int j=0; j<channels; j++) {
+        OLIVE_ASSERT_EQUAL(summed[j].min, expected[j].min);
+        OLIVE_ASSERT_EQUAL(summed[j].max, expected[j].max);
+      }
+    }
+  }
+
+  OLIVE_TEST_END;
+}
+
+OLIVE_ADD_TEST(KeyframeCurveEvaluate)
+{
+  // Linear -> bezier -> hold -> linear -> linear
+  NodeKeyframe::Type types[] = {NodeKeyframe::kLinear, NodeKeyframe::kBezier, NodeKeyframe::kHold, NodeKeyframe::kLinear, NodeKeyframe::kLinear};
+  double values[] = {0.0, 10.0, -5.0, 3.0, 7.5};
+
+  NodeKeyframeTrack track;
+  for (int i=0; i<5; i++) {
+    NodeKeyframe *key = new NodeKeyframe(rational(i * 2), values[i], types[i], 0, -1, QStringLiteral("value"));
+    key->set_bezier_control_in(QPointF(-0.5, 1.0));
+    key->set_bezier_control_out(QPointF(0.75, -2.0));
+
+    if (!track.isEmpty()) {
+      key->set_previous(track.last());
+      track.last()->set_next(key);
+    }
+
+    track.append(key);
+  }
+
+  NodeKeyframeCurve curve;
+  curve.Rebuild(track, NodeValue::kFloat);
+
+  OLIVE_ASSERT(curve.CanInterpolate());
+  OLIVE_ASSERT(curve.size() == 5);
+
+  // Exact values on keyframes and outside the curve
+  for (int i=0; i<5; i++) {
+    OLIVE_ASSERT_EQUAL(curve.Evaluate(i * 2), values[i]);
+  }
+  OLIVE_ASSERT_EQUAL(curve.Evaluate(-3.0), values[0]);
+  OLIVE_ASSERT_EQUAL(curve.Evaluate(100.0), values[4]);
+
+  // Hold keeps the value until the next keyframe, linear is linear
+  OLIVE_ASSERT_EQUAL(curve.Evaluate(5.9), values[2]);
+  OLIVE_ASSERT_EQUAL(curve.Evaluate(7.0), (values[3] + values[4]) * 0.5);
+
+  // Batched evaluation must match evaluating one by one
+  std::vector<double> times;
+  for (double t=-1.0; t<=9.0; t+=0.125) {
+    times.push_back(t);
+  }
+
+  std::vector<double> batched(times.size());
+  curve.Evaluate(times.data(), batched.data(), int(times.size()));
+
+  for (size_t i=0; i<times.size(); i++) {
+    OLIVE_ASSERT_EQUAL(batched[i], curve.Evaluate(times[i]));
+  }
+
+  qDeleteAll(track);
+
+  OLIVE_TEST_END;
+}
+
+static bool WriteImageBenchmarkFile(const QString &filename, OIIO::TypeDesc format, int channels, int tile_size)
+{
+  OIIO::ImageSpec spec(3840, 2160, channels, format);
+
+  // Offset data window, like the multi-layer EXRs Probe() handles
+  spec.y = 16;
+
+  if (tile_size) {
+    spec.tile_width = tile_size;
+    spec.tile_height = tile_size;
+  }
+
+  auto output = OIIO::ImageOutput::create(filename.toStdString());
+  if (!output || !output->open(filename.toStdString(), spec)) {
+    return false;
+  }
+
+  std::vector<float> pixels(size_t(spec.width) * spec.height * channels);
+  for (size_t i=0; i<pixels.size(); i++) {
+    pixels[i] = float(i % 1021) / 1020.0f;
+  }
+
+  bool ok = output->write_image(OIIO::TypeDesc::FLOAT, pixels.data());
+  output->close();
+
+  return ok;
+}
+
+// Not run by default since it writes and reads several UHD images, enable to measure reduced
+// resolution reads of EXR and DPX files
+OLIVE_ADD_DISABLED_TEST(ImageDividerReadBenchmark)
+{
+  QTemporaryDir dir;
+  OLIVE_ASSERT(dir.isValid());
+
+  struct BenchmarkFile {
+    const char *name;
+    OIIO::TypeDesc format;
+    int channels;
+    int tile_size;
+  };
+
+  const BenchmarkFile files[] = {
+    {"scanline.exr", OIIO::TypeDesc::HALF, 4, 0},
+    {"tiled.exr", OIIO::TypeDesc::HALF, 4, 64},
+    {"image.dpx", OIIO::TypeDesc::UINT16, 3, 0}
+  };
+
+  const int iterations = 5;
+
+  for (const BenchmarkFile &f : files) {
+    QString filename = dir.filePath(QString::fromUtf8(f.name));
+    OLIVE_ASSERT(WriteImageBenchmarkFile(filename, f.format, f.channels, f.tile_size));
+
+    for (int divider : {1, 2, 4, 8}) {
+      QElapsedTimer timer;
+      timer.start();
+
+      for (int i=0; i<iterations; i++) {
+        FramePtr frame = OIIODecoder::ReadSequenceFrame(filename, 0, divider);
+        OLIVE_ASSERT(frame);
+        OLIVE_ASSERT(frame->width() == VideoParams::GetScaledDimension(3840, divider));
+      }
+
+      std::cout << std::endl << "  " << f.name << " at divider " << divider << ": "
+                << timer.elapsed() / iterations << " ms per read";
+    }
+  }
+
+  OLIVE_TEST_END;
+}
+
 }
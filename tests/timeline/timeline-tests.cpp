@@ -18,8 +18,11 @@
 
 ***/
 
+#include <QElapsedTimer>
+
 #include "core.h"
 #include "node/block/clip/clip.h"
+#include "node/block/gap/gap.h"
 #include "node/block/transition/crossdissolve/crossdissolvetransition.h"
 #include "node/math/math/math.h"
 #include "node/math/merge/merge.h"
@@ -601,4 +604,115 @@ OLIVE_ADD_TEST(InsertGaps_SingleTrack)
   OLIVE_TEST_END;
 }
 
+
+static void AppendLookupTestBlocks(Track *track, Project *project, int count)
+{
+  for (int i=0; i<count; i++) {
+    // Mix of clips and gaps with varying lengths
+    Block *b;
+    if (i % 3 == 2) {
+      b = new GapBlock();
+    } else {
+      b = new ClipBlock();
+    }
+    b->set_length_and_media_out(rational(1 + (i % 4), 2));
+    b->setParent(project);
+    track->AppendBlock(b);
+  }
+}
+
+OLIVE_ADD_TEST(TrackBlockLookup)
+{
+  TIMELINE_TEST_START;
+
+  sequence.add_default_nodes();
+
+  Track *track = sequence.track_list(Track::kVideo)->GetTracks().first();
+  AppendLookupTestBlocks(track, &project, 200);
+
+  const QVector<Block*> &blocks = track->Blocks();
+
+  // Compare binary searched lookups against a linear reference, including on block boundaries and
+  // before/after the track
+  for (rational t = -1; t <= track->track_length() + 1; t += rational(1, 4)) {
+    Block *before = nullptr, *before_or_at = nullptr, *after_or_at = nullptr, *after = nullptr, *at = nullptr;
+
+    for (Block *b : blocks) {
+      if (b->out() >= t) {
+        before = (b->in() == t) ? nullptr : b;
+        break;
+      }
+    }
+    for (Block *b : blocks) {
+      if (b->out() > t) {
+        before_or_at = b;
+        break;
+      }
+    }
+    for (Block *b : blocks) {
+      if (b->in() >= t) {
+        after_or_at = b;
+        break;
+      }
+    }
+    for (Block *b : blocks) {
+      if (b->in() > t) {
+        after = b;
+        break;
+      }
+    }
+    for (Block *b : blocks) {
+      if (b->in() <= t && b->out() > t) {
+        at = b;
+        break;
+      }
+    }
+
+    OLIVE_ASSERT(track->NearestBlockBefore(t) == before);
+    OLIVE_ASSERT(track->NearestBlockBeforeOrAt(t) == before_or_at);
+    OLIVE_ASSERT(track->NearestBlockAfterOrAt(t) == after_or_at);
+    OLIVE_ASSERT(track->NearestBlockAfter(t) == after);
+    OLIVE_ASSERT(track->VisibleBlockAtTime(t) == at);
+
+    TimeRange range(t, t + rational(3, 2));
+    QVector<Block*> in_range;
+    for (Block *b : blocks) {
+      if (b->out() > range.in() && b->in() < range.out()) {
+        in_range.append(b);
+      }
+    }
+    OLIVE_ASSERT(track->BlocksInRange(range) == in_range);
+  }
+
+  OLIVE_TEST_END;
+}
+
+// Not run by default since building the track dominates, enable to measure lookups on a very
+// long track
+OLIVE_ADD_DISABLED_TEST(TrackBlockLookupBenchmark)
+{
+  TIMELINE_TEST_START;
+
+  sequence.add_default_nodes();
+
+  Track *track = sequence.track_list(Track::kVideo)->GetTracks().first();
+  AppendLookupTestBlocks(track, &project, 100000);
+
+  const int lookups = 100000;
+  rational length = track->track_length();
+
+  QElapsedTimer timer;
+  timer.start();
+
+  for (int i=0; i<lookups; i++) {
+    rational t = length * rational(i, lookups);
+    OLIVE_ASSERT(track->NearestBlockBeforeOrAt(t));
+    OLIVE_ASSERT(track->VisibleBlockAtTime(t));
+  }
+
+  std::cout << " - " << lookups << " lookups on " << track->Blocks().size() << " blocks took " << timer.elapsed() << " ms";
+
+  OLIVE_TEST_END;
+}
+
 }